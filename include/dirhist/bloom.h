@@ -0,0 +1,129 @@
+/*
+ * @file    include/dirhist/bloom.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <climits>
+#include <optional>
+#include <vector>
+#include "dirhist/serialize.h"
+
+namespace dirhist {
+    constexpr uint64_t BLOOM_MAGIC = 0x4448495354424C40ULL;     // "DIRSTBL"
+    constexpr uint64_t BLOOM_BITS_PER_KEY = 10;     // 每个键占用的位数，误判率约 1%
+    constexpr uint32_t BLOOM_PROBES = 7;            // 每个键设置的位数
+
+    // 过滤器布局：
+    //   <store_dir>/bloom/<根哈希>.bin
+    // 文件内容为 BLOOM_MAGIC + 路径过滤器 + 内容哈希过滤器，
+    // 每个过滤器为 uint64_t 字数 + 位数组。
+    // 键只与目录树根哈希有关，根哈希相同的快照共用同一个过滤器。
+    // 新快照写入时一并生成；旧快照在首次查询时读取快照生成并保存。
+
+    // @brief 布隆过滤器，判断键是否可能存在，不存在时一定返回false
+    class BloomFilter {
+    public:
+        // @brief 按键数量分配位数组
+        // @param keys 预计插入的键数量
+        explicit BloomFilter(uint64_t keys = 0);
+
+        // @brief 插入键
+        // @param key 64位键值（见 path_key、content_key）
+        void add(uint64_t key);
+
+        // @brief 判断键是否可能存在
+        // @param key 64位键值
+        bool may_contain(uint64_t key) const;
+
+        // @brief 写入位数组
+        void write(std::ofstream& ofs) const;
+
+        // @brief 读取位数组
+        // @param ifs 输入文件流
+        // @param limit 允许的最大字数，防止损坏的文件导致过量分配
+        // @return 读取失败返回false
+        bool read(std::ifstream& ifs, uint64_t limit);
+
+    private:
+        std::vector<uint64_t> words_;
+    };
+
+    // @brief 快照的路径与内容哈希过滤器
+    struct SnapFilters {
+        BloomFilter paths;      // 所有节点的相对路径（根节点为 "."）
+        BloomFilter contents;   // 文件与符号链接的内容哈希值（全零的未知哈希除外）
+    };
+
+    // @brief 计算路径的过滤器键
+    // @param path 相对路径，按 path_prefixes 的规则规范化，"" 与 "." 均表示根节点
+    uint64_t path_key(const std::string& path);
+
+    // @brief 计算内容哈希值的过滤器键
+    uint64_t content_key(const std::array<uint8_t, 32>& hash);
+
+    // @brief 为目录树生成过滤器
+    // @param root 目录树根节点
+    SnapFilters build_filters(const Node& root);
+
+    // @brief 获取根哈希对应的过滤器文件路径
+    // @param store_dir 快照目录
+    // @param root_hash 目录树根哈希
+    fs::path filter_path(const fs::path& store_dir, const std::array<uint8_t, 32>& root_hash);
+
+    // @brief 为新写入的快照生成并保存过滤器，已存在时直接返回
+    // @param store_dir 快照目录
+    // @param root 目录树根节点
+    // @note 写入失败不影响快照本身，查询时会重新生成
+    void save_filters(const fs::path& store_dir, const Node& root);
+
+    // @brief 读取根哈希对应的过滤器
+    // @param store_dir 快照目录
+    // @param root_hash 目录树根哈希
+    // @return 文件缺失或损坏时返回空
+    std::optional<SnapFilters> load_filters(const fs::path& store_dir
+                                        , const std::array<uint8_t, 32>& root_hash);
+
+    // @brief 跨快照查询条件，path 与 content 恰好设置一项
+    struct ContainsQuery {
+        std::optional<std::string> path;                    // 相对路径
+        std::optional<std::array<uint8_t, 32>> content;     // 内容哈希值
+    };
+
+    // @brief 包含查询目标的一个快照节点
+    struct ContainsHit {
+        int64_t timestamp = 0;  // 快照时间戳
+        std::string path;       // 节点相对路径
+        bool is_dir = false;    // 是否为目录
+        uint64_t size = 0;      // 大小
+    };
+
+    // @brief 查询过程的统计信息
+    struct ContainsStats {
+        uint64_t snapshots = 0; // 范围内的快照数
+        uint64_t trees = 0;     // 其中根哈希不同的目录树数
+        uint64_t opened = 0;    // 过滤器未能排除、需打开确认的目录树数
+        uint64_t built = 0;     // 缺少过滤器、查询时生成的目录树数
+        uint64_t skipped = 0;   // 版本过旧、无法查询而跳过的目录树数
+    };
+
+    // @brief 查询范围内哪些快照包含指定路径或内容
+    // @param store_dir 快照目录
+    // @param query 查询条件
+    // @param hits 按时间戳升序、快照内按路径顺序输出的命中节点
+    // @param since 起始时间戳（含）
+    // @param until 截止时间戳（含）
+    // @return 返回查询统计，按内容查询时 skipped 为版本过旧、没有内容哈希而跳过的目录树数
+    // @note 快照列表取自快照目录文件，根哈希相同的快照只检查一次；
+    //       只有过滤器判定可能存在的目录树才打开快照文件确认，
+    //       按路径查询时沿路径逐层查找，按内容查询时遍历整棵目录树
+    ContainsStats snapshots_containing(const fs::path& store_dir, const ContainsQuery& query
+                        , std::vector<ContainsHit>& hits
+                        , int64_t since = INT64_MIN, int64_t until = INT64_MAX);
+
+    // @brief 打印命中节点
+    // @param hits 命中节点
+    // @param os 输出流
+    void print_contains(const std::vector<ContainsHit>& hits, std::ostream& os = std::cout);
+}
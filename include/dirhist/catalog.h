@@ -0,0 +1,68 @@
+/*
+ * @file    include/dirhist/catalog.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <vector>
+#include <optional>
+#include <climits>
+#include "dirhist/serialize.h"
+
+namespace dirhist {
+    constexpr uint64_t CATALOG_MAGIC = 0x4448495354434140ULL;   // "DIRSTCA"
+
+    // 快照目录文件 <store_dir>/catalog.bin 布局：
+    //   CATALOG_MAGIC + 按时间戳升序排列的定长 CatalogEntry
+    // 新快照以追加方式写入；删除、乱序插入与重建时写入临时文件后整体替换。
+    // 目录文件缺失、损坏或过期（快照文件被外部删除、移入或未及登记）时会扫描
+    // 快照目录自动重建；查询时快照目录不可写则只在内存中重建。快照目录的 mtime
+    // 早于目录文件时认为快照文件没有变化，不再与条目逐一比对。
+    // 登记与重建期间对 <store_dir>/catalog.lock 持有 flock 排他锁，多个进程同时
+    // 写入快照时"读取-检查-追加/替换"不会交错；锁文件清空快照时也保留。
+
+    // @brief 定义快照目录条目
+    struct CatalogEntry {
+        int64_t timestamp = 0;      // 时间戳
+        uint64_t file_size = 0;     // 快照文件大小
+        std::array<uint8_t, 32> root_hash{0};   // 根节点哈希值
+        TreeStats stats;            // 目录树统计信息
+        uint8_t kind = 0;           // 快照类型
+    };
+
+    // @brief 获取快照目录文件路径
+    // @param store_dir 快照目录
+    fs::path catalog_path(const fs::path& store_dir);
+
+    // @brief 获取目录条目对应的快照文件路径
+    // @param store_dir 快照目录
+    // @param entry 目录条目
+    fs::path snapshot_path(const fs::path& store_dir, const CatalogEntry& entry);
+
+    // @brief 将新写入的快照登记到其所在目录的快照目录中
+    // @param snapshot 快照文件路径
+    // @param hdr 快照文件头，统计信息取自 hdr.stats
+    void catalog_add(const fs::path& snapshot, const Header& hdr);
+
+    // @brief 扫描快照目录中的所有快照文件，重建快照目录
+    // @param store_dir 快照目录
+    // @return 返回按时间戳升序排列的全部条目
+    std::vector<CatalogEntry> catalog_rebuild(const fs::path& store_dir);
+
+    // @brief 按时间范围查询快照，二分查找定位范围，仅读取所需条目
+    // @param store_dir 快照目录
+    // @param n 返回最近的 n 条，-1 时返回范围内全部条目
+    // @param since 起始时间戳（含）
+    // @param until 截止时间戳（含）
+    // @return 返回按时间戳降序排列的条目
+    // @note 仅在快照目录于目录文件写入后被修改过时，比对快照文件名与全部条目
+    std::vector<CatalogEntry> query_catalog(const fs::path& store_dir
+                        , int n = -1, int64_t since = INT64_MIN
+                        , int64_t until = INT64_MAX);
+
+    // @brief 获取最新快照的目录条目
+    // @param store_dir 快照目录
+    // @return 没有快照时返回空
+    std::optional<CatalogEntry> latest_entry(const fs::path& store_dir);
+}
@@ -4,6 +4,7 @@
  * @date    2025-07-28
  */ 
 
+#pragma once
 #include <iostream>
 #include <algorithm>
 #include <optional>
@@ -20,7 +21,25 @@ namespace dirhist{
         std::optional<int> max_depth;
         std::optional<int> num;
         std::optional<bool> all;
+        std::optional<bool> quiet;
+        std::optional<bool> renames;
+        std::optional<bool> cache;
+        std::optional<int> summary;
+        std::optional<std::string> format;
+        std::optional<std::string> path;
+        std::optional<std::string> mode;
+        std::optional<int> max_chain;
+        std::optional<int> top;
+        std::optional<int> depth;
+        std::optional<int64_t> since;
+        std::optional<int64_t> until;
+        std::optional<int64_t> newer;
+        std::optional<uint64_t> larger;
+        std::optional<std::string> name;
+        std::optional<std::array<uint8_t, 32>> hash;
+        std::optional<fs::path> local;
         std::vector<std::string> no_list;
+        std::vector<std::string> paths;
         bool vaild_ins = true;
     };
 
@@ -57,10 +76,61 @@ namespace dirhist{
     // @brief 处理diff命令逻辑
     // @param argc 命令行参数数量
     // @param argv 命令行参数数组指针
+    // @return --quiet 时无变化返回0，有变化返回1；出错返回-1
     int process_diff(int argc, char* argv[]);
 
+    // @brief 处理status命令逻辑，比较快照与当前目录
+    // @param argc 命令行参数数量
+    // @param argv 命令行参数数组指针
+    // @return --quiet 时无变化返回0，有变化返回1；出错返回-1
+    int process_status(int argc, char* argv[]);
+
+    // @brief 处理history命令逻辑，查询路径在各快照间的变化历史
+    // @param argc 命令行参数数量
+    // @param argv 命令行参数数组指针
+    int process_history(int argc, char* argv[]);
+
+    // @brief 处理stat命令逻辑，查询快照中若干路径的节点信息
+    // @param argc 命令行参数数量
+    // @param argv 命令行参数数组指针
+    // @return 全部路径均存在返回0，存在缺失路径返回1，出错返回-1
+    int process_stat(int argc, char* argv[]);
+
+    // @brief 处理find命令逻辑，按修改时间、大小与名称查询快照中的节点
+    // @param argc 命令行参数数量
+    // @param argv 命令行参数数组指针
+    // @return 有匹配节点返回0，没有返回1，出错返回-1
+    int process_find(int argc, char* argv[]);
+
+    // @brief 处理du命令逻辑，查找快照中最大或增长最多的目录与文件
+    // @param argc 命令行参数数量
+    // @param argv 命令行参数数组指针
+    int process_du(int argc, char* argv[]);
+
+    // @brief 处理contains命令逻辑，查询哪些快照包含指定路径或内容
+    // @param argc 命令行参数数量
+    // @param argv 命令行参数数组指针
+    // @return 有快照包含查询目标返回0，没有返回1，出错返回-1
+    int process_contains(int argc, char* argv[]);
+
+    // @brief 处理dupes命令逻辑，按内容哈希查找快照中的重复文件
+    // @param argc 命令行参数数量
+    // @param argv 命令行参数数组指针
+    int process_dupes(int argc, char* argv[]);
+
+    // @brief 处理where命令逻辑，通过内容索引查询哪些快照的哪些路径包含指定内容
+    // @param argc 命令行参数数量
+    // @param argv 命令行参数数组指针
+    // @return 有命中返回0，没有返回1，出错返回-1
+    int process_where(int argc, char* argv[]);
+
     // @brief 处理rm命令逻辑
     // @param argc 命令行参数数量
     // @param argv 命令行参数数组指针
     int process_rm(int argc, char* argv[]);
+
+    // @brief 处理gc命令逻辑
+    // @param argc 命令行参数数量
+    // @param argv 命令行参数数组指针
+    int process_gc(int argc, char* argv[]);
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+/*
+ * @file    include/dirhist/delta.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include "dirhist/serialize.h"
+
+namespace dirhist {
+    // 增量快照中，子节点数量为 INHERIT 的目录节点表示该目录的整棵子树与父快照中
+    // 同路径目录完全相同（哈希值、mtime 及聚合信息均一致），直接从父快照继承，
+    // 不再写入；version 7 之前的增量快照只要求哈希值相同
+    constexpr uint32_t INHERIT = 0xFFFFFFFFU;
+
+    // version 8 起，子节点数量为 INHERIT_RUNS 的目录节点之后依次为表项数量（uint32_t）
+    // 与表项（uint64_t）：最高位为0的表项为子节点记录偏移；最高位为1的表项表示继承
+    // 父快照同路径目录中连续的一段子节点（及其子树），低32位为起始下标，第32至62位
+    // 为数量。只变化了少数子节点的大目录只写入变化的子节点记录，其余子节点按区间继承
+    constexpr uint32_t INHERIT_RUNS = 0xFFFFFFFEU;
+    constexpr uint64_t RUN_FLAG = 1ULL << 63;
+    constexpr uint32_t MAX_RUN_START = 0xFFFFFFFFU;     // 起始下标上限（不含）
+    constexpr uint32_t MAX_RUN_LEN = 0x7FFFFFFFU;       // 单个区间的最大子节点数
+
+    // @brief 构造继承区间表项
+    // @param start 父快照目录中的起始子节点下标
+    // @param len 子节点数量
+    constexpr uint64_t make_run(uint32_t start, uint32_t len) {
+        return RUN_FLAG | (static_cast<uint64_t>(len) << 32) | start;
+    }
+
+    // @brief 继承区间表项的起始下标
+    constexpr uint32_t run_start(uint64_t entry) {
+        return static_cast<uint32_t>(entry);
+    }
+
+    // @brief 继承区间表项的子节点数量
+    constexpr uint32_t run_len(uint64_t entry) {
+        return static_cast<uint32_t>((entry & ~RUN_FLAG) >> 32);
+    }
+
+    // 默认最大增量链长度，超过时写入完整快照作为新的基准
+    constexpr uint32_t DEFAULT_MAX_CHAIN = 16;
+
+    // @brief 判断两节点自身信息（不含子节点与根目录绝对路径）是否完全一致
+    // @param a 节点
+    // @param b 节点
+    bool same_node_info(const Node& a, const Node& b);
+
+    // @brief 判断指定版本的增量快照读取继承子树时是否校验节点信息
+    // @param version 增量快照文件版本号
+    // @note 旧版本写入继承标记时只比较哈希值，节点信息可能与父快照不同
+    bool inherit_checks_info(uint8_t version);
+
+    // @brief dfs 序列化增量节点
+    // @param ofs 输出文件流
+    // @param node 待写入节点
+    // @param base 父快照中同路径的节点，不存在时为 nullptr
+    // @param offset 节点偏移，返回时为已写入数据的末尾
+    void write_delta_node(std::ofstream& ofs, const Node& node
+                                    , const Node* base, uint64_t& offset);
+
+    // @brief dfs 反序列化增量节点，并从父快照目录树中继承未变化的子树
+    // @param ifs 输入文件流
+    // @param offset 节点偏移
+    // @param base_dir 父快照中与当前节点的父目录同路径的目录节点，可为 nullptr
+    // @param version 增量快照文件版本号
+    // @return 返回读取到的节点指针
+    // @note 被继承的子树（含按区间继承的子节点）会从 base_dir 所在目录树中移出
+    std::unique_ptr<Node> read_delta_node(std::ifstream& ifs, uint64_t offset
+                                    , Node* base_dir, uint8_t version = VERSION);
+
+    // @brief 读取增量快照，文件头之后的数据
+    // @param ifs 已读取文件头的输入文件流
+    // @param hdr 增量快照文件头
+    // @param input_dir 快照所在目录，用于查找父快照
+    // @return 返回完整目录树根节点指针
+    std::unique_ptr<Node> read_delta(std::ifstream& ifs, const Header& hdr
+                                                , const fs::path& input_dir);
+
+    // @brief 以目录下最新快照为父快照写入增量快照
+    // @param root 目录树根节点
+    // @param ts 时间戳
+    // @param output_dir 快照目录
+    // @param max_chain 最大增量链长度
+    // @note 没有可用的父快照（不存在、根目录不同或增量链已达上限）时写入完整快照
+    void write_delta_snapshot(const Node& root, int64_t ts
+                                , const fs::path& output_dir = ".dirhist"
+                                , uint32_t max_chain = DEFAULT_MAX_CHAIN);
+}
@@ -4,46 +4,173 @@
  * @date    2025-07-28
  */ 
 
+#pragma once
+#include <iostream>
 #include "dirhist/snapshot.h"
 
 namespace dirhist {
-    // Unchanged 用于占位
-    enum class ChangeType {Added, Deleted, Modified};
+    // Renamed 为同一目录下改名，Moved 为移动到其他目录（可同时改名），仅在开启重命名检测时产生
+    enum class ChangeType {Added, Deleted, Modified, Renamed, Moved};
 
     struct DiffEntry {
         ChangeType type = ChangeType::Added;    // 类型
         std::string path;       // 路径
+        std::string old_path;   // 先前路径（仅 Renamed/Moved）
+        bool is_dir = false;    // 是否为目录（符号链接除外）
         uint64_t old_size = 0;  // 先前文件大小
         uint64_t new_size = 0;  // 当前文件大小
         int64_t old_mtime = 0;  // 先前修改时间
         int64_t new_mtime = 0;  // 当前修改时间
         std::array<uint8_t, 32> old_hash{0};    // 先前的hash值
         std::array<uint8_t, 32> new_hash{0};    // 当前的hash值
+        std::array<uint8_t, 32> content_hash{0};    // 与路径无关的内容哈希值（Modified 为当前值）
     };
 
+    // @brief 差异条目的接收者
+    // @note diff_nodes/mark_subtree 每产生一条差异即调用 on_entry，条目对象会被复用，
+    //       接收者如需保留须自行拷贝；比较结束后由调用方调用 finish
+    class DiffSink {
+    public:
+        virtual ~DiffSink() = default;
+
+        // @brief 接收一条差异
+        virtual void on_entry(const DiffEntry& entry) = 0;
+
+        // @brief 比较结束
+        virtual void finish() {}
+    };
+
+    // @brief 将差异收集到列表中
+    class DiffCollector: public DiffSink {
+    public:
+        explicit DiffCollector(std::vector<DiffEntry>& out): out_(out) {}
+        void on_entry(const DiffEntry& entry) override { out_.push_back(entry); }
+
+    private:
+        std::vector<DiffEntry>& out_;
+    };
+
+    // @brief 按块写入输出流的差异接收者基类
+    // @note 派生类将格式化结果追加到 buf_ 后调用 commit，缓冲区累积到 BUFFER_SIZE 后
+    //       整块写出，finish 或析构时写出剩余内容
+    class BufferedDiffSink: public DiffSink {
+    public:
+        static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+        explicit BufferedDiffSink(std::ostream& os): os_(os) {}
+        ~BufferedDiffSink() override { flush(); }
+
+        void finish() override;
+
+        // @brief 已输出的差异数量
+        uint64_t count() const { return count_; }
+
+    protected:
+        // @brief 完成一条差异的格式化
+        void commit();
+
+        // @brief 写出缓冲区内容
+        void flush();
+
+        std::ostream& os_;
+        std::string buf_;
+        uint64_t count_ = 0;
+    };
+
+    // @brief 将差异格式化为带颜色的对齐文本
+    // @note 首条差异前打印表头，没有差异时打印 "No changes."
+    class DiffPrinter: public BufferedDiffSink {
+    public:
+        explicit DiffPrinter(std::ostream& os = std::cout): BufferedDiffSink(os) {}
+
+        void on_entry(const DiffEntry& entry) override;
+        void finish() override;
+    };
+
+    // @brief 重命名与移动检测
+    // @note 缓存全部差异，finish 时以内容哈希为键索引删除条目，将内容相同的删除与新增
+    //       配对为 Renamed/Moved 后按原顺序交给下游接收者，并调用其 finish。
+    //       先配对目录：整棵子树内容相同的目录移动只输出一条，其子孙条目不再输出；
+    //       再配对其余文件。空文件与空目录（大小为0）及缺少内容哈希的旧快照节点不参与配对
+    class RenameDetector: public DiffSink {
+    public:
+        explicit RenameDetector(DiffSink& next): next_(next) {}
+
+        void on_entry(const DiffEntry& entry) override { entries_.push_back(entry); }
+        void finish() override;
+
+    private:
+        DiffSink& next_;
+        std::vector<DiffEntry> entries_;
+    };
+
+    // @brief 将一条差异按颜色高亮格式追加到缓冲区
+    // @param buf 输出缓冲区
+    // @param entry 待格式化的DiffEntry
+    void format_colored_DiffEntry(std::string& buf, const DiffEntry& entry);
+
     // @brief 颜色高亮打印DiffEntry
     // @param entry 待打印的DiffEntry
     void print_colored_DiffEntry(const DiffEntry& entry);
 
     // @brief 标记整棵子树，针对全删或全增的情况
     // @param node 目录树节点
-    // @param out 输出的目标 DiffEntry 列表
+    // @param type 变化类型（Added 或 Deleted）
+    // @param sink 差异接收者
+    void mark_subtree(const Node& node, ChangeType type, DiffSink& sink);
+
+    // @brief 标记整棵子树，结果追加到列表中
     void mark_subtree(const Node& node, ChangeType type, std::vector<DiffEntry>& out);
 
+    // @brief 比较两棵 merkle树，逐条输出差异（增|删|改）
+    // @param old_node 旧merkle树根节点
+    // @param new_node 新merkle树根节点
+    // @param sink 差异接收者，不会调用其 finish
+    // @note 多个较大的变化子目录会派发到线程池并行比较，各任务将差异写入独占的缓冲区，
+    //       结束后按序交给 sink，输出顺序与串行比较一致；sink 在调用线程中被调用。
+    //       缓冲条目总数超出上限时，超出的子目录改为在调用线程中串行比较
+    void diff_nodes(const Node& old_node, const Node& new_node, DiffSink& sink);
+
     // @brief 比较两棵 merkle树，返回 DiffEntry 列表（增|删|改）
     // @param old_node 旧merkle树根节点
     // @param new_node 新merkle树根节点
-    // @return 返回 DiffEntry 列表
+    // @param out 输出的目标 DiffEntry 列表
     void diff_nodes(const Node& old_node, const Node& new_node
                                                 , std::vector<DiffEntry>& out);
 
+    // @brief 规范化差异范围路径
+    // @param paths 相对路径列表，允许前导 "./" 与末尾 "/"
+    // @return 返回按字典序排列的路径，根目录表示为 "."；重复路径及位于其他路径之下的
+    //         路径被去除，保证各范围互不重叠
+    std::vector<std::string> normalize_scopes(const std::vector<std::string>& paths);
+
+    // @brief 仅比较指定路径下的子树
+    // @param old_root 旧merkle树根节点
+    // @param new_root 新merkle树根节点
+    // @param paths 差异范围路径列表
+    // @param sink 差异接收者，不会调用其 finish
+    // @note 沿路径在有序的 children 中逐层二分查找，不遍历范围之外的兄弟节点；
+    //       路径仅存在于一侧时整棵子树标记为新增或删除，两侧均不存在时无输出
+    void diff_paths(const Node& old_root, const Node& new_root
+                    , const std::vector<std::string>& paths, DiffSink& sink);
+
     // @brief 比较两棵 merkle树，打印目录树变化（增|删|改）信息
     // @param old_root 旧merkle树根节点
     // @param new_root 新merkle树根节点
-    void diff(const Node& old_root, const Node& new_root);
+    // @param renames 是否检测重命名与移动
+    // @note 差异边比较边输出，内存占用与差异数量无关；开启重命名检测时需缓存全部差异
+    void diff(const Node& old_root, const Node& new_root, bool renames = false);
+
+    // @brief 仅通过两个快照的文件头判断目录树是否相同
+    // @param old_snap 旧快照文件路径
+    // @param new_snap 新快照文件路径
+    // @return 根节点哈希值相同返回true，否则false
+    // @note 不读取任何节点记录，快照文件无法打开或格式不合法时抛出异常
+    bool same_snapshot(const fs::path& old_snap, const fs::path& new_snap);
 
     // @brief 获取目标文件夹下的最新快照
     // @param target_dir 目标文件夹
     // @return 返回最新快照的路径（没有快照时返回空路径）
+    // @note 通过快照目录文件 catalog.bin 查找，不再逐个打开快照文件
     fs::path latest_snap(const fs::path& target_dir);
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+/*
+ * @file    include/dirhist/diffcache.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <sstream>
+#include "dirhist/format.h"
+#include "dirhist/serialize.h"
+
+namespace dirhist {
+    // 默认缓存总大小上限
+    constexpr uint64_t DEFAULT_DIFF_CACHE_BYTES = 64ULL * 1024 * 1024;
+
+    // 差异缓存布局：
+    //   <store_dir>/diffcache/<旧根哈希>-<旧时间戳>-<新根哈希>-<新时间戳>.bin
+    // 文件内容为 binary 格式的差异（见 format.h），保存的是未经重命名检测的原始差异，
+    // 读取时可再交给 RenameDetector、SummarySink 或任意输出格式。
+    // 根哈希不覆盖 mtime，仅 touch 过的两个快照根哈希相同而差异中的 mtime 不同，
+    // 因此键同时包含两个快照文件头中的时间戳。
+    // 缓存文件的修改时间即最近使用时间，写入新缓存后总大小超出上限时按最近最少使用淘汰；
+    // 写入中的临时文件同样以 .bin 结尾，残留的临时文件也会被淘汰。
+
+    // @brief 差异缓存键
+    struct DiffCacheKey {
+        std::array<uint8_t, 32> old_hash{0};    // 旧目录树根哈希
+        int64_t old_ts = 0;                     // 旧快照时间戳
+        std::array<uint8_t, 32> new_hash{0};    // 新目录树根哈希
+        int64_t new_ts = 0;                     // 新快照时间戳
+    };
+
+    // @brief 由两个快照的文件头生成缓存键
+    // @param old_hdr 旧快照文件头
+    // @param new_hdr 新快照文件头
+    DiffCacheKey diff_cache_key(const Header& old_hdr, const Header& new_hdr);
+
+    // @brief 获取缓存键对应的缓存文件路径
+    // @param store_dir 快照目录
+    // @param key 缓存键
+    fs::path diff_cache_path(const fs::path& store_dir, const DiffCacheKey& key);
+
+    // @brief 读取缓存的差异，逐条交给 sink
+    // @param store_dir 快照目录
+    // @param key 缓存键
+    // @param sink 差异接收者，不会调用其 finish
+    // @return 命中返回true并刷新其最近使用时间；未命中或缓存损坏返回false，此时不会调用 sink
+    bool load_cached_diff(const fs::path& store_dir, const DiffCacheKey& key
+                                                            , DiffSink& sink);
+
+    // @brief 将差异转交下游接收者，同时记录下来写入缓存
+    // @note 比较结束后调用 commit 写入缓存；记录的数据超过缓存上限时放弃缓存，
+    //       不影响下游输出
+    class DiffCacheWriter: public DiffSink {
+    public:
+        DiffCacheWriter(DiffSink& next, const fs::path& store_dir
+                    , const DiffCacheKey& key
+                    , uint64_t max_bytes = DEFAULT_DIFF_CACHE_BYTES);
+
+        void on_entry(const DiffEntry& entry) override;
+
+        // @brief 写入缓存文件并按上限淘汰旧缓存
+        void commit();
+
+    private:
+        DiffSink& next_;
+        fs::path store_dir_;
+        DiffCacheKey key_;
+        uint64_t max_bytes_;
+        std::ostringstream data_;
+        BinarySink recorder_;
+        bool overflow_ = false;
+    };
+
+    // @brief 按最近最少使用淘汰缓存，直至总大小不超过上限
+    // @param store_dir 快照目录
+    // @param max_bytes 缓存总大小上限
+    // @return 返回淘汰的缓存文件数量
+    // @note 超过一小时未完成的临时文件视为写入进程异常退出的残留，总是删除
+    uint64_t evict_diff_cache(const fs::path& store_dir
+                    , uint64_t max_bytes = DEFAULT_DIFF_CACHE_BYTES);
+}
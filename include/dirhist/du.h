@@ -0,0 +1,55 @@
+/*
+ * @file    include/dirhist/du.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <vector>
+#include <iostream>
+#include "dirhist/reader.h"
+
+namespace dirhist {
+    // @brief 空间占用排名中的一项
+    struct DuEntry {
+        std::string path;           // 相对路径
+        uint64_t size = 0;          // 大小（增长比较时为新快照中的大小）
+        int64_t growth = 0;         // 相对旧快照的增长字节数，仅增长比较时有效
+    };
+
+    // @brief 空间占用报告，目录与文件分别排名
+    struct DuReport {
+        uint64_t total = 0;         // 根目录大小（增长比较时为新快照中的大小）
+        int64_t growth = 0;         // 根目录的增长字节数，仅增长比较时有效
+        std::vector<DuEntry> dirs;  // 按大小（或增长量）降序排列的目录
+        std::vector<DuEntry> files; // 按大小（或增长量）降序排列的文件与符号链接
+    };
+
+    // @brief 查找快照中最大的目录与文件
+    // @param reader 快照访问器
+    // @param top 目录与文件各自保留的条数
+    // @param depth 参与排名的最大层级，根目录的直接子节点为第 1 层，-1 不限
+    // @return 返回空间占用报告，不含根目录自身
+    // @note 直接使用快照中保存的大小（目录大小为其子节点大小之和），不访问原目录。
+    //       目录按大小从大到小展开，目录与文件各用一个大小为 top 的最小堆保存当前排名；
+    //       两个排名均已满且待展开目录不大于两者的最小值时，其余子树不可能进入排名，
+    //       不再读取
+    DuReport largest_entries(const SnapReader& reader, size_t top, int depth = -1);
+
+    // @brief 查找两个快照之间增长最多的目录与文件
+    // @param old_reader 旧快照访问器
+    // @param new_reader 新快照访问器
+    // @param top 目录与文件各自保留的条数
+    // @param depth 参与排名的最大层级，-1 不限
+    // @return 返回空间占用报告，只包含增长量为正的条目
+    // @note 只展开两侧哈希不同的目录；被删除的子树中不可能有正增长，不再读取；
+    //       新增子树中各节点的增长量不超过子树大小，排名已满时可整体跳过
+    DuReport largest_growth(const SnapReader& old_reader, const SnapReader& new_reader
+                            , size_t top, int depth = -1);
+
+    // @brief 打印空间占用报告
+    // @param report 空间占用报告
+    // @param growth 是否为增长比较的报告
+    // @param os 输出流
+    void print_du(const DuReport& report, bool growth, std::ostream& os = std::cout);
+}
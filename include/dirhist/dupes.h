@@ -0,0 +1,47 @@
+/*
+ * @file    include/dirhist/dupes.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <vector>
+#include <iostream>
+#include "dirhist/reader.h"
+
+namespace dirhist {
+    // @brief 一组内容相同的文件
+    struct DupeGroup {
+        uint64_t size = 0;                      // 单个文件大小
+        std::array<uint8_t, 32> content_hash{0};// 内容哈希值
+        std::vector<std::string> paths;         // 按深度优先、路径字典序排列的相对路径
+
+        // @brief 只保留一份时可回收的字节数
+        uint64_t reclaimable() const { return size * (paths.size() - 1); }
+    };
+
+    // @brief 重复文件报告
+    struct DupeReport {
+        uint64_t files = 0;         // 参与比较的文件数
+        uint64_t bytes = 0;         // 参与比较的文件总大小
+        uint64_t duplicates = 0;    // 多余的副本数（每组只计除第一份外的文件）
+        uint64_t reclaimable = 0;   // 可回收的总字节数
+        std::vector<DupeGroup> groups;  // 按可回收字节数降序排列的重复组
+    };
+
+    // @brief 查找快照中内容相同的文件
+    // @param reader 快照访问器
+    // @param min_size 只比较大小超过该字节数的文件，默认跳过空文件
+    // @return 返回重复文件报告
+    // @note 一次遍历快照，以（大小，内容哈希）为键放入哈希表分组，
+    //       直接使用快照中与路径无关的内容哈希，不读取原文件；
+    //       符号链接不参与比较。子树的文件数为 0 或最大文件大小不超过 min_size 时不读取该子树。
+    //       快照版本过旧、没有内容哈希时抛出异常
+    DupeReport find_dupes(const SnapReader& reader, uint64_t min_size = 0);
+
+    // @brief 打印重复文件报告
+    // @param report 重复文件报告
+    // @param top 打印的重复组数量，其余只计入汇总
+    // @param os 输出流
+    void print_dupes(const DupeReport& report, size_t top, std::ostream& os = std::cout);
+}
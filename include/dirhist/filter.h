@@ -0,0 +1,70 @@
+/*
+ * @file    include/dirhist/filter.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <bitset>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+namespace dirhist {
+    // @brief 编译后的通配符
+    // @note '*' 与 '?' 不匹配 '/'，"**" 可匹配 '/'，'[...]' 为字符类（支持范围与 '!' 取反）；
+    //       匹配时同时推进自动机的所有活动状态，耗时与字符串长度和模式长度之积成正比，不回溯
+    class GlobPattern {
+    public:
+        // @brief 编译通配符
+        // @param pattern 通配符字符串
+        explicit GlobPattern(const std::string& pattern);
+
+        // @brief 判断字符串是否匹配
+        bool match(const std::string& str) const;
+
+        // @brief 通配符是否包含 '/'，即应与完整相对路径而非节点名称匹配
+        bool full_path() const { return full_path_; }
+
+        // @brief 判断字符串是否包含通配符
+        static bool is_glob(const std::string& str);
+
+    private:
+        // @brief 通配符自动机中的一个状态转移条件
+        struct Token {
+            enum Kind { Char, Any, Class, Star, DoubleStar } kind = Char;
+            char ch = 0;                // Char 的字符
+            std::bitset<256> set;       // Class 可匹配的字符集合
+        };
+
+        std::vector<Token> tokens_;
+        bool full_path_ = false;
+    };
+
+    // @brief 目录树可视化的路径过滤器，由 --all 与 --no 规则一次性编译得到
+    // @note 构造时将规则规范化为相对于目录树根目录的路径：不含通配符的规则放入哈希集合，
+    //       含 '*'、'?'、'[...]' 的规则编译为通配符自动机；判断时只在内存中进行，
+    //       不访问文件系统，因此同样适用于目录已不存在的快照
+    class PathFilter {
+    public:
+        // @brief 编译过滤规则
+        // @param all 是否显示隐藏文件（夹），为false时任意层级以 '.' 开头的节点均不可见
+        // @param excludes 不显示的文件（夹），相对于目录树根目录，允许前导 "./" 与末尾 "/"；
+        //                 绝对路径按 abs_root 转换为相对路径，不在根目录下时忽略。
+        //                 含 '/' 的通配符匹配完整相对路径，否则匹配节点名称（任意层级），
+        //                 通配符语法见 GlobPattern
+        // @param abs_root 目录树根目录的绝对路径，用于转换绝对路径规则
+        explicit PathFilter(bool all = false, const std::vector<std::string>& excludes = {}
+                            , const std::string& abs_root = "");
+
+        // @brief 判断节点是否可见
+        // @param path 节点相对路径，根节点为 "."
+        // @return 可见返回true；调用方按层遍历时不可见节点的整棵子树均应被剪除
+        bool visible(const std::string& path) const;
+
+    private:
+        bool all_ = false;
+        std::unordered_set<std::string> paths_;     // 规范化后的精确路径
+        std::vector<GlobPattern> globs_;
+    };
+}
@@ -0,0 +1,47 @@
+/*
+ * @file    include/dirhist/find.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <functional>
+#include <optional>
+#include <iostream>
+#include "dirhist/reader.h"
+
+namespace dirhist {
+    // @brief 快照查询条件，未设置的条件不参与过滤，多个条件需同时满足
+    struct FindQuery {
+        std::optional<int64_t> newer;       // 修改时间晚于该毫秒级时间戳
+        std::optional<uint64_t> larger;     // 大小超过该字节数，仅文件与符号链接可匹配
+        std::optional<std::string> name;    // 名称通配符，含 '/' 时匹配完整相对路径
+    };
+
+    // @brief 查询过程的统计信息
+    struct FindStats {
+        uint64_t matched = 0;   // 匹配的节点数
+        uint64_t visited = 0;   // 读取的节点记录数（不含根节点）
+        uint64_t pruned = 0;    // 因聚合信息整体跳过的子树数
+    };
+
+    // @brief 在快照中查找满足条件的节点
+    // @param reader 快照访问器
+    // @param query 查询条件
+    // @param on_match 匹配回调，按深度优先、路径字典序调用，节点不含子节点
+    // @return 返回查询统计
+    // @note 每个目录记录了子树的最大修改时间、最大文件大小与文件数量，
+    //       子树聚合信息表明其中不可能有匹配节点时（如最大修改时间不晚于 newer）
+    //       整棵子树均不读取；旧版本快照中的目录没有聚合信息，不会被跳过
+    FindStats find_nodes(const SnapReader& reader, const FindQuery& query
+                        , const std::function<void(const Node&)>& on_match);
+
+    // @brief 在快照中查找并打印满足条件的节点
+    // @param snapshot 快照文件路径
+    // @param query 查询条件
+    // @param os 输出流
+    // @return 返回查询统计
+    // @note 逐行输出类型、大小、修改时间与路径；快照文件无法打开或格式不合法时抛出异常
+    FindStats print_find(const fs::path& snapshot, const FindQuery& query
+                        , std::ostream& os = std::cout);
+}
@@ -0,0 +1,90 @@
+/*
+ * @file    include/dirhist/flat.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <string_view>
+#include <vector>
+#include "dirhist/diff.h"
+#include "dirhist/find.h"
+
+namespace dirhist {
+    constexpr uint8_t FLAT_DIR = 1;         // 节点为目录
+    constexpr uint8_t FLAT_SYMLINK = 2;     // 节点为符号链接
+
+    // @brief 扁平（列式）目录树
+    // @note 节点按先序排列，各字段分别保存在独立的数组中，扫描单个字段时访问连续内存；
+    //       节点 i 的子树为下标区间 [i, ends[i])，其首个子节点为 i + 1，
+    //       下一个兄弟节点为 ends[i]，跳过整棵子树只需一次下标跳转。
+    //       路径统一保存在 path_data 中，第 i 个路径为 [path_offsets[i], path_offsets[i + 1])
+    struct FlatTree {
+        std::string abs_root;                       // 根目录绝对路径
+        std::vector<uint64_t> sizes;                // 大小
+        std::vector<int64_t> mtimes;                // 修改时间（毫秒级 Unix 时间戳）
+        std::vector<uint8_t> flags;                 // FLAT_DIR | FLAT_SYMLINK
+        std::vector<uint32_t> ends;                 // 子树末尾下标（不含）
+        std::vector<std::array<uint8_t, 32>> hashes;            // 与路径绑定的哈希值
+        std::vector<std::array<uint8_t, 32>> content_hashes;    // 内容哈希值
+        std::string path_data;                      // 所有节点路径依次拼接
+        std::vector<uint64_t> path_offsets;         // 路径起始偏移，共 size() + 1 项
+
+        // @brief 节点数量
+        size_t size() const { return sizes.size(); }
+
+        // @brief 第 i 个节点的相对路径
+        std::string_view path(size_t i) const {
+            return std::string_view(path_data).substr(path_offsets[i]
+                                            , path_offsets[i + 1] - path_offsets[i]);
+        }
+
+        // @brief 第 i 个节点是否为目录（符号链接除外）
+        bool is_real_dir(size_t i) const {
+            return (flags[i] & (FLAT_DIR | FLAT_SYMLINK)) == FLAT_DIR;
+        }
+    };
+
+    // @brief 将目录树转换为扁平目录树
+    // @param root 目录树根节点
+    // @return 返回扁平目录树，根节点下标为 0
+    FlatTree flatten(const Node& root);
+
+    // @brief 将扁平目录树中的子树还原为目录树
+    // @param tree 扁平目录树
+    // @param i 子树根节点下标
+    // @return 返回目录树根节点指针
+    std::unique_ptr<Node> unflatten(const FlatTree& tree, size_t i = 0);
+
+    // @brief 将扁平目录树中的子树整体标记为新增或删除
+    // @param tree 扁平目录树
+    // @param i 子树根节点下标
+    // @param type 变化类型：Added | Deleted
+    // @param sink 差异接收者，不会调用其 finish
+    // @note 子树在数组中连续存放，按下标顺序输出即为先序，与 mark_subtree(const Node&) 一致
+    void mark_subtree(const FlatTree& tree, size_t i, ChangeType type, DiffSink& sink);
+
+    // @brief 比较两棵扁平目录树
+    // @param old_tree 旧扁平目录树
+    // @param new_tree 新扁平目录树
+    // @param sink 差异接收者，不会调用其 finish
+    // @note 输出与对原目录树调用 diff_nodes 相同；哈希值相同的子树直接跳到 ends 处
+    void diff_nodes(const FlatTree& old_tree, const FlatTree& new_tree, DiffSink& sink);
+
+    // @brief 可视化扁平目录树
+    // @param tree 扁平目录树
+    // @param max_depth 打印目录结构的深度，默认为-1时打印所有层级
+    // @param all 是否打印所有文件（夹），为true时忽略隐藏文件（夹）
+    // @param no_list 不打印的文件（夹），规则见 PathFilter
+    // @note 输出与对原目录树调用 display_tree 相同
+    void display_tree(const FlatTree& tree, int max_depth = -1
+        , bool all = false, const std::vector<std::string>& no_list = {});
+
+    // @brief 在扁平目录树中查找满足条件的节点
+    // @param tree 扁平目录树
+    // @param query 查询条件，语义同 find_nodes
+    // @return 返回按先序排列的节点下标，不含根节点
+    // @note 修改时间与大小条件借助 GCC/Clang 向量扩展每次比较4个节点，其他编译器
+    //       退化为逐个节点的无分支比较；名称条件只对通过前两项的节点求值
+    std::vector<uint32_t> select_nodes(const FlatTree& tree, const FindQuery& query);
+}
@@ -0,0 +1,77 @@
+/*
+ * @file    include/dirhist/format.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <memory>
+#include <string>
+#include "dirhist/diff.h"
+
+namespace dirhist {
+    constexpr uint64_t DIFF_MAGIC = 0x4448495354464440ULL;  // "DIRSTFD"
+
+    // 机器可读的差异输出格式，均不使用 iostream 格式化，哈希值以小写十六进制输出：
+    //   ndjson  每行一个 JSON 对象：
+    //           {"type":"modified","path":"a.txt","is_dir":false,"old_size":1,"new_size":2,
+    //            "old_mtime":..,"new_mtime":..,"old_hash":"..","new_hash":"..",
+    //            "content_hash":".."[,"old_path":".."]}
+    //           不存在的一侧哈希值为 null，old_path 仅 renamed/moved 有
+    //   tsv     首行为列名，之后每行一条差异，列依次为
+    //           type path old_path is_dir old_size new_size old_mtime new_mtime
+    //           old_hash new_hash content_hash；
+    //           路径中的 \t \n \r \\ 转义为 \\t \\n \\r \\\\，不存在的哈希值为空
+    //   binary  DIFF_MAGIC 之后为连续的记录，每条记录为
+    //           u32 len（不含自身）+ u8 type + u8 is_dir + u64 old_size + u64 new_size
+    //           + i64 old_mtime + i64 new_mtime + old_hash[32] + new_hash[32]
+    //           + content_hash[32] + u32 path_len + path + u32 old_path_len + old_path，
+    //           整数均为小端序，type 取值同 ChangeType
+
+    // @brief 获取变化类型的名称
+    // @param type 变化类型
+    // @return 返回小写名称，如 "added"
+    const char* change_type_name(ChangeType type);
+
+    // @brief 按 NDJSON 格式输出差异
+    class NdjsonSink: public BufferedDiffSink {
+    public:
+        explicit NdjsonSink(std::ostream& os): BufferedDiffSink(os) {}
+        void on_entry(const DiffEntry& entry) override;
+    };
+
+    // @brief 按 TSV 格式输出差异
+    class TsvSink: public BufferedDiffSink {
+    public:
+        explicit TsvSink(std::ostream& os): BufferedDiffSink(os) {}
+        void on_entry(const DiffEntry& entry) override;
+        void finish() override;
+
+    private:
+        void header();
+    };
+
+    // @brief 按长度前缀的二进制格式输出差异
+    class BinarySink: public BufferedDiffSink {
+    public:
+        explicit BinarySink(std::ostream& os): BufferedDiffSink(os) {}
+        void on_entry(const DiffEntry& entry) override;
+        void finish() override;
+
+    private:
+        void header();
+    };
+
+    // @brief 读取 binary 格式的差异，逐条交给 sink
+    // @param is 输入流，内容为 BinarySink 的完整输出
+    // @param sink 差异接收者，不会调用其 finish
+    // @return 返回读取的差异数量，格式不合法或数据截断时抛出异常
+    uint64_t read_binary_diff(std::istream& is, DiffSink& sink);
+
+    // @brief 按格式名称创建差异接收者
+    // @param format 格式名称：text | ndjson | tsv | binary
+    // @param os 输出流
+    // @return 格式名称不合法时返回 nullptr
+    std::unique_ptr<BufferedDiffSink> make_diff_sink(const std::string& format
+                                                            , std::ostream& os);
+}
@@ -0,0 +1,39 @@
+/*
+ * @file    include/dirhist/history.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <vector>
+#include <climits>
+#include "dirhist/diff.h"
+
+namespace dirhist {
+    // @brief 定义路径历史条目，即路径发生变化的一个快照
+    struct HistoryEntry {
+        int64_t timestamp = 0;      // 快照时间戳
+        ChangeType type = ChangeType::Modified; // 变化类型：Added | Deleted | Modified
+        bool is_dir = false;        // 是否为目录
+        uint64_t size = 0;          // 变化后的大小（Deleted 时为删除前的大小）
+        std::array<uint8_t, 32> hash{0};    // 变化后的哈希值（Deleted 时为删除前的哈希值）
+    };
+
+    // @brief 按时间顺序查询路径在各快照间的变化历史
+    // @param store_dir 快照目录
+    // @param path 相对于快照根目录的路径
+    // @param since 起始时间戳（含）
+    // @param until 截止时间戳（含）
+    // @return 返回按时间戳升序排列、路径发生变化的快照
+    // @note 快照按快照目录中的时间戳顺序遍历，每个快照只沿路径逐层读取节点记录；
+    //       目录文件中的根哈希与上一快照相同时不打开快照文件，
+    //       路径上某层节点的哈希与上一快照同层相同时其下的目标节点必然未变，立即停止下降。
+    //       范围内首个包含该路径的快照记为 Added
+    std::vector<HistoryEntry> path_history(const fs::path& store_dir
+                        , const std::string& path, int64_t since = INT64_MIN
+                        , int64_t until = INT64_MAX);
+
+    // @brief 打印路径变化历史
+    // @param entries 历史条目
+    void print_history(const std::vector<HistoryEntry>& entries);
+}
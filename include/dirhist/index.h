@@ -0,0 +1,97 @@
+/*
+ * @file    include/dirhist/index.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <climits>
+#include <optional>
+#include <vector>
+#include "dirhist/bloom.h"
+
+namespace dirhist {
+    constexpr uint64_t INDEX_MAGIC = 0x44484953544E4941ULL;     // 可引用父段的增量段格式
+    constexpr uint64_t INDEX_MAGIC_V1 = 0x44484953544E4940ULL;  // "DIRSTNI"，旧格式，只有完整段
+    constexpr uint32_t INDEX_MAX_CHAIN = 16;    // 增量段链的最大长度，超过时写入完整段
+
+    // 内容索引布局：
+    //   <store_dir>/index/<根哈希>.idx
+    // 每棵目录树一个索引段，文件内容为：
+    //   IndexHeader + 按（内容哈希，路径）升序排列的定长 IndexRecord
+    //   + 按路径升序排列的定长 IndexMask + 路径数据
+    // 段文件可直接 mmap 后二分查找，查询时不反序列化快照。
+    // 键只与目录树根哈希有关，根哈希相同的快照共用一个索引段；
+    // 新快照写入时追加新段，已有的段不再改写。旧快照在首次查询时读取快照生成。
+    // 与增量快照类似，新段只记录相对父段（最近一棵已索引的目录树）新增或内容
+    // 变化的文件，并以 IndexMask 遮蔽父段中已删除或内容变化的路径；父段链长度
+    // 达到 INDEX_MAX_CHAIN、父段不可用或变化的文件不少于全部文件时写入完整段
+    // （base_hash 全零）。每个段的大小与相对父段的变化量成正比，每 INDEX_MAX_CHAIN
+    // 个段中至少有一个完整段。旧格式段（INDEX_MAGIC_V1）按完整段读取。
+
+    // @brief 索引段文件头
+    // @note 旧格式文件头只有前三个字段
+    struct IndexHeader {
+        uint64_t magic = INDEX_MAGIC;
+        uint64_t count = 0;         // 记录数
+        uint64_t paths_size = 0;    // 路径数据字节数
+        uint64_t mask_count = 0;    // 遮蔽的父段路径数
+        std::array<uint8_t, 32> base_hash{0};   // 父段根哈希，全零为完整段
+        uint32_t chain_len = 0;     // 到完整段的增量段数，完整段为0
+        uint32_t reserved = 0;
+    };
+
+    // @brief 索引记录，每个文件一条
+    struct IndexRecord {
+        std::array<uint8_t, 32> content_hash{0};    // 内容哈希值
+        uint64_t path_offset = 0;   // 路径在路径数据中的偏移
+        uint64_t size = 0;          // 文件大小
+        uint32_t path_len = 0;      // 路径长度
+        uint32_t reserved = 0;
+    };
+
+    // @brief 遮蔽记录，父段链中该路径的记录不再属于本目录树
+    struct IndexMask {
+        uint64_t path_offset = 0;   // 路径在路径数据中的偏移
+        uint32_t path_len = 0;      // 路径长度
+        uint32_t reserved = 0;
+    };
+
+    // @brief 获取根哈希对应的索引段路径
+    // @param store_dir 快照目录
+    // @param root_hash 目录树根哈希
+    fs::path index_path(const fs::path& store_dir, const std::array<uint8_t, 32>& root_hash);
+
+    // @brief 为目录树写入索引段，已存在时直接返回
+    // @param store_dir 快照目录
+    // @param root 目录树根节点
+    // @note 只索引内容哈希已知的普通文件（目录与符号链接除外）；以快照目录中最近一棵
+    //       根哈希不同的目录树为父段写入增量段；写入失败不影响快照本身，查询时会重新生成
+    void save_index(const fs::path& store_dir, const Node& root);
+
+    // @brief 在索引段中查找内容哈希
+    // @param store_dir 快照目录
+    // @param root_hash 目录树根哈希
+    // @param content 内容哈希值
+    // @return 返回按路径升序排列的命中文件（timestamp 为 0）；段文件或其父段缺失、
+    //         损坏时返回空
+    std::optional<std::vector<ContainsHit>> lookup_index(const fs::path& store_dir
+                        , const std::array<uint8_t, 32>& root_hash
+                        , const std::array<uint8_t, 32>& content);
+
+    // @brief 通过内容索引查询范围内哪些快照的哪些路径包含指定内容
+    // @param store_dir 快照目录
+    // @param content 内容哈希值
+    // @param hits 按时间戳升序、快照内按路径升序输出的命中文件
+    // @param since 起始时间戳（含）
+    // @param until 截止时间戳（含）
+    // @return 返回查询统计，opened 为查找的目录树数，skipped 为版本过旧、没有内容哈希
+    //         而跳过的目录树数
+    // @note 快照列表取自快照目录文件，根哈希相同的快照只查找一次，各目录树共用的父段
+    //       在一次查询中只映射、查找一次；缺少索引段的快照读取后以上一棵已索引的目录树
+    //       为父段生成，没有内容哈希的快照不生成索引段
+    ContainsStats where_content(const fs::path& store_dir
+                        , const std::array<uint8_t, 32>& content
+                        , std::vector<ContainsHit>& hits
+                        , int64_t since = INT64_MIN, int64_t until = INT64_MAX);
+}
@@ -4,6 +4,8 @@
  * @date    2025-07-28
  */ 
 
+#pragma once
+#include <climits>
 #include "serialize.h"
 
 namespace dirhist {
@@ -12,10 +14,16 @@ namespace dirhist {
         int64_t timestamp = 0;  // 时间戳
         uint64_t file_size = 0; // 文件大小
         std::string path;       // 路径（相对）
+        TreeStats stats;        // 目录树统计信息
     };
 
     // @brief 读取快照日志
     // @param n 读取日志条目的数量
     // @param target_dir 目标文件夹，默认为 ./.dirhist
-    void list_snapshots(int n = -1, const fs::path& target_dir = ".dirhist");
+    // @param since 起始时间戳（含）
+    // @param until 截止时间戳（含）
+    // @note 日志条目来自快照目录文件 catalog.bin，不再逐个打开快照文件；
+    //       文件数、目录数与总字节数同样取自目录条目，无需读取节点
+    void list_snapshots(int n = -1, const fs::path& target_dir = ".dirhist"
+                    , int64_t since = INT64_MIN, int64_t until = INT64_MAX);
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+/*
+ * @file    include/dirhist/objstore.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <vector>
+#include <memory>
+#include "dirhist/serialize.h"
+
+namespace dirhist {
+    constexpr uint64_t OBJ_MAGIC = 0x4448495354424f43ULL;   // 子目录记录之后附带其对象键
+    constexpr uint64_t OBJ_MAGIC_V3 = 0x4448495354424f42ULL;    // 子节点记录包含子树聚合信息
+    constexpr uint64_t OBJ_MAGIC_V2 = 0x4448495354424f41ULL;    // 子节点记录包含内容哈希
+    constexpr uint64_t OBJ_MAGIC_V1 = 0x4448495354424f40ULL;    // "DIRSTBO"，旧格式
+
+    // 对象库布局：
+    //   <store_dir>/objects/<hex[0:2]>/<hex[2:]>
+    // 每个目录节点对应一个对象，对象内容为该目录所有子节点的节点信息（不含根目录
+    // 绝对路径），子目录记录之后紧跟该子目录的对象键。对象以其内容的 SHA-256
+    // （即对象键）命名，因此对象键覆盖整棵子树的全部节点信息（包括 Merkle 哈希
+    // 不覆盖的 mtime 与子树聚合信息），对象一经写入即可被之后的快照共享，
+    // 仅 touch 过的子树也会写入新对象。
+    // 旧格式对象（OBJ_MAGIC_V1/V2/V3）以目录 Merkle 哈希命名，子目录的对象键即
+    // 其哈希值；V1 的子节点记录不含内容哈希，V2 不含子树聚合信息，读取时仍然兼容。
+
+    // @brief 获取对象文件路径
+    // @param store_dir 快照目录
+    // @param key 对象键
+    // @return 返回对象文件路径
+    fs::path object_path(const fs::path& store_dir
+                                    , const std::array<uint8_t, 32>& key);
+
+    // @brief 计算目录节点的对象键，不写入对象库
+    // @param dir 目录节点
+    // @return 返回对象键，非目录节点返回其哈希值
+    std::array<uint8_t, 32> object_key(const Node& dir);
+
+    // @brief 将目录树写入对象库，已存在的对象会被跳过
+    // @param node 目录树节点
+    // @param store_dir 快照目录
+    // @param key 非空时写入 node 的对象键
+    // @return 返回新写入的对象数量
+    uint64_t write_objects(const Node& node, const fs::path& store_dir
+                                    , std::array<uint8_t, 32>* key = nullptr);
+
+    // @brief 判断指定版本的对象库快照是否在根节点记录之后保存了根目录对象键
+    // @param version 快照文件版本号
+    bool has_object_key(uint8_t version);
+
+    // @brief 读取对象库快照根节点记录之后的根目录对象键
+    // @param ifs 输入文件流，位于根节点记录之后
+    // @param root 已读取的根节点
+    // @param version 快照文件版本号
+    // @return 返回对象键，旧版本快照的对象以哈希值命名，返回 root.hash
+    std::array<uint8_t, 32> read_root_key(std::ifstream& ifs, const Node& root
+                                                            , uint8_t version);
+
+    // @brief 读取单个对象，即目录节点的直接子节点（不含孙节点）
+    // @param store_dir 快照目录
+    // @param key 目录的对象键
+    // @param keys 非空时写入与子节点一一对应的对象键，非目录子节点为其哈希值
+    // @return 返回子节点列表，子节点的 abs_root 为空
+    // @note 对象不存在或格式不合法时抛出异常
+    std::vector<std::unique_ptr<Node>> read_object(const fs::path& store_dir
+                                    , const std::array<uint8_t, 32>& key
+                                    , std::vector<std::array<uint8_t, 32>>* keys = nullptr);
+
+    // @brief 从对象库中递归读取目录节点的整棵子树
+    // @param dir 目录节点，读取到的子节点挂载到 dir.children
+    // @param store_dir 快照目录
+    // @param key 目录的对象键
+    void read_objects(Node& dir, const fs::path& store_dir
+                                    , const std::array<uint8_t, 32>& key);
+
+    // @brief 写入对象库快照，快照文件仅包含文件头和根节点信息
+    // @param root 目录树根节点
+    // @param ts 时间戳
+    // @param output_dir 快照目录
+    void write_object_snapshot(const Node& root, int64_t ts
+                                    , const fs::path& output_dir = ".dirhist");
+
+    // @brief 清理对象库中不被任何快照引用的对象
+    // @param store_dir 快照目录
+    // @return 返回删除的对象数量
+    // @note 不可与 snap 并发执行，否则可能删除正在写入的快照所需的对象；
+    //       仅对象库快照引用对象，完整快照与增量快照被跳过；存在无法读取的快照、
+    //       未知类型的快照或缺失/损坏的对象时放弃清理，返回0
+    uint64_t gc_objects(const fs::path& store_dir = ".dirhist");
+}
@@ -0,0 +1,106 @@
+/*
+ * @file    include/dirhist/reader.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <functional>
+#include <optional>
+#include <vector>
+#include <memory>
+#include "dirhist/serialize.h"
+#include "dirhist/diff.h"
+
+namespace dirhist {
+    class SnapFile;
+    class SnapReader;
+
+    // @brief 快照中的节点引用，记录节点自身信息及其记录位置，用于按需读取子节点
+    struct NodeRef {
+        Node info;                          // 节点自身信息，children 为空
+        const SnapReader* reader = nullptr; // 记录所在快照（增量快照中继承的子树位于父快照）
+        uint64_t offset = 0;                // 记录偏移，对象库快照中不使用
+        std::array<uint8_t, 32> key{0};     // 目录的对象键，仅对象库快照中使用
+    };
+
+    // @brief 按需读取快照的只读访问器
+    // @note 与 read_snapshot 不同，访问器只在被请求时读取单个目录的子节点记录，
+    //       沿路径查找时每层仅需 O(log n) 次 pread（完整/增量快照）或一次对象读取
+    //       （对象库快照）；增量快照中被继承的目录按需打开父快照继续查找
+    class SnapReader {
+    public:
+        // @brief 打开快照文件并读取文件头与根节点
+        // @param snapshot 快照文件路径
+        // @note 文件无法打开或格式不合法时抛出异常
+        explicit SnapReader(const fs::path& snapshot);
+        ~SnapReader();
+
+        SnapReader(const SnapReader&) = delete;
+        SnapReader& operator=(const SnapReader&) = delete;
+
+        // @brief 快照文件头
+        const Header& header() const { return hdr_; }
+
+        // @brief 快照文件路径
+        const fs::path& path() const { return path_; }
+
+        // @brief 根节点引用
+        const NodeRef& root() const { return root_; }
+
+        // @brief 读取目录的直接子节点（不含孙节点）
+        // @param dir 目录节点引用
+        // @return 返回按路径字典序排列的子节点引用，非目录返回空
+        std::vector<NodeRef> children(const NodeRef& dir) const;
+
+        // @brief 在目录的直接子节点中按路径二分查找
+        // @param dir 目录节点引用
+        // @param path 子节点的相对路径
+        // @return 未找到时返回空
+        std::optional<NodeRef> child(const NodeRef& dir, const std::string& path) const;
+
+        // @brief 自根节点沿路径逐层查找节点
+        // @param path 相对路径，"" 或 "." 表示根节点
+        // @return 未找到时返回空
+        std::optional<NodeRef> lookup(const std::string& path) const;
+
+        // @brief 批量按路径查找节点
+        // @param paths 相对路径列表
+        // @return 返回与 paths 一一对应的查找结果
+        // @note 路径排序后依次查找，与上一路径相同的祖先目录直接复用，不再重复查找
+        std::vector<std::optional<NodeRef>> lookup(const std::vector<std::string>& paths) const;
+
+        // @brief 读取以 ref 为根的子树
+        // @param ref 节点引用
+        // @param max_depth 读取的子孙层数，0 仅读取节点自身，-1 不限
+        // @param keep 子节点过滤条件，不满足的子节点及其子树不被读取，为空时读取全部
+        // @return 返回读取到的节点指针
+        // @note 超出深度的目录不再跟随其子节点偏移，读取量只与可见部分的大小有关
+        std::unique_ptr<Node> load(const NodeRef& ref, int max_depth = -1
+                , const std::function<bool(const Node&)>& keep = nullptr) const;
+
+    private:
+        // @brief 辅助函数，获取增量快照中目录在父快照中同路径目录的节点引用
+        NodeRef base_of(const NodeRef& dir) const;
+
+        // @brief 辅助函数，获取增量快照中被继承目录在父快照中的节点引用
+        NodeRef inherited(const NodeRef& dir) const;
+
+        fs::path path_;
+        Header hdr_;
+        NodeRef root_;
+        std::unique_ptr<SnapFile> file_;
+        mutable std::unique_ptr<SnapReader> parent_;    // 按需打开的父快照
+    };
+
+    // @brief 仅比较两个快照中指定路径下的子树，按需从磁盘读取
+    // @param old_reader 旧快照访问器
+    // @param new_reader 新快照访问器
+    // @param paths 差异范围路径列表（见 normalize_scopes）
+    // @param sink 差异接收者，不会调用其 finish
+    // @note 沿路径逐层查找范围根节点，之后只读取两侧哈希不同的目录的子节点，
+    //       仅整棵新增或删除的子树会被完整读取；读取量与路径深度及变化规模相关，
+    //       与快照总节点数无关。输出与读取整棵目录树后调用 diff_paths 相同
+    void diff_paths(const SnapReader& old_reader, const SnapReader& new_reader
+                    , const std::vector<std::string>& paths, DiffSink& sink);
+}
@@ -12,22 +12,65 @@
 
 namespace dirhist {
     constexpr uint64_t MAGIC = 0x4448495354415040ULL;   // "DIRSTAP"
-    constexpr uint8_t VERSION = 1; // 当前版本号
+    constexpr uint8_t VERSION = 8; // 当前版本号
+
+    // @brief 快照类型
+    enum class SnapKind : uint8_t {
+        Full = 0,   // 完整快照，文件内保存整棵目录树
+        Object = 1, // 对象库快照，文件内仅保存根节点，目录内容保存于 objects/
+        Delta = 2,  // 增量快照，仅保存相对父快照发生变化的子树
+    };
 
     // @brief 定义文件头部
+    // @note 新版本字段只能追加在末尾，且每个版本新增的首个字段需按8字节对齐，
+    //       以保证旧版本文件头是新版本文件头的前缀（见 header_size）
     struct Header{
         uint64_t magic = MAGIC;     // 文件头标识
         uint8_t version = VERSION;  // 版本号
         int64_t timestamp = 0;      // 时间戳
         uint64_t root_offset = 0;   // 根节点偏移
         uint64_t data_size = 0;     // 除文件头外的数据大小
+        // version 2
+        uint8_t kind = static_cast<uint8_t>(SnapKind::Full); // 快照类型
+        std::array<uint8_t, 32> root_hash{0};   // 根节点哈希值
+        // version 3
+        int64_t parent_ts = 0;      // 父快照时间戳（仅增量快照有效）
+        uint32_t chain_len = 0;     // 增量链长度，完整快照为0
+        // version 4
+        TreeStats stats;            // 目录树统计信息（文件数、目录数、总字节数）
+        // version 5 文件头无新增字段，节点记录在 hash 之后追加 content_hash
+        // version 6 文件头无新增字段，节点记录在 content_hash 之后追加子树聚合信息，
+        //           mtime 由文件时钟计数改为毫秒级 Unix 时间戳
+        // version 7 文件头无新增字段，对象库快照在根节点记录之后追加根目录的对象键
+        // version 8 文件头无新增字段，增量快照的目录记录可按区间继承未变化的子节点
     };
 
+    // @brief 获取指定版本文件头在磁盘上的大小
+    // @param version 文件头版本号
+    // @return 返回文件头字节数，版本号不合法时返回0
+    size_t header_size(uint8_t version);
+
+    // @brief 读取并校验文件头，兼容旧版本文件头
+    // @param ifs 输入文件流
+    // @param hdr 读取到的文件头，旧版本缺失的字段会被补齐
+    // @return 文件头合法返回true，否则false
+    bool read_header(std::ifstream& ifs, Header& hdr);
+
+    // @brief 判断文件头中是否记录了目录树统计信息
+    // @param hdr 文件头
+    // @return version 4 及以上返回true，旧版本需读取整棵目录树统计
+    bool has_stats(const Header& hdr);
+
+    // @brief 仅读取快照文件头
+    // @param snapshot 快照文件路径
+    // @return 返回文件头，文件无法打开或格式不合法时抛出异常
+    Header read_snapshot_header(const fs::path& snapshot);
+
     // @brief 写POD对象到文件
-    // @param ofs 输出文件流
+    // @param ofs 输出流
     // @param obj 待写入POD对象
     template<typename T>
-    void write(std::ofstream& ofs, const T& obj){
+    void write(std::ostream& ofs, const T& obj){
         try {
             ofs.write(reinterpret_cast<const char*>(&obj), sizeof(obj));
         }
@@ -49,6 +92,34 @@ namespace dirhist {
         }
     }
 
+    // @brief 写入节点自身信息（不含子节点）
+    // @param ofs 输出流
+    // @param node 待写入节点
+    // @param with_abs_root 是否写入根目录绝对路径，为false时写入空字符串
+    void write_node_info(std::ostream& ofs, const Node& node
+                                            , bool with_abs_root = true);
+
+    // @brief 判断指定版本的节点记录是否包含内容哈希
+    // @param version 快照文件版本号
+    bool has_content_hash(uint8_t version);
+
+    // @brief 判断指定版本的节点记录是否包含子树聚合信息
+    // @param version 快照文件版本号
+    bool has_aggregates(uint8_t version);
+
+    // @brief 将旧版本节点记录转换为当前版本的含义
+    // @param node 读取到的节点
+    // @param version 记录所在快照文件的版本号
+    // @note version 6 之前 mtime 为文件时钟计数，转换为毫秒级 Unix 时间戳；
+    //       叶子节点的聚合信息由自身补齐，目录节点取 UNKNOWN_* 保守值
+    void upgrade_node_info(Node& node, uint8_t version);
+
+    // @brief 读取节点自身信息（不含子节点）
+    // @param ifs 输入文件流
+    // @param node 读取到的节点
+    // @param version 记录所在快照文件的版本号
+    void read_node_info(std::ifstream& ifs, Node& node, uint8_t version = VERSION);
+
     // @brief dfs 序列化
     // @param ofs 输出文件流
     // @param node 待写入节点
@@ -58,8 +129,10 @@ namespace dirhist {
     // @brief dfs 反序列化
     // @param ifs 输入文件流
     // @param offset 节点偏移
+    // @param version 快照文件版本号
     // @return 返回读取到的节点指针
-    std::unique_ptr<Node> read_node(std::ifstream& ifs, uint64_t& offset);
+    std::unique_ptr<Node> read_node(std::ifstream& ifs, uint64_t& offset
+                                                , uint8_t version = VERSION);
 
     // @brief 序列化目录树
     // @param root 目录树根节点指针
@@ -78,11 +151,13 @@ namespace dirhist {
     // @brief 反序列化目录树
     // @param snapshot 待读取的快照文件路径
     // @return 返回读取到的目录树根节点指针
-    // @note 该函数读取指定已存在的快照文件，并返回根节点指针
+    // @note 该函数读取指定已存在的快照文件，并返回根节点指针；
+    //       完整快照中数据量较大的子树会通过 pread 派发到线程池并行读取，
+    //       每个任务以 256KB 窗口顺序读取其子树内的记录
     std::unique_ptr<Node> read_snapshot(const fs::path& snapshot);
 
     // @brief 清空快照文件
     // @param target_dir 待清空的快照文件目录
-    // @note 清空指定目录下的所有快照文件，snap-*.bin
+    // @note 清空指定目录下的所有快照文件，snap-*.bin，以及快照目录文件、对象库 objects/ 与差异缓存 diffcache/
     void clean_snapshots(const fs::path& target_dir = ".dirhist");
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <vector>
 #include <memory>
 #include <filesystem>
+#include "dirhist/filter.h"
 
 // 简化命名空间名称书写
 namespace fs = std::filesystem;
@@ -23,39 +24,96 @@ namespace dirhist {
         bool is_dir = false;    // 是否为目录
         bool is_symlink = false; // 是否为符号链接
         uint64_t size = 0;       // 文件或目录大小
-        int64_t mtime = 0;      // 最后修改时间
+        int64_t mtime = 0;      // 最后修改时间（毫秒级 Unix 时间戳）
         std::array<uint8_t, 32> hash{0};    // 文件或目录的SHA256哈希值
+        std::array<uint8_t, 32> content_hash{0};    // 与路径无关的内容哈希值，全零表示未知
+        // 子树聚合信息，用于查询时剪枝；旧版本快照中的目录取 UNKNOWN_* 保守值
+        int64_t max_mtime = 0;      // 子树中（含自身）最大的修改时间
+        uint64_t max_file_size = 0; // 子树中最大的文件大小
+        uint64_t file_cnt = 0;      // 子树中的文件数量（含符号链接）
         std::vector<std::unique_ptr<Node>> children; // 子节点列表
     };
 
+    // 旧版本快照中目录节点的聚合信息未知，取不会被剪枝的保守值
+    constexpr int64_t UNKNOWN_MTIME = INT64_MAX;
+    constexpr uint64_t UNKNOWN_SIZE = UINT64_MAX;
+    constexpr uint64_t UNKNOWN_COUNT = UINT64_MAX;
+
+    // @brief 目录树统计信息
+    struct TreeStats {
+        uint64_t file_cnt = 0;      // 文件数量（含符号链接）
+        uint64_t dir_cnt = 0;       // 目录数量（含根目录）
+        uint64_t total_bytes = 0;   // 文件总大小
+    };
+
+    // @brief 判断节点是否记录了内容哈希值（旧版本快照中的节点没有）
+    // @param node 目录树节点
+    bool has_content_hash(const Node& node);
+
+    // @brief 设置文件或符号链接节点的子树聚合信息，即其自身的修改时间与大小
+    // @param node 叶子节点，需已设置 mtime 与 size
+    void set_leaf_aggregates(Node& node);
+
     // @brief 辅助函数，递归遍历目录
     // @param current_path 当前遍历的路径
     // @param root 根目录路径（绝对路径）
+    // @param prev 先前目录树中与当前路径对应的节点，可为 nullptr
     // @return 返回构建目录树根节点指针
-    std::unique_ptr<Node> walk_dir(const fs::path& current_path, const fs::path& root);
+    // @note 若文件在 prev 中存在且类型、大小与修改时间均未变化，直接沿用其哈希值而不读取内容；
+    //       每个节点同时计算两个哈希值：
+    //       hash 与路径绑定，文件为 SHA256(path+'\0'+raw_bytes)，
+    //            目录为 SHA256(path+'\0'+所有子节点 hash 按路径字典序拼接)；
+    //       content_hash 与路径无关，文件为 SHA256(raw_bytes)，
+    //            符号链接为 SHA256("\0symlink\0"+target)，
+    //            目录为 SHA256(按路径字典序拼接各子节点的 名称+'\0'+类型+content_hash)；
+    //       目录节点同时汇总子树的最大修改时间、最大文件大小与文件数量
+    std::unique_ptr<Node> walk_dir(const fs::path& current_path, const fs::path& root
+                                                    , const Node* prev = nullptr);
 
     // @brief 构建目录树
     // @param root 根目录路径
-    // @return 返回构建的目录树根节点指针
-    std::unique_ptr<Node> build_tree(const fs::path& root);
-
-    // @brief 辅助函数，递归打印目录结构
-    // @param node 目录树节点指针，引用方式不会获取所有权
-    // @param level 当前打印层级，用于控制缩进和控制打印深度
-    // @param is_last 是否为最后一个子节点
-    // @param prefix 当前节点的缩进前缀，默认为空字符串
-    // @param max_depth 最大打印目录结构深度
-    // @param all 是否打印所有文件（夹），为true时忽略隐藏文件（夹）
-    // @param no_list 不打印的文件（夹）
-    void aux_display_tree(const std::unique_ptr<Node>& node, int level = 0
-        , bool is_last = false, std::string prefix = "", int max_depth = -1
-        , bool all = false, const std::vector<std::string>& no_list = {});
+    // @param prev 先前的目录树（如快照中读取的目录树），用于跳过未变化文件的哈希计算
+    // @return 返回构建的目录树根节点指针，根目录不存在时返回 nullptr
+    std::unique_ptr<Node> build_tree(const fs::path& root, const Node* prev = nullptr);
+
+    // @brief 统计目录树中的文件数量、目录数量及文件总大小
+    // @param root 目录树根节点
+    // @return 返回统计信息
+    TreeStats tree_stats(const Node& root);
+
+    // @brief 在目录节点的子节点中按路径二分查找
+    // @param dir 目录节点，其子节点按路径字典序排列
+    // @param path 待查找子节点的相对路径
+    // @return 找到时返回子节点指针，否则返回 nullptr
+    Node* find_child(const Node& dir, const std::string& path);
+
+    // @brief 将路径拆分为逐层的前缀路径
+    // @param path 相对路径，如 "a/b/c"，允许前导 "./" 与末尾 "/"
+    // @return 返回 {"a", "a/b", "a/b/c"}，根路径返回空列表
+    std::vector<std::string> path_prefixes(const std::string& path);
+
+    // @brief 自根节点沿路径逐层二分查找节点
+    // @param root 目录树根节点
+    // @param path 相对路径，"" 或 "." 表示根节点
+    // @return 找到时返回节点指针，否则返回 nullptr
+    const Node* find_path(const Node& root, const std::string& path);
 
     // @brief 可视化目录结构
     // @param root 目录树根节点指针，引用方式不会获取所有权
     // @param max_depth 打印目录结构的深度，默认为-1时打印所有层级
     // @param all 是否打印所有文件（夹），为true时忽略隐藏文件（夹）
-    // @param no_list 不打印的文件（夹）
+    // @param no_list 不打印的文件（夹），规则见 PathFilter
     void display_tree(const std::unique_ptr<Node>& root, int max_depth = -1
         , bool all = false, const std::vector<std::string>& no_list = {});
-}
\ No newline at end of file
+
+    // @brief 边遍历磁盘目录边可视化目录结构
+    // @param root 目标目录
+    // @param max_depth 打印目录结构的深度，默认为-1时打印所有层级
+    // @param all 是否打印所有文件（夹），为true时忽略隐藏文件（夹）
+    // @param no_list 不打印的文件（夹），规则见 PathFilter
+    // @return 根目录不存在时返回false
+    // @note 与 build_tree + display_tree 不同，只读取目录项的元信息而不打开文件内容，
+    //       每读取一个目录即打印其子节点；超出深度的目录与不可见的子树不会被读取
+    bool stream_tree(const fs::path& root, int max_depth = -1
+        , bool all = false, const std::vector<std::string>& no_list = {});
+}
@@ -0,0 +1,20 @@
+/*
+ * @file    include/dirhist/stat.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <vector>
+#include "dirhist/serialize.h"
+
+namespace dirhist {
+    // @brief 查询并打印快照中若干路径的节点信息
+    // @param snapshot 快照文件路径
+    // @param paths 相对路径列表
+    // @return 全部路径均存在返回true，否则false
+    // @note 不读取整棵目录树，每个路径只读取其所在路径上的节点记录，批量查询时共享公共前缀；
+    //       按 paths 的顺序逐行输出路径、类型、大小、修改时间及哈希值，不存在的路径标记为 missing；
+    //       快照文件无法打开或格式不合法时抛出异常
+    bool stat_paths(const fs::path& snapshot, const std::vector<std::string>& paths);
+}
@@ -0,0 +1,50 @@
+/*
+ * @file    include/dirhist/summary.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include "dirhist/diff.h"
+
+namespace dirhist {
+    // @brief 一个目录范围内的差异汇总
+    struct DiffSummary {
+        uint64_t added = 0;         // 新增文件数（含符号链接）
+        uint64_t deleted = 0;       // 删除文件数
+        uint64_t modified = 0;      // 修改文件数
+        uint64_t renamed = 0;       // 重命名与移动数（目录整体移动计为一次）
+        uint64_t bytes_added = 0;   // 新增字节数，修改的文件计入变大的部分
+        uint64_t bytes_removed = 0; // 删除字节数，修改的文件计入变小的部分
+    };
+
+    // @brief 汇总树节点，子节点按名称字典序排列
+    struct SummaryNode {
+        DiffSummary stats;
+        std::map<std::string, std::unique_ptr<SummaryNode>, std::less<>> children;
+    };
+
+    // @brief 按目录汇总差异
+    // @note 每条差异只累加到其所在路径前 depth 层的各级目录及根目录，不保存任何条目，
+    //       内存占用仅与汇总树大小有关；目录自身的增删改条目不计数，其中的文件已逐个计入。
+    //       finish 时将汇总树以树状表格输出
+    class SummarySink: public DiffSink {
+    public:
+        explicit SummarySink(int depth = 1, std::ostream& os = std::cout)
+                                            : depth_(depth), os_(os) {}
+
+        void on_entry(const DiffEntry& entry) override;
+        void finish() override;
+
+        // @brief 汇总树根节点，即整个差异的汇总
+        const SummaryNode& root() const { return root_; }
+
+    private:
+        int depth_;
+        std::ostream& os_;
+        SummaryNode root_;
+    };
+}
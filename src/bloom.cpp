@@ -0,0 +1,253 @@
+/*
+ * @file    src/bloom.cpp
+ * @brief   This source file implements the per-tree bloom filters and the 'contains' query.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include "dirhist/bloom.h"
+#include "dirhist/catalog.h"
+#include "dirhist/reader.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    BloomFilter::BloomFilter(uint64_t keys)
+        : words_(std::max<uint64_t>(1, (keys * BLOOM_BITS_PER_KEY + 63) / 64), 0) {}
+
+    // 双重哈希：第 i 个位置为 key + i * delta，delta 取 key 的循环移位
+    void BloomFilter::add(uint64_t key) {
+        uint64_t bits = words_.size() * 64;
+        uint64_t delta = (key >> 33) | (key << 31);
+        for (uint32_t i = 0; i < BLOOM_PROBES; ++i) {
+            uint64_t pos = key % bits;
+            words_[pos >> 6] |= 1ULL << (pos & 63);
+            key += delta;
+        }
+    }
+
+    bool BloomFilter::may_contain(uint64_t key) const {
+        uint64_t bits = words_.size() * 64;
+        uint64_t delta = (key >> 33) | (key << 31);
+        for (uint32_t i = 0; i < BLOOM_PROBES; ++i) {
+            uint64_t pos = key % bits;
+            if (!(words_[pos >> 6] & (1ULL << (pos & 63)))) return false;
+            key += delta;
+        }
+        return true;
+    }
+
+    void BloomFilter::write(std::ofstream& ofs) const {
+        uint64_t cnt = words_.size();
+        dirhist::write(ofs, cnt);
+        ofs.write(reinterpret_cast<const char*>(words_.data()), cnt * sizeof(uint64_t));
+    }
+
+    bool BloomFilter::read(std::ifstream& ifs, uint64_t limit) {
+        uint64_t cnt = 0;
+        dirhist::read(ifs, cnt);
+        if (!ifs || cnt == 0 || cnt > limit) return false;
+        words_.assign(cnt, 0);
+        ifs.read(reinterpret_cast<char*>(words_.data()), cnt * sizeof(uint64_t));
+        return static_cast<bool>(ifs);
+    }
+
+    uint64_t path_key(const std::string& path) {
+        std::vector<std::string> prefixes = path_prefixes(path);
+        const std::string& norm = prefixes.empty()? std::string("."): prefixes.back();
+        // FNV-1a，再经 splitmix64 的终结步骤打散低位
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c: norm) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+
+    uint64_t content_key(const std::array<uint8_t, 32>& hash) {
+        // SHA-256 的输出本身均匀分布，直接取前 8 字节
+        uint64_t key = 0;
+        std::memcpy(&key, hash.data(), sizeof(key));
+        return key;
+    }
+
+    // @brief 辅助函数，判断节点的内容哈希是否加入内容过滤器
+    // @note 只收录内容哈希已知（非全零）的文件与符号链接；目录的内容哈希随任一后代
+    //       变化，按内容查找的目标是文件，收录目录只会挤占过滤器的位数
+    static bool aux_has_content(const Node& node) {
+        return !(node.is_dir && !node.is_symlink) && has_content_hash(node);
+    }
+
+    // @brief 辅助函数，统计目录树节点数及其中收录内容哈希的节点数
+    static void aux_count(const Node& node, uint64_t& nodes, uint64_t& contents) {
+        ++nodes;
+        if (aux_has_content(node)) ++contents;
+        for (const auto& child: node.children) aux_count(*child, nodes, contents);
+    }
+
+    // @brief 辅助函数，将子树中的节点加入过滤器
+    static void aux_add(const Node& node, SnapFilters& filters) {
+        filters.paths.add(path_key(node.path));
+        if (aux_has_content(node)) filters.contents.add(content_key(node.content_hash));
+        for (const auto& child: node.children) aux_add(*child, filters);
+    }
+
+    SnapFilters build_filters(const Node& root) {
+        uint64_t nodes = 0, contents = 0;
+        aux_count(root, nodes, contents);
+        SnapFilters filters{BloomFilter(nodes), BloomFilter(contents)};
+        aux_add(root, filters);
+        return filters;
+    }
+
+    fs::path filter_path(const fs::path& store_dir, const std::array<uint8_t, 32>& root_hash) {
+        return store_dir / "bloom" / (util::hash_to_hex(root_hash) + ".bin");
+    }
+
+    // @brief 辅助函数，写入临时文件后改名，失败时静默放弃
+    static void write_filters(const fs::path& store_dir, const std::array<uint8_t, 32>& root_hash
+                            , const SnapFilters& filters) {
+        fs::path path = filter_path(store_dir, root_hash);
+        fs::path tmp = path;
+        tmp += util::tmp_suffix();
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        {
+            std::ofstream ofs(tmp, std::ios::binary);
+            if (!ofs) return;
+            write(ofs, BLOOM_MAGIC);
+            filters.paths.write(ofs);
+            filters.contents.write(ofs);
+            if (!ofs) {
+                ofs.close();
+                fs::remove(tmp, ec);
+                return;
+            }
+        }
+        fs::rename(tmp, path, ec);
+        if (ec) fs::remove(tmp, ec);
+    }
+
+    void save_filters(const fs::path& store_dir, const Node& root) {
+        std::error_code ec;
+        if (fs::exists(filter_path(store_dir, root.hash), ec)) return;
+        write_filters(store_dir, root.hash, build_filters(root));
+    }
+
+    std::optional<SnapFilters> load_filters(const fs::path& store_dir
+                                        , const std::array<uint8_t, 32>& root_hash) {
+        fs::path path = filter_path(store_dir, root_hash);
+        std::error_code ec;
+        uint64_t size = fs::file_size(path, ec);
+        if (ec) return std::nullopt;
+        std::ifstream ifs(path, std::ios::binary);
+        uint64_t magic = 0;
+        read(ifs, magic);
+        if (!ifs || magic != BLOOM_MAGIC) return std::nullopt;
+
+        SnapFilters filters;
+        uint64_t limit = size / sizeof(uint64_t);
+        if (!filters.paths.read(ifs, limit) || !filters.contents.read(ifs, limit)) {
+            return std::nullopt;
+        }
+        return filters;
+    }
+
+    // @brief 辅助函数，收集子树中内容哈希相同的节点
+    static void aux_collect(const Node& node, const std::array<uint8_t, 32>& content
+                            , std::vector<ContainsHit>& out) {
+        if (aux_has_content(node) && node.content_hash == content) {
+            out.push_back(ContainsHit{0, node.path, false, node.size});
+        }
+        for (const auto& child: node.children) aux_collect(*child, content, out);
+    }
+
+    ContainsStats snapshots_containing(const fs::path& store_dir, const ContainsQuery& query
+                        , std::vector<ContainsHit>& hits, int64_t since, int64_t until) {
+        if (query.path.has_value() == query.content.has_value()) {
+            throw std::runtime_error("Contains query needs exactly one of path and content");
+        }
+        std::vector<CatalogEntry> snaps = query_catalog(store_dir, -1, since, until);
+        std::reverse(snaps.begin(), snaps.end());
+        uint64_t key = query.path? path_key(*query.path): content_key(*query.content);
+        std::string path;
+        if (query.path) {
+            std::vector<std::string> prefixes = path_prefixes(*query.path);
+            path = prefixes.empty()? ".": prefixes.back();
+        }
+
+        ContainsStats stats;
+        // 根哈希相同的目录树内容相同，确认结果按根哈希复用
+        std::map<std::array<uint8_t, 32>, std::vector<ContainsHit>> found;
+        for (const auto& snap: snaps) {
+            ++stats.snapshots;
+            auto it = found.find(snap.root_hash);
+            if (it == found.end()) {
+                ++stats.trees;
+                std::vector<ContainsHit> res;
+                if (query.content
+                    && !has_content_hash(read_snapshot_header(snapshot_path(store_dir, snap)).version)) {
+                    // 旧版本快照没有内容哈希，其内容过滤器为空，无法按内容查找
+                    ++stats.skipped;
+                    found.emplace(snap.root_hash, std::move(res));
+                    continue;
+                }
+                std::unique_ptr<SnapReader> reader;
+                std::optional<SnapFilters> filters = load_filters(store_dir, snap.root_hash);
+                if (!filters) {
+                    // 旧快照没有过滤器，读取整棵目录树生成并保存，之后的查询不再读取
+                    ++stats.built;
+                    reader = std::make_unique<SnapReader>(snapshot_path(store_dir, snap));
+                    auto root = reader->load(reader->root());
+                    filters = build_filters(*root);
+                    write_filters(store_dir, snap.root_hash, *filters);
+                }
+                const BloomFilter& filter = query.path? filters->paths: filters->contents;
+                if (filter.may_contain(key)) {
+                    ++stats.opened;
+                    if (!reader) {
+                        reader = std::make_unique<SnapReader>(snapshot_path(store_dir, snap));
+                    }
+                    if (query.path) {
+                        auto ref = reader->lookup(path);
+                        if (ref) {
+                            const Node& info = ref->info;
+                            res.push_back(ContainsHit{0, path
+                                        , info.is_dir && !info.is_symlink, info.size});
+                        }
+                    }
+                    else aux_collect(*reader->load(reader->root()), *query.content, res);
+                }
+                it = found.emplace(snap.root_hash, std::move(res)).first;
+            }
+            for (const auto& hit: it->second) {
+                hits.push_back(hit);
+                hits.back().timestamp = snap.timestamp;
+            }
+        }
+        return stats;
+    }
+
+    void print_contains(const std::vector<ContainsHit>& hits, std::ostream& os) {
+        if (hits.empty()) {
+            os << "Not found." << std::endl;
+            return;
+        }
+        os << "Timestamp            Type  Size         Path" << '\n';
+        for (const auto& h: hits) {
+            os << util::ts_str(h.timestamp) << "  "
+               << std::left << std::setw(4) << (h.is_dir? "dir": "file") << "  "
+               << std::left << std::setw(11) << h.size << "  "
+               << h.path << '\n';
+        }
+        os.flush();
+    }
+}
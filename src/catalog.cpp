@@ -0,0 +1,316 @@
+/*
+ * @file    src/catalog.cpp
+ * @brief   This source file implements the snapshot catalog index.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include "dirhist/catalog.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    fs::path catalog_path(const fs::path& store_dir) {
+        return store_dir / "catalog.bin";
+    }
+
+    fs::path snapshot_path(const fs::path& store_dir, const CatalogEntry& entry) {
+        return store_dir / ("snap-" + std::to_string(entry.timestamp) + ".bin");
+    }
+
+    // @brief 打开并校验快照目录文件
+    // @param store_dir 快照目录
+    // @param ifs 输入文件流
+    // @param cnt 条目数量
+    // @return 文件缺失或损坏时返回false
+    static bool open_catalog(const fs::path& store_dir, std::ifstream& ifs
+                                                            , uint64_t& cnt) {
+        std::error_code ec;
+        uint64_t size = fs::file_size(catalog_path(store_dir), ec);
+        if (ec || size < sizeof(uint64_t)
+               || (size - sizeof(uint64_t)) % sizeof(CatalogEntry) != 0) return false;
+
+        ifs.open(catalog_path(store_dir), std::ios::binary);
+        uint64_t magic = 0;
+        read(ifs, magic);
+        if (!ifs || magic != CATALOG_MAGIC) return false;
+
+        cnt = (size - sizeof(uint64_t)) / sizeof(CatalogEntry);
+        return true;
+    }
+
+    // @brief 读取第 i 个条目
+    static CatalogEntry read_entry(std::ifstream& ifs, uint64_t i) {
+        ifs.seekg(sizeof(uint64_t) + i * sizeof(CatalogEntry));
+        CatalogEntry e;
+        read(ifs, e);
+        return e;
+    }
+
+    // @brief 读取 [first, last) 范围内的条目
+    static std::vector<CatalogEntry> read_entries(std::ifstream& ifs
+                                            , uint64_t first, uint64_t last) {
+        std::vector<CatalogEntry> entries(last - first);
+        ifs.seekg(sizeof(uint64_t) + first * sizeof(CatalogEntry));
+        ifs.read(reinterpret_cast<char*>(entries.data())
+                                    , entries.size() * sizeof(CatalogEntry));
+        return entries;
+    }
+
+    // @brief 二分查找首个时间戳大于（upper为true）或不小于 ts 的条目下标
+    static uint64_t search_ts(std::ifstream& ifs, uint64_t cnt
+                                                , int64_t ts, bool upper) {
+        uint64_t lo = 0, hi = cnt;
+        while (lo < hi) {
+            uint64_t mid = lo + (hi - lo) / 2;
+            int64_t cur = read_entry(ifs, mid).timestamp;
+            if (upper? cur <= ts: cur < ts) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // @brief 快照目录文件的写锁，登记与重写期间持有
+    // @note 目录文件以改名方式整体替换，锁加在独立的锁文件上；
+    //       flock 按打开的文件描述加锁，同一进程内的多个线程之间同样互斥
+    class CatalogLock {
+    public:
+        explicit CatalogLock(const fs::path& store_dir) {
+            fs::path path = store_dir / "catalog.lock";
+            fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd_ < 0) {
+                throw std::runtime_error("Error opening catalog lock: " + path.string());
+            }
+            while (::flock(fd_, LOCK_EX) != 0) {
+                if (errno == EINTR) continue;
+                ::close(fd_);
+                throw std::runtime_error("Error locking catalog: " + path.string());
+            }
+        }
+
+        // 关闭文件描述即释放锁
+        ~CatalogLock() { ::close(fd_); }
+
+        CatalogLock(const CatalogLock&) = delete;
+        CatalogLock& operator=(const CatalogLock&) = delete;
+
+    private:
+        int fd_ = -1;
+    };
+
+    // @brief 写入临时文件后整体替换快照目录文件
+    // @note 调用者需持有 CatalogLock；失败时删除临时文件并抛出异常
+    static void write_catalog(const fs::path& store_dir
+                                    , const std::vector<CatalogEntry>& entries) {
+        fs::path target = catalog_path(store_dir);
+        fs::path tmp = target;
+        tmp += util::tmp_suffix();
+        std::error_code ec;
+        {
+            std::ofstream ofs(tmp, std::ios::binary);
+            if (!ofs) {
+                throw std::runtime_error("Error opening catalog file: " + tmp.string());
+            }
+            write(ofs, CATALOG_MAGIC);
+            for (const auto& e: entries) write(ofs, e);
+            if (!ofs) {
+                ofs.close();
+                fs::remove(tmp, ec);
+                throw std::runtime_error("Error writing catalog file: " + tmp.string());
+            }
+        }
+        fs::rename(tmp, target, ec);
+        if (ec) {
+            fs::remove(tmp, ec);
+            throw std::runtime_error("Error replacing catalog file: " + target.string());
+        }
+    }
+
+    // @brief 判断目录文件写入后快照目录中是否没有文件被删除或改名
+    // @param store_dir 快照目录
+    // @return 快照目录的 mtime 早于目录文件时返回true，此时无需逐个检查快照文件
+    // @note 新快照总是先创建快照文件再登记（追加写入），因此目录文件的 mtime 通常
+    //       晚于快照目录；文件系统时间戳精度有限，二者相等时保守地认为已过期
+    static bool catalog_current(const fs::path& store_dir) {
+        std::error_code ec;
+        auto dir_time = fs::last_write_time(store_dir, ec);
+        if (ec) return false;
+        auto catalog_time = fs::last_write_time(catalog_path(store_dir), ec);
+        return !ec && dir_time < catalog_time;
+    }
+
+    // @brief 扫描快照目录中的所有快照文件，在内存中生成条目
+    // @param store_dir 快照目录
+    // @return 返回按时间戳升序排列的全部条目
+    static std::vector<CatalogEntry> scan_snapshots(const fs::path& store_dir) {
+        std::error_code ec;
+        if (!fs::is_directory(store_dir, ec)) return {};
+
+        std::vector<CatalogEntry> entries;
+        for (const auto& e: fs::directory_iterator(store_dir)) {
+            if (!util::is_snap_bin_file(e.path())) continue;
+
+            std::ifstream ifs(e.path(), std::ios::binary);
+            Header hdr;
+            if (!ifs || !read_header(ifs, hdr)) continue;
+
+            CatalogEntry entry;
+            entry.timestamp = hdr.timestamp;
+            entry.file_size = e.file_size();
+            entry.root_hash = hdr.root_hash;
+            entry.kind = hdr.kind;
+            entry.stats = hdr.stats;
+            try {
+                // 旧版本文件头中没有统计信息，需读取整棵目录树
+                if (!has_stats(hdr)) entry.stats = tree_stats(*read_snapshot(e.path()));
+            }
+            catch (const std::exception& ex) {
+                std::cerr << "Skip broken snapshot: " << e.path().string()
+                          << " (" << ex.what() << ")" << std::endl;
+                continue;
+            }
+            entries.push_back(entry);
+        }
+
+        std::sort(entries.begin(), entries.end()
+                    , [](const CatalogEntry& a, const CatalogEntry& b)
+                        {return a.timestamp < b.timestamp;});
+        return entries;
+    }
+
+    void catalog_add(const fs::path& snapshot, const Header& hdr) {
+        CatalogEntry entry;
+        entry.timestamp = hdr.timestamp;
+        entry.file_size = fs::file_size(snapshot);
+        entry.root_hash = hdr.root_hash;
+        entry.stats = hdr.stats;
+        entry.kind = hdr.kind;
+
+        // 读取、比较与写入期间持有写锁，避免并发登记乱序追加，
+        // 或追加到正被整体替换的旧文件上而丢失
+        fs::path store_dir = snapshot.parent_path();
+        CatalogLock lock(store_dir);
+        std::ifstream ifs;
+        uint64_t cnt = 0;
+        if (!open_catalog(store_dir, ifs, cnt)) {
+            // 目录文件缺失或损坏，重建结果中已包含新快照
+            write_catalog(store_dir, scan_snapshots(store_dir));
+            return;
+        }
+
+        // 常见情况：时间戳递增，直接追加
+        if (cnt == 0 || read_entry(ifs, cnt - 1).timestamp < entry.timestamp) {
+            ifs.close();
+            std::ofstream ofs(catalog_path(store_dir), std::ios::binary | std::ios::app);
+            write(ofs, entry);
+            return;
+        }
+
+        // 时间戳乱序或重复（覆盖同名快照）时，保持有序并整体重写
+        std::vector<CatalogEntry> entries = read_entries(ifs, 0, cnt);
+        ifs.close();
+        entries.erase(std::remove_if(entries.begin(), entries.end()
+                        , [&](const CatalogEntry& e){return e.timestamp == entry.timestamp;})
+                        , entries.end());
+        auto pos = std::upper_bound(entries.begin(), entries.end(), entry
+                        , [](const CatalogEntry& a, const CatalogEntry& b)
+                            {return a.timestamp < b.timestamp;});
+        entries.insert(pos, entry);
+        write_catalog(store_dir, entries);
+    }
+
+    std::vector<CatalogEntry> catalog_rebuild(const fs::path& store_dir) {
+        std::error_code ec;
+        if (!fs::is_directory(store_dir, ec)) return {};
+
+        CatalogLock lock(store_dir);
+        std::vector<CatalogEntry> entries = scan_snapshots(store_dir);
+        write_catalog(store_dir, entries);
+        return entries;
+    }
+
+    // @brief 辅助函数，为查询重建快照目录
+    // @note 只读命令也会走到这里：快照目录不可写或写入失败时只在内存中重建，不报错
+    static std::vector<CatalogEntry> rebuild_for_query(const fs::path& store_dir) {
+        if (access(store_dir.c_str(), W_OK) != 0) return scan_snapshots(store_dir);
+        std::unique_ptr<CatalogLock> lock;
+        try {
+            lock = std::make_unique<CatalogLock>(store_dir);
+        }
+        catch (const std::exception&) {
+            return scan_snapshots(store_dir);
+        }
+        // 持锁后扫描，扫描结果包含所有已完成登记的快照
+        std::vector<CatalogEntry> entries = scan_snapshots(store_dir);
+        try {
+            write_catalog(store_dir, entries);
+        }
+        catch (const std::exception&) {}
+        return entries;
+    }
+
+    // @brief 辅助函数，在按时间戳升序排列的条目中筛选时间范围内最近的 n 条
+    // @return 返回按时间戳降序排列的条目
+    static std::vector<CatalogEntry> select_entries(const std::vector<CatalogEntry>& all
+                                        , int n, int64_t since, int64_t until) {
+        auto less_ts = [](const CatalogEntry& e, int64_t ts){return e.timestamp < ts;};
+        auto first = std::lower_bound(all.begin(), all.end(), since, less_ts);
+        auto last = std::upper_bound(all.begin(), all.end(), until
+                        , [](int64_t ts, const CatalogEntry& e){return ts < e.timestamp;});
+        if (n >= 0 && last - first > n) first = last - n;
+        return std::vector<CatalogEntry>(std::make_reverse_iterator(last)
+                                        , std::make_reverse_iterator(first));
+    }
+
+    std::vector<CatalogEntry> query_catalog(const fs::path& store_dir
+                                    , int n, int64_t since, int64_t until) {
+        std::error_code ec;
+        if (!fs::is_directory(store_dir, ec) || since > until) return {};
+
+        std::ifstream ifs;
+        uint64_t cnt = 0;
+        if (!open_catalog(store_dir, ifs, cnt)) {
+            return select_entries(rebuild_for_query(store_dir), n, since, until);
+        }
+
+        // 二分查找时间范围，仅读取需要返回的条目
+        uint64_t first = search_ts(ifs, cnt, since, false);
+        uint64_t last = search_ts(ifs, cnt, until, true);
+        if (n >= 0 && last - first > static_cast<uint64_t>(n)) first = last - n;
+
+        std::vector<CatalogEntry> entries = read_entries(ifs, first, last);
+        std::reverse(entries.begin(), entries.end());
+
+        // 目录文件写入后快照目录未被修改时，无需检查快照文件
+        if (catalog_current(store_dir)) return entries;
+
+        // 否则快照文件可能被外部删除、移入，或在登记前中断；
+        // 快照目录中的快照文件与全部条目一一对应时才沿用目录文件，否则重建后再查询
+        std::vector<std::string> listed;
+        for (const auto& e: fs::directory_iterator(store_dir, ec)) {
+            if (util::is_snap_bin_file(e.path())) listed.push_back(e.path().filename().string());
+        }
+        bool stale = ec || listed.size() != cnt;
+        if (!stale) {
+            std::vector<std::string> known;
+            for (const auto& e: read_entries(ifs, 0, cnt)) {
+                known.push_back(snapshot_path(store_dir, e).filename().string());
+            }
+            std::sort(listed.begin(), listed.end());
+            std::sort(known.begin(), known.end());
+            stale = listed != known;
+        }
+        if (!stale) return entries;
+        return select_entries(rebuild_for_query(store_dir), n, since, until);
+    }
+
+    std::optional<CatalogEntry> latest_entry(const fs::path& store_dir) {
+        std::vector<CatalogEntry> entries = query_catalog(store_dir, 1);
+        if (entries.empty()) return std::nullopt;
+        return entries.front();
+    }
+}
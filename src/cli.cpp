@@ -7,10 +7,26 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cctype>
+#include <functional>
 #include "dirhist/snapshot.h"
 #include "dirhist/serialize.h"
 #include "dirhist/log.h"
 #include "dirhist/diff.h"
+#include "dirhist/objstore.h"
+#include "dirhist/delta.h"
+#include "dirhist/catalog.h"
+#include "dirhist/format.h"
+#include "dirhist/history.h"
+#include "dirhist/diffcache.h"
+#include "dirhist/reader.h"
+#include "dirhist/stat.h"
+#include "dirhist/summary.h"
+#include "dirhist/du.h"
+#include "dirhist/find.h"
+#include "dirhist/bloom.h"
+#include "dirhist/dupes.h"
+#include "dirhist/index.h"
 #include "dirhist/cli.h"
 #include "internal/util.h"
 
@@ -44,7 +60,7 @@ namespace dirhist{
             }
             else if (util::start_with_prefix(arg, "--new_snap=")
                     && check_vaild(vaild_opts, "--new_snap")){
-                opts.old_snap = arg.substr(11);
+                opts.new_snap = arg.substr(11);
             }
             else if (util::start_with_prefix(arg, "--max_depth=")
                     && check_vaild(vaild_opts, "--max_depth")){
@@ -68,6 +84,98 @@ namespace dirhist{
                     opts.vaild_ins = false;
                 }
             }
+            else if (util::start_with_prefix(arg, "--max_chain=")
+                    && check_vaild(vaild_opts, "--max_chain")){
+                std::string val = arg.substr(12);
+                try{
+                    opts.max_chain = std::stoi(val);
+                }
+                catch(...){
+                    std::cerr << "Invaild max_chain: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--top=")
+                    && check_vaild(vaild_opts, "--top")){
+                std::string val = arg.substr(6);
+                try{
+                    opts.top = std::stoi(val);
+                }
+                catch(...){
+                    std::cerr << "Invaild top: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--depth=")
+                    && check_vaild(vaild_opts, "--depth")){
+                std::string val = arg.substr(8);
+                try{
+                    opts.depth = std::stoi(val);
+                }
+                catch(...){
+                    std::cerr << "Invaild depth: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--since=")
+                    && check_vaild(vaild_opts, "--since")){
+                std::string val = arg.substr(8);
+                opts.since = util::parse_ts(val);
+                if (!opts.since.has_value()){
+                    std::cerr << "Invaild since: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--until=")
+                    && check_vaild(vaild_opts, "--until")){
+                std::string val = arg.substr(8);
+                opts.until = util::parse_ts(val);
+                if (!opts.until.has_value()){
+                    std::cerr << "Invaild until: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--newer=")
+                    && check_vaild(vaild_opts, "--newer")){
+                std::string val = arg.substr(8);
+                opts.newer = util::parse_ts(val);
+                if (!opts.newer.has_value()){
+                    std::cerr << "Invaild newer: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--larger=")
+                    && check_vaild(vaild_opts, "--larger")){
+                std::string val = arg.substr(9);
+                try{
+                    if (val.empty() || !std::all_of(val.begin(), val.end()
+                                    , [](unsigned char c){return std::isdigit(c);})) {
+                        throw std::invalid_argument(val);
+                    }
+                    opts.larger = std::stoull(val);
+                }
+                catch(...){
+                    std::cerr << "Invaild larger: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--name=")
+                    && check_vaild(vaild_opts, "--name")){
+                opts.name = arg.substr(7);
+            }
+            else if (util::start_with_prefix(arg, "--hash=")
+                    && check_vaild(vaild_opts, "--hash")){
+                std::string val = arg.substr(7);
+                opts.hash = util::hex_to_hash(val);
+                if (!opts.hash.has_value()){
+                    std::cerr << "Invaild hash: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--local=")
+                    && check_vaild(vaild_opts, "--local")){
+                opts.local = arg.substr(8);
+            }
             else if (util::start_with_prefix(arg, "--all=")
                     && check_vaild(vaild_opts, "--all")){
                 std::string val = arg.substr(6);
@@ -78,6 +186,72 @@ namespace dirhist{
                     opts.vaild_ins = false;
                 }
             }
+            else if ((arg == "--quiet" || util::start_with_prefix(arg, "--quiet="))
+                    && check_vaild(vaild_opts, "--quiet")){
+                std::string val = arg == "--quiet"? "true": arg.substr(8);
+                if (val == "true") opts.quiet = true;
+                else if (val == "false") opts.quiet = false;
+                else {
+                    std::cerr << "Invaild quiet<bool>: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--renames=")
+                    && check_vaild(vaild_opts, "--renames")){
+                std::string val = arg.substr(10);
+                if (val == "true") opts.renames = true;
+                else if (val == "false") opts.renames = false;
+                else {
+                    std::cerr << "Invaild renames<bool>: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if ((arg == "--cache" || util::start_with_prefix(arg, "--cache="))
+                    && check_vaild(vaild_opts, "--cache")){
+                std::string val = arg == "--cache"? "true": arg.substr(8);
+                if (val == "true") opts.cache = true;
+                else if (val == "false") opts.cache = false;
+                else {
+                    std::cerr << "Invaild cache<bool>: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if ((arg == "--summary" || util::start_with_prefix(arg, "--summary="))
+                    && check_vaild(vaild_opts, "--summary")){
+                std::string val = arg == "--summary"? "1": arg.substr(10);
+                try{
+                    opts.summary = std::stoi(val);
+                }
+                catch(...){
+                    std::cerr << "Invaild summary: " << val << std::endl;
+                    opts.vaild_ins = false;
+                }
+            }
+            else if (util::start_with_prefix(arg, "--format=")
+                    && check_vaild(vaild_opts, "--format")){
+                opts.format = arg.substr(9);
+            }
+            else if (util::start_with_prefix(arg, "--paths=")
+                    && check_vaild(vaild_opts, "--paths")){
+                std::string val = arg.substr(8);
+                // "-" 表示从标准输入逐行读取，便于一次查询大量路径
+                if (val == "-") {
+                    std::string line;
+                    while (std::getline(std::cin, line)) {
+                        line = util::trim(line);
+                        if (!line.empty()) opts.paths.push_back(line);
+                    }
+                }
+                else opts.paths = util::split_by_comma(val);
+            }
+            else if (util::start_with_prefix(arg, "--path=")
+                    && check_vaild(vaild_opts, "--path")){
+                opts.path = arg.substr(7);
+            }
+            else if (util::start_with_prefix(arg, "--mode=")
+                    && check_vaild(vaild_opts, "--mode")){
+                opts.mode = arg.substr(7);
+            }
             else if (util::start_with_prefix(arg, "--no=")
                     && check_vaild(vaild_opts, "--no")){
                 std::string val = arg.substr(5);
@@ -92,28 +266,101 @@ namespace dirhist{
         return opts;
     }
 
+    // @brief 辅助函数，按 --format、--summary 与 --renames 选项输出差异
+    // @param opts 命令行选项
+    // @param run 产生差异的比较过程，将差异逐条交给传入的接收者
+    // @return 格式名称或汇总深度不合法时返回-1，否则返回0
+    static int emit_diff(const Options& opts, const std::function<void(DiffSink&)>& run){
+        std::unique_ptr<DiffSink> sink;
+        // 按目录汇总时不输出单条差异，--format 不再生效
+        if (opts.summary.has_value()) {
+            if (opts.summary.value() < -1) {
+                std::cerr << "Invaild summary: " << opts.summary.value()
+                          << " [depth >= -1]" << std::endl;
+                return -1;
+            }
+            sink = std::make_unique<SummarySink>(opts.summary.value());
+        }
+        else {
+            std::string format = opts.format.has_value()? opts.format.value(): "text";
+            sink = make_diff_sink(format, std::cout);
+            if (!sink) {
+                std::cerr << "Invaild format: " << format
+                          << " [text|ndjson|tsv|binary]" << std::endl;
+                return -1;
+            }
+        }
+
+        bool renames = opts.renames.has_value()? opts.renames.value(): false;
+        if (renames) {
+            RenameDetector detector(*sink);
+            run(detector);
+            detector.finish();
+        }
+        else {
+            run(*sink);
+            sink->finish();
+        }
+        return 0;
+    }
+
+    // @brief 辅助函数，读取最新快照的目录树，作为构建目录树时的参照
+    // @param store_dir 快照目录
+    // @param dir 待创建快照的根目录
+    // @return 没有快照、快照无法读取或最新快照的根目录不是 dir 时返回 nullptr
+    static std::unique_ptr<Node> prev_tree(const fs::path& store_dir, const fs::path& dir){
+        std::error_code ec;
+        if (!fs::exists(store_dir, ec) || !fs::exists(dir, ec)) return nullptr;
+        try {
+            std::optional<CatalogEntry> entry = latest_entry(store_dir);
+            if (!entry.has_value()) return nullptr;
+            std::unique_ptr<Node> prev = read_snapshot(snapshot_path(store_dir, entry.value()));
+            if (!prev || fs::path(prev->abs_root) != fs::canonical(fs::absolute(dir))) return nullptr;
+            return prev;
+        }
+        catch (const std::exception&) {
+            return nullptr;
+        }
+    }
+
     int process_snap(int argc, char* argv[]){
-        // dirhist snap --dir=<target_directory_path>
+        // dirhist snap --dir=<target_directory_path> [--mode=full|object|delta] [--max_chain=<n>]
+        const char* usage = "Usage: dirhist snap --dir=<target_directory_path> [--options]\n"
+                            "Options: [--mode=full|object|delta] [--max_chain=<n>]";
         if (argc < 3){
             std::cerr << "Invaild instruction" << std::endl;
-            std::cerr << "Usage: dirhist snap --dir=<target_directory_path>"
-            << std::endl;
+            std::cerr << usage << std::endl;
             return -1;
         }
-        std::vector<std::string> vaild_opts = {"--dir"};
+        std::vector<std::string> vaild_opts = {"--dir", "--mode", "--max_chain"};
         Options opts = parse_options(argc, argv, vaild_opts);
 
-        if (!opts.vaild_ins) {
+        std::string mode = opts.mode.has_value()? opts.mode.value(): "full";
+        if (!opts.vaild_ins || !opts.dir.has_value()
+                || (mode != "full" && mode != "object" && mode != "delta")
+                || (opts.max_chain.has_value() && opts.max_chain.value() < 0)) {
             std::cerr << "Invaild instruction" << std::endl;
-            std::cerr << "Usage: dirhist snap --dir=<target_directory_path>"
-            << std::endl;
+            std::cerr << usage << std::endl;
             return -1;
         }
 
-        std::unique_ptr<dirhist::Node> root = dirhist::build_tree(opts.dir.value());
+        // 对象库与增量模式以最新快照为参照，大小与修改时间未变的文件沿用其哈希值，
+        // 只读取变化文件的内容，写入快照的耗时随变化量而非目录规模增长
+        std::unique_ptr<dirhist::Node> prev;
+        if (mode != "full") prev = prev_tree(".dirhist", opts.dir.value());
+        std::unique_ptr<dirhist::Node> root = dirhist::build_tree(opts.dir.value(), prev.get());
         if(!root) return -1;
+        prev.reset();
 
-        dirhist::write_snapshot(*root, util::now_ms());
+        if (mode == "object") {
+            dirhist::write_object_snapshot(*root, util::now_ms());
+        }
+        else if (mode == "delta") {
+            uint32_t max_chain = opts.max_chain.has_value()? 
+                        opts.max_chain.value(): dirhist::DEFAULT_MAX_CHAIN;
+            dirhist::write_delta_snapshot(*root, util::now_ms(), ".dirhist", max_chain);
+        }
+        else dirhist::write_snapshot(*root, util::now_ms());
         return 0;
     }
 
@@ -148,9 +395,26 @@ namespace dirhist{
         // 确定目标
         std::unique_ptr<dirhist::Node> root;
 
+        int m_depth = opts.max_depth.has_value()? opts.max_depth.value(): -1;
+        bool is_all = opts.all.has_value()? opts.all.value(): false;
         if (opts.file.has_value()){
             if (util::is_snap_bin_file(opts.file.value())){
-                root = read_snapshot(opts.file.value());
+                // 有深度限制或排除列表时按需读取，超出深度与不可见的子树不读取；
+                // 否则并行读取整棵目录树
+                if (m_depth >= 0 || !opts.no_list.empty()) {
+                    try {
+                        SnapReader reader(opts.file.value());
+                        PathFilter filter(is_all, opts.no_list, reader.root().info.abs_root);
+                        root = reader.load(reader.root(), m_depth, [&](const Node& node){
+                            return filter.visible(node.path);
+                        });
+                    }
+                    catch (const std::exception& e) {
+                        std::cerr << e.what() << std::endl;
+                        return -1;
+                    }
+                }
+                else root = read_snapshot(opts.file.value());
             }
             else {
                 std::cerr << "Not a snapshot file: " 
@@ -159,81 +423,447 @@ namespace dirhist{
             }
         }
         else {
-            root = build_tree(opts.dir.value());
+            // 目录结构只需元信息，边遍历边打印，不计算文件哈希
+            return stream_tree(opts.dir.value(), m_depth, is_all, opts.no_list)? 0: -1;
         }
 
         // 基于选项调用
-        int m_depth = opts.max_depth.has_value()? opts.max_depth.value(): -1;
-        bool is_all = opts.all.has_value()? opts.all.value(): false;
         display_tree(root, m_depth, is_all, opts.no_list);
         return 0;
     }
 
     int process_log(int argc, char* argv[]){
-        // dirhist log [--dir=<target_directory_path>] [--num=<n>]
+        // dirhist log [--dir=<target_directory_path>] [--num=<n>] [--since=<time>] [--until=<time>]
+        const char* usage = "Usage: dirhist log [--options]\n"
+                            "Options: [--dir=<target_directory_path>] [--num=<n>]"
+                            " [--since=<time>] [--until=<time>]";
         if (argc < 2){
             std::cerr << "Invaild instruction" << std::endl;
-            std::cerr << "Usage: dirhist log [--options]"
-                      << std::endl;
-            std::cerr << "Options: [--dir=<target_directory_path>] [--num=<n>]" 
-                      << std::endl;
+            std::cerr << usage << std::endl;
             return -1;
         }
 
-        std::vector<std::string> vaild_opts = {"--dir", "--num"};
+        std::vector<std::string> vaild_opts = {"--dir", "--num", "--since", "--until"};
         Options opts = parse_options(argc, argv, vaild_opts);
 
         if (!opts.vaild_ins){
             std::cerr << "Invaild instruction" << std::endl;
-            std::cerr << "Usage: dirhist log [--options]"
-                      << std::endl;
-            std::cerr << "Options: [--dir=<target_directory_path>] [--num=<n>]" 
-                      << std::endl;
+            std::cerr << usage << std::endl;
             return -1;
         }
 
         fs::path target = opts.dir.has_value()? opts.dir.value(): ".dirhist";
         int n = opts.num.has_value()? opts.num.value(): -1;
+        int64_t since = opts.since.has_value()? opts.since.value(): INT64_MIN;
+        int64_t until = opts.until.has_value()? opts.until.value(): INT64_MAX;
         
-        list_snapshots(n, target);
+        list_snapshots(n, target, since, until);
         return 0;
     }
 
     int process_diff(int argc, char* argv[]){
-        // dirhist diff --old_snap=<old_snapshot_file> [--new=<new_snapshot_file>] 
-        //                                         [--dir=<target_directory_path>]
+        // dirhist diff --old_snap=<old_snapshot_file> [--new_snap=<new_snapshot_file>] 
+        //          [--dir=<target_directory_path>] [--quiet[=<bool>]] [--renames=<bool>]
+        //          [--format=text|ndjson|tsv|binary] [--summary[=<depth>]] [--path=<csv_paths>]
+        //          [--cache[=<bool>]]
+        const char* usage = "Usage: dirhist diff --old_snap=<old_snapshot_file> [--options]\n"
+                            "Options: [--new_snap=<new_snapshot_file>] [--dir=<target_directory_path>]"
+                            " [--quiet[=<bool>]] [--renames=<bool>]"
+                            " [--format=text|ndjson|tsv|binary] [--summary[=<depth>]]"
+                            " [--path=<csv_paths>] [--cache[=<bool>]]";
         if (argc < 3){
             std::cerr << "Invaild instruction" << std::endl;
-            std::cerr << "Usage: dirhist diff --old_snap=<old_snapshot_file> [--options]" 
-                      << std::endl;
-            std::cerr << "Options: [--new=<new_snapshot_file>] [--dir=<target_directory_path>]" 
-                      << std::endl;
+            std::cerr << usage << std::endl;
             return -1;
         }
 
-        std::vector<std::string> vaild_opts = {"--dir", "--old_snap", "--new_snap"};
+        std::vector<std::string> vaild_opts = {"--dir", "--old_snap", "--new_snap"
+                                                , "--quiet", "--renames", "--format"
+                                                , "--summary", "--path", "--cache"};
         Options opts = parse_options(argc, argv, vaild_opts);
 
         if (!opts.vaild_ins || !opts.old_snap.has_value()){
             std::cerr << "Invaild instruction" << std::endl;
-            std::cerr << "Usage: dirhist diff --old_snap=<old_snapshot_file> [--options]" 
-                      << std::endl;
-            std::cerr << "Options: [--new=<new_snapshot_file>] [--dir=<target_directory_path>]" 
-                      << std::endl;
+            std::cerr << usage << std::endl;
             return -1;
         }
         
         fs::path target_dir = opts.dir.has_value()? opts.dir.value(): ".dirhist";
         fs::path new_snap = opts.new_snap.has_value()? 
-                                opts.new_snap.value(): dirhist::latest_snap(".dirhist");
+                                opts.new_snap.value(): dirhist::latest_snap(target_dir);
+        if (new_snap.empty()) {
+            std::cerr << "No snapshot file found at: " << target_dir.string() << std::endl;
+            return -1;
+        }
+
+        // 先比较文件头中的根哈希，相同时无需读取目录树
+        bool same = false;
+        try {
+            same = dirhist::same_snapshot(opts.old_snap.value(), new_snap);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+
+        bool quiet = opts.quiet.has_value()? opts.quiet.value(): false;
+        if (quiet && (same || !opts.path.has_value())) return same? 0: 1;
+        // 根哈希相同时不产生任何差异，按所选格式输出“无变化”
+        if (same) return emit_diff(opts, [](DiffSink&){});
+
+        // 指定范围时只沿路径按需读取两侧快照中的相关子树
+        if (opts.path.has_value()) {
+            std::vector<std::string> paths = util::split_by_comma(opts.path.value());
+            try {
+                SnapReader old_reader(opts.old_snap.value());
+                SnapReader new_reader(new_snap);
+                if (quiet) {
+                    for (const auto& scope: normalize_scopes(paths)) {
+                        auto old_ref = old_reader.lookup(scope);
+                        auto new_ref = new_reader.lookup(scope);
+                        if (!old_ref != !new_ref
+                            || (old_ref && old_ref->info.hash != new_ref->info.hash)) return 1;
+                    }
+                    return 0;
+                }
+                return emit_diff(opts, [&](DiffSink& sink){
+                    diff_paths(old_reader, new_reader, paths, sink);
+                });
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return -1;
+            }
+        }
+
+        // 缓存需写入快照目录，默认关闭，--cache 显式开启
+        bool use_cache = opts.cache.has_value()? opts.cache.value(): false;
+        if (!use_cache) {
+            auto old_root = dirhist::read_snapshot(opts.old_snap.value());
+            auto new_root = dirhist::read_snapshot(new_snap);
+            return emit_diff(opts, [&](DiffSink& sink){
+                diff_nodes(*old_root, *new_root, sink);
+            });
+        }
+
+        // 以两棵目录树的根哈希及快照时间戳为键查找缓存，命中时不读取任何目录树；
+        // 未命中时比较并写入缓存，缓存保存重命名检测前的原始差异
+        Header old_hdr, new_hdr;
+        try {
+            old_hdr = read_snapshot_header(opts.old_snap.value());
+            new_hdr = read_snapshot_header(new_snap);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        DiffCacheKey key = diff_cache_key(old_hdr, new_hdr);
+        return emit_diff(opts, [&](DiffSink& sink){
+            if (load_cached_diff(target_dir, key, sink)) return;
+            auto old_root = dirhist::read_snapshot(opts.old_snap.value());
+            auto new_root = dirhist::read_snapshot(new_snap);
+            DiffCacheWriter writer(sink, target_dir, key);
+            diff_nodes(*old_root, *new_root, writer);
+            writer.commit();
+        });
+    }
+
+    int process_status(int argc, char* argv[]){
+        // dirhist status --dir=<target_directory_path> [--old_snap=<old_snapshot_file>]
+        //          [--quiet[=<bool>]] [--renames=<bool>] [--format=text|ndjson|tsv|binary]
+        //          [--summary[=<depth>]] [--path=<csv_paths>]
+        const char* usage = "Usage: dirhist status --dir=<target_directory_path> [--options]\n"
+                            "Options: [--old_snap=<old_snapshot_file>] [--quiet[=<bool>]]"
+                            " [--renames=<bool>] [--format=text|ndjson|tsv|binary]"
+                            " [--summary[=<depth>]] [--path=<csv_paths>]";
+        std::vector<std::string> vaild_opts = {"--dir", "--old_snap", "--quiet", "--renames"
+                                                , "--format", "--summary", "--path"};
+        Options opts = parse_options(argc, argv, vaild_opts);
+
+        if (!opts.vaild_ins || !opts.dir.has_value()){
+            std::cerr << "Invaild instruction" << std::endl;
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+
+        fs::path old_snap = opts.old_snap.has_value()?
+                                opts.old_snap.value(): dirhist::latest_snap(".dirhist");
+        if (old_snap.empty()) {
+            std::cerr << "No snapshot file found at: .dirhist" << std::endl;
+            return -1;
+        }
+
+        // 以快照中的目录树为参照遍历当前目录，大小与修改时间未变的文件不再读取内容，
+        // 整个过程不写入任何文件
+        std::unique_ptr<dirhist::Node> old_root;
+        std::unique_ptr<dirhist::Node> new_root;
+        try {
+            old_root = dirhist::read_snapshot(old_snap);
+            new_root = dirhist::build_tree(opts.dir.value(), old_root.get());
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        if (!new_root) return -1;
+
+        bool quiet = opts.quiet.has_value()? opts.quiet.value(): false;
+        if (!opts.path.has_value()) {
+            if (quiet) return old_root->hash == new_root->hash? 0: 1;
+            return emit_diff(opts, [&](DiffSink& sink){
+                diff_nodes(*old_root, *new_root, sink);
+            });
+        }
 
-        auto old_root = dirhist::read_snapshot(opts.old_snap.value());
-        auto new_root = dirhist::read_snapshot(new_snap);
+        std::vector<std::string> paths = util::split_by_comma(opts.path.value());
+        if (quiet) {
+            for (const auto& scope: normalize_scopes(paths)) {
+                const Node* old_node = find_path(*old_root, scope);
+                const Node* new_node = find_path(*new_root, scope);
+                if (!old_node != !new_node
+                        || (old_node && old_node->hash != new_node->hash)) return 1;
+            }
+            return 0;
+        }
+        return emit_diff(opts, [&](DiffSink& sink){
+            diff_paths(*old_root, *new_root, paths, sink);
+        });
+    }
 
-        dirhist::diff(*old_root, *new_root);
+    int process_history(int argc, char* argv[]){
+        // dirhist history --path=<relative_path> [--dir=<target_directory_path>]
+        //          [--since=<time>] [--until=<time>]
+        const char* usage = "Usage: dirhist history --path=<relative_path> [--options]\n"
+                            "Options: [--dir=<target_directory_path>]"
+                            " [--since=<time>] [--until=<time>]";
+        std::vector<std::string> vaild_opts = {"--path", "--dir", "--since", "--until"};
+        Options opts = parse_options(argc, argv, vaild_opts);
+
+        if (!opts.vaild_ins || !opts.path.has_value()){
+            std::cerr << "Invaild instruction" << std::endl;
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+
+        fs::path target = opts.dir.has_value()? opts.dir.value(): ".dirhist";
+        int64_t since = opts.since.has_value()? opts.since.value(): INT64_MIN;
+        int64_t until = opts.until.has_value()? opts.until.value(): INT64_MAX;
+
+        std::vector<HistoryEntry> entries;
+        try {
+            entries = path_history(target, opts.path.value(), since, until);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        print_history(entries);
         return 0;
     }
 
+    int process_stat(int argc, char* argv[]){
+        // dirhist stat --file=<target_snapfile_path> --paths=<csv_paths>|-
+        const char* usage = "Usage: dirhist stat --file=<target_snapfile_path>"
+                            " --paths=<csv_paths>|-";
+        std::vector<std::string> vaild_opts = {"--file", "--paths"};
+        Options opts = parse_options(argc, argv, vaild_opts);
+
+        if (!opts.vaild_ins || !opts.file.has_value() || opts.paths.empty()){
+            std::cerr << "Invaild instruction" << std::endl;
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+
+        try {
+            return stat_paths(opts.file.value(), opts.paths)? 0: 1;
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    int process_find(int argc, char* argv[]){
+        // dirhist find --file=<target_snapfile_path> [--newer=<time>] [--larger=<bytes>]
+        //          [--name=<glob>]
+        const char* usage = "Usage: dirhist find --file=<target_snapfile_path> [--options]\n"
+                            "Options: [--newer=<time>] [--larger=<bytes>] [--name=<glob>]";
+        std::vector<std::string> vaild_opts = {"--file", "--newer", "--larger", "--name"};
+        Options opts = parse_options(argc, argv, vaild_opts);
+
+        if (!opts.vaild_ins || !opts.file.has_value()){
+            std::cerr << "Invaild instruction" << std::endl;
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+
+        FindQuery query;
+        query.newer = opts.newer;
+        query.larger = opts.larger;
+        query.name = opts.name;
+        try {
+            return print_find(opts.file.value(), query).matched > 0? 0: 1;
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    int process_du(int argc, char* argv[]){
+        // dirhist du --file=<target_snapfile_path> [--top=<n>] [--depth=<d>]
+        // dirhist du --old_snap=<old_snapshot_file> --new_snap=<new_snapshot_file>
+        //          [--top=<n>] [--depth=<d>]
+        const char* usage = "Usage: dirhist du --file=<target_snapfile_path> [--options]\n"
+                            "     : dirhist du --old_snap=<old_snapshot_file>"
+                            " --new_snap=<new_snapshot_file> [--options]\n"
+                            "Options: [--top=<n>] [--depth=<d>]";
+        std::vector<std::string> vaild_opts = {"--file", "--old_snap", "--new_snap"
+                                                , "--top", "--depth"};
+        Options opts = parse_options(argc, argv, vaild_opts);
+
+        bool growth = opts.old_snap.has_value() && opts.new_snap.has_value();
+        if (!opts.vaild_ins || opts.file.has_value() == growth
+                || opts.old_snap.has_value() != opts.new_snap.has_value()
+                || (opts.top.has_value() && opts.top.value() <= 0)
+                || (opts.depth.has_value() && opts.depth.value() < -1)){
+            std::cerr << "Invaild instruction" << std::endl;
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+
+        size_t top = opts.top.has_value()? opts.top.value(): 10;
+        int depth = opts.depth.has_value()? opts.depth.value(): -1;
+        try {
+            // 只使用快照中保存的大小，按需读取可能进入排名的子树
+            if (growth) {
+                SnapReader old_reader(opts.old_snap.value());
+                SnapReader new_reader(opts.new_snap.value());
+                print_du(largest_growth(old_reader, new_reader, top, depth), true);
+            }
+            else {
+                SnapReader reader(opts.file.value());
+                print_du(largest_entries(reader, top, depth), false);
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    // @brief 辅助函数，提示按内容查询时因版本过旧而跳过的目录树
+    static void warn_skipped(const ContainsStats& stats) {
+        if (!stats.skipped) return;
+        std::cerr << "Skipped " << stats.skipped << " snapshot tree(s) without content"
+                  << " hashes, recreate them to make them searchable" << std::endl;
+    }
+
+    int process_contains(int argc, char* argv[]){
+        // dirhist contains --path=<relative_path>|--hash=<content_hash>
+        //          [--dir=<target_directory_path>] [--since=<time>] [--until=<time>]
+        const char* usage = "Usage: dirhist contains --path=<relative_path>|--hash=<content_hash>"
+                            " [--options]\n"
+                            "Options: [--dir=<target_directory_path>]"
+                            " [--since=<time>] [--until=<time>]";
+        std::vector<std::string> vaild_opts = {"--path", "--hash", "--dir", "--since", "--until"};
+        Options opts = parse_options(argc, argv, vaild_opts);
+
+        if (!opts.vaild_ins || opts.path.has_value() == opts.hash.has_value()){
+            std::cerr << "Invaild instruction" << std::endl;
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+
+        fs::path target = opts.dir.has_value()? opts.dir.value(): ".dirhist";
+        int64_t since = opts.since.has_value()? opts.since.value(): INT64_MIN;
+        int64_t until = opts.until.has_value()? opts.until.value(): INT64_MAX;
+
+        ContainsQuery query;
+        query.path = opts.path;
+        query.content = opts.hash;
+        std::vector<ContainsHit> hits;
+        try {
+            warn_skipped(snapshots_containing(target, query, hits, since, until));
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        print_contains(hits);
+        return hits.empty()? 1: 0;
+    }
+
+    int process_dupes(int argc, char* argv[]){
+        // dirhist dupes --file=<target_snapfile_path> [--top=<n>] [--larger=<bytes>]
+        const char* usage = "Usage: dirhist dupes --file=<target_snapfile_path> [--options]\n"
+                            "Options: [--top=<n>] [--larger=<bytes>]";
+        std::vector<std::string> vaild_opts = {"--file", "--top", "--larger"};
+        Options opts = parse_options(argc, argv, vaild_opts);
+
+        if (!opts.vaild_ins || !opts.file.has_value()
+                || (opts.top.has_value() && opts.top.value() <= 0)){
+            std::cerr << "Invaild instruction" << std::endl;
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+
+        size_t top = opts.top.has_value()? opts.top.value(): 10;
+        uint64_t min_size = opts.larger.has_value()? opts.larger.value(): 0;
+        try {
+            SnapReader reader(opts.file.value());
+            print_dupes(find_dupes(reader, min_size), top);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    int process_where(int argc, char* argv[]){
+        // dirhist where --hash=<content_hash>|--local=<local_file>
+        //          [--dir=<target_directory_path>] [--since=<time>] [--until=<time>]
+        const char* usage = "Usage: dirhist where --hash=<content_hash>|--local=<local_file>"
+                            " [--options]\n"
+                            "Options: [--dir=<target_directory_path>]"
+                            " [--since=<time>] [--until=<time>]";
+        std::vector<std::string> vaild_opts = {"--hash", "--local", "--dir", "--since", "--until"};
+        Options opts = parse_options(argc, argv, vaild_opts);
+
+        if (!opts.vaild_ins || opts.hash.has_value() == opts.local.has_value()){
+            std::cerr << "Invaild instruction" << std::endl;
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+
+        // 本地文件按快照中内容哈希的算法计算
+        std::optional<std::array<uint8_t, 32>> content = opts.hash;
+        if (opts.local.has_value()) {
+            std::error_code ec;
+            if (!fs::is_regular_file(opts.local.value(), ec)
+                    || !(content = util::sha256_file(opts.local.value()))) {
+                std::cerr << "Error opening local file: " << opts.local.value() << std::endl;
+                return -1;
+            }
+        }
+
+        fs::path target = opts.dir.has_value()? opts.dir.value(): ".dirhist";
+        int64_t since = opts.since.has_value()? opts.since.value(): INT64_MIN;
+        int64_t until = opts.until.has_value()? opts.until.value(): INT64_MAX;
+        std::vector<ContainsHit> hits;
+        try {
+            warn_skipped(where_content(target, content.value(), hits, since, until));
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        print_contains(hits);
+        return hits.empty()? 1: 0;
+    }
+
     int process_rm(int argc, char* argv[]){
         // dirhist rm [--dir=<directory_path>]
         std::vector<std::string> vaild_opts = {"--dir"};
@@ -249,4 +879,26 @@ namespace dirhist{
         dirhist::clean_snapshots(target_dir);
         return 0;
     }
+
+    int process_gc(int argc, char* argv[]){
+        // dirhist gc [--dir=<directory_path>]
+        std::vector<std::string> vaild_opts = {"--dir"};
+        Options opts = parse_options(argc, argv, vaild_opts);
+
+        if (!opts.vaild_ins){
+            std::cerr << "Invaild instruction\n"
+                << "Usage: dirhist gc [--dir=<directory_path>]" << std::endl;
+            return -1;
+        }
+
+        fs::path target_dir = opts.dir.has_value()? opts.dir.value(): ".dirhist";
+        try {
+            dirhist::gc_objects(target_dir);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        return 0;
+    }
 }
\ No newline at end of file
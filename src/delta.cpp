@@ -0,0 +1,275 @@
+/*
+ * @file    src/delta.cpp
+ * @brief   This source file implements the delta snapshots against a parent snapshot.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <unordered_set>
+#include "dirhist/delta.h"
+#include "dirhist/diff.h"
+#include "dirhist/bloom.h"
+#include "dirhist/catalog.h"
+#include "dirhist/index.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    // @brief 判断节点是否为目录（符号链接除外）
+    static bool is_real_dir(const Node& node) {
+        return node.is_dir && !node.is_symlink;
+    }
+
+    bool same_node_info(const Node& a, const Node& b) {
+        return a.path == b.path && a.is_dir == b.is_dir && a.is_symlink == b.is_symlink
+            && a.size == b.size && a.mtime == b.mtime && a.hash == b.hash
+            && a.content_hash == b.content_hash && a.max_mtime == b.max_mtime
+            && a.max_file_size == b.max_file_size && a.file_cnt == b.file_cnt;
+    }
+
+    bool inherit_checks_info(uint8_t version) {
+        return version >= 7;
+    }
+
+    // @brief 辅助函数，自底向上标记与父快照中节点信息完全一致的目录子树
+    // @param node 待比较节点
+    // @param base 父快照中同路径的节点，不存在时为 nullptr
+    // @param same 整棵子树一致的目录节点集合
+    // @return 以 node 为根的子树与父快照完全一致时返回true
+    // @note 哈希值不覆盖 mtime 与聚合信息，仅 touch 过的子树哈希值不变，需逐节点比较
+    static bool mark_unchanged(const Node& node, const Node* base
+                                    , std::unordered_set<const Node*>& same) {
+        if (!base) return false;
+        bool eq = same_node_info(node, *base);
+        if (!is_real_dir(node)) return eq;
+        if (!is_real_dir(*base)) return false;
+
+        // 不短路，使每个子目录都得到标记
+        eq = eq && node.children.size() == base->children.size();
+        for (const auto& child: node.children) {
+            eq = mark_unchanged(*child, find_child(*base, child->path), same) && eq;
+        }
+        if (eq) same.insert(&node);
+        return eq;
+    }
+
+    // @brief 辅助函数，dfs 序列化增量节点
+    // @param same 整棵子树与父快照一致的目录节点集合，见 mark_unchanged
+    static void write_delta_rec(std::ofstream& ofs, const Node& node, const Node* base
+                    , uint64_t& offset, const std::unordered_set<const Node*>& same) {
+        ofs.seekp(offset);
+        write_node_info(ofs, node);
+
+        // 整棵子树（含 mtime 与聚合信息）与父快照相同，仅写入继承标记
+        if (same.count(&node)) {
+            write(ofs, INHERIT);
+            offset = ofs.tellp();
+            return;
+        }
+
+        // 两侧子节点均按路径字典序排列，逐个匹配父快照中同路径的子节点；
+        // 与父快照一致的子节点不再写入记录，下标连续的合并为一个继承区间
+        const Node* base_dir = (base && is_real_dir(*base))? base: nullptr;
+        std::vector<uint64_t> entries;      // 子节点记录偏移（待回填）或继承区间
+        std::vector<size_t> slots;          // 需写入的子节点下标，依次对应待回填的表项
+        std::vector<const Node*> child_bases(node.children.size(), nullptr);
+        bool runs = false;
+        size_t j = 0;
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            const Node& child = *node.children[i];
+            if (base_dir) {
+                const auto& base_children = base_dir->children;
+                while (j < base_children.size() && base_children[j]->path < child.path) ++j;
+                if (j < base_children.size() && base_children[j]->path == child.path) {
+                    child_bases[i] = base_children[j].get();
+                }
+            }
+            bool unchanged = child_bases[i] && (is_real_dir(child)? same.count(&child) > 0
+                                                : same_node_info(child, *child_bases[i]));
+            if (unchanged && j < MAX_RUN_START) {
+                uint32_t idx = static_cast<uint32_t>(j);
+                if (!entries.empty() && (entries.back() & RUN_FLAG)
+                        && uint64_t(run_start(entries.back())) + run_len(entries.back()) == idx
+                        && run_len(entries.back()) < MAX_RUN_LEN) {
+                    entries.back() += 1ULL << 32;
+                }
+                else entries.push_back(make_run(idx, 1));
+                runs = true;
+                continue;
+            }
+            slots.push_back(i);
+            entries.push_back(0);
+        }
+
+        if (runs) {
+            write(ofs, INHERIT_RUNS);
+            write(ofs, static_cast<uint32_t>(entries.size()));
+        }
+        else write(ofs, static_cast<uint32_t>(node.children.size()));
+        uint64_t table_offset = ofs.tellp();
+        ofs.seekp(table_offset + sizeof(uint64_t) * entries.size(), std::ios::beg);
+
+        // 变化的子节点依次递归写入，表项中的位置与子节点顺序一致
+        size_t slot = 0;
+        for (size_t k = 0; k < entries.size(); ++k) {
+            if (entries[k] & RUN_FLAG) continue;
+            size_t i = slots[slot++];
+            offset = ofs.tellp();
+            entries[k] = offset;
+            write_delta_rec(ofs, *node.children[i], child_bases[i], offset, same);
+        }
+
+        // 回填子节点偏移量与继承区间
+        uint64_t back = ofs.tellp();
+        ofs.seekp(table_offset, std::ios::beg);
+        for (const uint64_t& entry: entries) {
+            write(ofs, entry);
+        }
+        ofs.seekp(back, std::ios::beg);
+        offset = back;
+    }
+
+    void write_delta_node(std::ofstream& ofs, const Node& node
+                                    , const Node* base, uint64_t& offset) {
+        std::unordered_set<const Node*> same;
+        mark_unchanged(node, base, same);
+        write_delta_rec(ofs, node, base, offset, same);
+    }
+
+    std::unique_ptr<Node> read_delta_node(std::ifstream& ifs, uint64_t offset
+                                            , Node* base_dir, uint8_t version) {
+        ifs.seekg(offset);
+        auto node = std::make_unique<Node>();
+        read_node_info(ifs, *node, version);
+        Node* base = base_dir? find_child(*base_dir, node->path): nullptr;
+
+        uint32_t cnt = 0;
+        read(ifs, cnt);
+
+        // 继承父快照中的整棵子树
+        if (cnt == INHERIT) {
+            // version 7 起仅在节点信息完全一致时写入继承标记，旧版本只保证哈希相同
+            if (!base || base->hash != node->hash
+                    || (inherit_checks_info(version) && !same_node_info(*base, *node))) {
+                throw std::runtime_error("Corrupted delta snapshot, missing base for: "
+                                                                    + node->path);
+            }
+            node->children = std::move(base->children);
+            return node;
+        }
+        if (cnt == INHERIT_RUNS) {
+            uint32_t n = 0;
+            read(ifs, n);
+            std::vector<uint64_t> entries(n);
+            ifs.read(reinterpret_cast<char*>(entries.data()), n * sizeof(uint64_t));
+            if (!ifs || !base || !is_real_dir(*base)) {
+                throw std::runtime_error("Corrupted delta snapshot, missing base for: "
+                                                                    + node->path);
+            }
+
+            // 先读取写入的子节点，其父快照节点经由 base 的子节点查找，
+            // 之后再从 base 中移出按区间继承的子节点
+            std::vector<std::unique_ptr<Node>> written(n);
+            for (uint32_t k = 0; k < n; ++k) {
+                if (!(entries[k] & RUN_FLAG) && entries[k] != 0) {
+                    written[k] = read_delta_node(ifs, entries[k], base, version);
+                }
+            }
+            for (uint32_t k = 0; k < n; ++k) {
+                if (!(entries[k] & RUN_FLAG)) {
+                    if (written[k]) node->children.push_back(std::move(written[k]));
+                    continue;
+                }
+                uint64_t start = run_start(entries[k]);
+                uint64_t end = start + run_len(entries[k]);
+                for (uint64_t t = start; t < end; ++t) {
+                    if (t >= base->children.size() || !base->children[t]) {
+                        throw std::runtime_error("Corrupted delta snapshot, missing base for: "
+                                                                    + node->path);
+                    }
+                    node->children.push_back(std::move(base->children[t]));
+                }
+            }
+            return node;
+        }
+        if (cnt == 0) return node;
+
+        std::vector<uint64_t> offsets(cnt);
+        ifs.read(reinterpret_cast<char*>(offsets.data()), cnt * sizeof(uint64_t));
+
+        node->children.reserve(cnt);
+        for (uint64_t child_offset: offsets) {
+            if (child_offset != 0)
+                node->children.emplace_back(read_delta_node(ifs, child_offset
+                                                                , base, version));
+        }
+        return node;
+    }
+
+    std::unique_ptr<Node> read_delta(std::ifstream& ifs, const Header& hdr
+                                                , const fs::path& input_dir) {
+        // 父快照本身也可能是增量快照，read_snapshot 会沿增量链递归读取
+        fs::path parent = input_dir / ("snap-" + std::to_string(hdr.parent_ts) + ".bin");
+        std::unique_ptr<Node> parent_root = read_snapshot(parent);
+
+        // 构造虚拟父目录，使根节点也能通过 find_child 找到其对应节点
+        Node base_dir;
+        base_dir.children.push_back(std::move(parent_root));
+        return read_delta_node(ifs, hdr.root_offset, &base_dir, hdr.version);
+    }
+
+    void write_delta_snapshot(const Node& root, int64_t ts
+                        , const fs::path& output_dir, uint32_t max_chain) {
+        fs::create_directories(output_dir);
+
+        // 以最新快照作为父快照
+        fs::path parent = latest_snap(output_dir);
+        Header parent_hdr;
+        std::unique_ptr<Node> parent_root;
+        if (!parent.empty()) {
+            std::ifstream ifs(parent, std::ios::binary);
+            if (ifs && read_header(ifs, parent_hdr)
+                                        && parent_hdr.chain_len < max_chain) {
+                parent_root = read_snapshot(parent);
+            }
+        }
+
+        // 父快照不可用时写入完整快照作为新的基准
+        if (!parent_root || parent_root->abs_root != root.abs_root) {
+            std::cout << "Writing full base snapshot." << std::endl;
+            write_snapshot(root, ts, output_dir);
+            return;
+        }
+
+        fs::path output_file = output_dir / ("snap-" + std::to_string(ts) + ".bin");
+        std::ofstream ofs(output_file, std::ios::binary);
+        if (!ofs) {
+            throw std::runtime_error("Error opening output file: "
+                                            + output_file.string());
+        }
+
+        // 设置文件头
+        Header hdr;
+        hdr.kind = static_cast<uint8_t>(SnapKind::Delta);
+        hdr.timestamp = ts;
+        hdr.root_offset = sizeof(Header);
+        hdr.root_hash = root.hash;
+        hdr.stats = tree_stats(root);
+        hdr.parent_ts = parent_hdr.timestamp;
+        hdr.chain_len = parent_hdr.chain_len + 1;
+
+        uint64_t offset = hdr.root_offset;
+        write_delta_node(ofs, root, parent_root.get(), offset);
+        hdr.data_size = offset - hdr.root_offset;
+
+        ofs.seekp(0, std::ios::beg);
+        write(ofs, hdr);
+        ofs.close();
+
+        // 登记到快照目录，并生成路径与内容哈希过滤器及内容索引段
+        catalog_add(output_file, hdr);
+        save_filters(output_file.parent_path(), root);
+        save_index(output_file.parent_path(), root);
+        std::cout << "Wrote delta snapshot against: " << parent.filename().string()
+                  << " (chain length " << hdr.chain_len << ")" << std::endl;
+    }
+}
@@ -7,29 +7,63 @@
 
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
 #include "dirhist/diff.h"
+#include "dirhist/serialize.h"
 #include "dirhist/log.h"
+#include "dirhist/catalog.h"
 #include "internal/util.h"
+#include "internal/thread_pool.h"
 
 namespace dirhist {
-    void print_colored_DiffEntry(const DiffEntry& de) {
+    // 变化的子目录对的直接子节点数之和不小于该值时派发到线程池
+    constexpr size_t PARALLEL_DIFF_CHILDREN = 32;
+    // 一次目录比较中并行任务缓冲的差异条目总数上限，为0时不限制
+    constexpr size_t DIFF_BUFFER_ENTRIES = 1 << 18;
+
+    // @brief 辅助函数，将 str 右对齐到 width 列追加到 buf
+    static void append_right(std::string& buf, const std::string& str, size_t width) {
+        if (str.size() < width) buf.append(width - str.size(), ' ');
+        buf += str;
+    }
+
+    // @brief 辅助函数，将 str 左对齐到 width 列追加到 buf
+    static void append_left(std::string& buf, const std::string& str, size_t width) {
+        buf += str;
+        if (str.size() < width) buf.append(width - str.size(), ' ');
+    }
+
+    void format_colored_DiffEntry(std::string& buf, const DiffEntry& de) {
         const char* color = nullptr;
-        char flag = '\0';
+        const char* flag = nullptr;
 
         switch (de.type) {
             case ChangeType::Added: {
                 color = util::color::GREEN;
-                flag = '+';
+                flag = "+";
                 break;
             }
             case ChangeType::Deleted: {
                 color = util::color::RED;
-                flag = '-';
+                flag = "-";
                 break;
             }
             case ChangeType::Modified: {
                 color = util::color::YELLOW;
-                flag = 'M';
+                flag = "M";
+                break;
+            }
+            case ChangeType::Renamed: {
+                color = util::color::CYAN;
+                flag = "R";
+                break;
+            }
+            case ChangeType::Moved: {
+                color = util::color::CYAN;
+                flag = "MV";
                 break;
             }
             default: {
@@ -38,133 +72,507 @@ namespace dirhist {
             }
         }
 
-        std::cout << color 
-                  << std::right << std::setw(4) << flag 
-                  << std::right << std::setw(22) 
-                  << util::ts_str(de.type == ChangeType::Deleted? 
-                            de.old_mtime: de.new_mtime);
+        buf += color;
+        append_right(buf, flag, 4);
+        append_right(buf, util::ts_str(de.type == ChangeType::Deleted? 
+                                        de.old_mtime: de.new_mtime), 22);
 
-        if (de.type == ChangeType::Added) {
-            std::cout << std::right << std::setw(20) 
-                      << de.new_size << std::string(23, ' ');
+        if (de.type == ChangeType::Added || de.type == ChangeType::Renamed
+                                         || de.type == ChangeType::Moved) {
+            append_right(buf, std::to_string(de.new_size), 20);
+            buf.append(23, ' ');
         }
         else if (de.type == ChangeType::Deleted) {
-            std::cout << std::right << std::setw(20) 
-                      << de.old_size << std::string(23, ' ');
+            append_right(buf, std::to_string(de.old_size), 20);
+            buf.append(23, ' ');
         }
         else {
-            std::cout << std::right << std::setw(20) << de.old_size << " → "
-                      << std::left << std::setw(20) << de.new_size;
+            append_right(buf, std::to_string(de.old_size), 20);
+            buf += " → ";
+            append_left(buf, std::to_string(de.new_size), 20);
+        }
+
+        if (de.type == ChangeType::Renamed || de.type == ChangeType::Moved) {
+            buf += de.old_path;
+            buf += " → ";
         }
+        buf += de.path;
+        buf += util::color::RESET;
+        buf += '\n';
+    }
 
-        std::cout << de.path << util::color::RESET << std::endl;
+    void print_colored_DiffEntry(const DiffEntry& de) {
+        std::string buf;
+        format_colored_DiffEntry(buf, de);
+        std::cout << buf;
     }
 
-    void mark_subtree(const Node& node, ChangeType type, std::vector<DiffEntry>& out) {
+    void BufferedDiffSink::finish() {
+        flush();
+        os_.flush();
+    }
+
+    void BufferedDiffSink::commit() {
+        ++count_;
+        if (buf_.size() >= BUFFER_SIZE) flush();
+    }
+
+    void BufferedDiffSink::flush() {
+        if (buf_.empty()) return;
+        os_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+        buf_.clear();
+    }
+
+    void DiffPrinter::on_entry(const DiffEntry& entry) {
+        // 首条差异前输出表头
+        if (count_ == 0) {
+            buf_ += "Changes between snapshots: \n";
+            append_right(buf_, "type", 4);
+            append_right(buf_, "time", 22);
+            append_right(buf_, "size[B]", 20);
+            buf_.append(23, ' ');
+            buf_ += "path\n";
+        }
+        format_colored_DiffEntry(buf_, entry);
+        commit();
+    }
+
+    void DiffPrinter::finish() {
+        if (count_ == 0) buf_ += "No changes.\n";
+        BufferedDiffSink::finish();
+    }
+
+    // @brief 辅助函数，递归标记子树，复用同一个条目对象
+    static void mark_subtree(const Node& node, DiffEntry& de, DiffSink& sink) {
         // 无论内部节点还是叶子节点，都先处理自身
+        de.path = node.path;
+        de.is_dir = node.is_dir && !node.is_symlink;
+        de.content_hash = node.content_hash;
         // 增加的条目只需要记录当前的信息即可
-        if (type == ChangeType::Added) {
-            out.push_back(DiffEntry{.type = type, .path = node.path,
-                            .new_size = node.size, .new_mtime = node.mtime, 
-                            .new_hash = node.hash});
+        if (de.type == ChangeType::Added) {
+            de.new_size = node.size;
+            de.new_mtime = node.mtime;
+            de.new_hash = node.hash;
         }
         // 减少的条目只需要记录先前的信息即可
-        else if (type == ChangeType::Deleted) {
-            out.push_back(DiffEntry{.type = type, .path = node.path,
-                            .old_size = node.size, .old_mtime = node.mtime,
-                            .old_hash = node.hash});
+        else {
+            de.old_size = node.size;
+            de.old_mtime = node.mtime;
+            de.old_hash = node.hash;
         }
+        sink.on_entry(de);
         // 叶子节点（文件或符号链接），处理后直接退出
         if (!node.is_dir || node.is_symlink) return;
         // 内部节点（目录）则递归处理
-        else {
-            // 遍历孩子节点
-            for (const auto& child: node.children){
-                mark_subtree(*child, type, out);
+        for (const auto& child: node.children) {
+            mark_subtree(*child, de, sink);
+        }
+    }
+
+    void mark_subtree(const Node& node, ChangeType type, DiffSink& sink) {
+        DiffEntry de;
+        de.type = type;
+        mark_subtree(node, de, sink);
+    }
+
+    void mark_subtree(const Node& node, ChangeType type, std::vector<DiffEntry>& out) {
+        DiffCollector sink(out);
+        mark_subtree(node, type, sink);
+    }
+
+    // @brief 判断节点是否为目录（符号链接除外）
+    static bool is_real_dir(const Node& node) {
+        return node.is_dir && !node.is_symlink;
+    }
+
+    // @brief 目录子节点归并的一步
+    struct MergeStep {
+        const Node* old_child = nullptr;    // 为空表示新增
+        const Node* new_child = nullptr;    // 为空表示删除
+    };
+
+    // @brief 判断一对子节点是否值得作为独立任务并行比较
+    static bool worth_forking(const MergeStep& step) {
+        return step.old_child && step.new_child
+            && step.old_child->hash != step.new_child->hash
+            && is_real_dir(*step.old_child) && is_real_dir(*step.new_child)
+            && step.old_child->children.size() + step.new_child->children.size()
+                                                    >= PARALLEL_DIFF_CHILDREN;
+    }
+
+    // @brief 执行一步归并，结果交给 sink
+    static void run_step(const MergeStep& step, DiffSink& sink) {
+        if (!step.new_child) mark_subtree(*step.old_child, ChangeType::Deleted, sink);
+        else if (!step.old_child) mark_subtree(*step.new_child, ChangeType::Added, sink);
+        else diff_nodes(*step.old_child, *step.new_child, sink);
+    }
+
+    // @brief 并行比较的一个子目录对，差异写入任务独占的缓冲区
+    // @note 生产者从不等待消费者，各任务互不阻塞；等待线程按归并顺序等到任务结束后
+    //       整体转交。所有任务共享缓冲条目数上限，超出上限的任务放弃缓冲并提前结束，
+    //       由等待线程按序串行重新比较该子目录对
+    class DiffBuffer: public DiffSink {
+    public:
+        std::atomic<bool> claimed{false};   // 任务已被工作线程或等待线程认领
+        std::atomic<bool> abandoned{false}; // 等待线程异常退出，不再需要输出
+        std::atomic<int64_t>* budget = nullptr; // 共享的剩余缓冲条目数，为空时不限制
+
+        void on_entry(const DiffEntry& entry) override {
+            if (abandoned.load(std::memory_order_relaxed)) throw Stop{};
+            if (budget && budget->fetch_sub(1, std::memory_order_relaxed) <= 0) {
+                budget->fetch_add(1, std::memory_order_relaxed);
+                throw Stop{};
             }
+            entries_.push_back(entry);
         }
+
+        // @brief 在工作线程中执行比较，结束后唤醒等待线程
+        void produce(const MergeStep& step) {
+            std::exception_ptr error;
+            bool overflowed = false;
+            try {
+                diff_nodes(*step.old_child, *step.new_child, *this);
+            }
+            catch (const Stop&) {
+                overflowed = true;
+                release();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mtx_);
+            done_ = true;
+            overflowed_ = overflowed;
+            error_ = error;
+            cv_.notify_all();
+        }
+
+        // @brief 等待任务结束，将全部差异按序转交给 sink
+        // @return 任务因缓冲超出上限放弃时返回false，差异需由调用者重新比较
+        bool drain_to(DiffSink& sink) {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cv_.wait(lock, [this]{ return done_; });
+                if (error_) std::rethrow_exception(error_);
+                if (overflowed_) return false;
+            }
+            for (const auto& de: entries_) sink.on_entry(de);
+            release();
+            return true;
+        }
+
+    private:
+        // 缓冲超出上限或消费者放弃时中止比较
+        struct Stop {};
+
+        // @brief 释放缓冲区并归还其占用的条目数
+        void release() {
+            if (budget) budget->fetch_add(static_cast<int64_t>(entries_.size())
+                                        , std::memory_order_relaxed);
+            std::vector<DiffEntry>().swap(entries_);
+        }
+
+        std::vector<DiffEntry> entries_;
+        bool done_ = false;
+        bool overflowed_ = false;
+        std::exception_ptr error_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+    };
+
+    // @brief 辅助函数，比较两个目录的子节点
+    // @param old_node 旧目录节点
+    // @param new_node 新目录节点
+    // @param sink 差异接收者
+    // @note 存在多个较大的变化子目录对时，各自派发到线程池，差异写入任务独占的缓冲区；
+    //       当前线程按归并顺序直接输出其余步骤，遇到并行步骤时若任务尚未开始则
+    //       亲自执行并直接输出，否则等待其结束后转交缓冲的差异，输出与串行比较完全一致
+    static void diff_children(const Node& old_node, const Node& new_node
+                                                            , DiffSink& sink) {
+        // 目录树创建时，节点子节点已按照其路径字典序排序，故无需再次排序
+        // 见 snapshot.cpp::walk_dir
+        std::vector<MergeStep> steps;
+        size_t i = 0, j = 0;
+        size_t old_child_cnt = old_node.children.size();
+        size_t new_child_cnt = new_node.children.size();
+        size_t forks = 0;
+
+        while (i < old_child_cnt || j < new_child_cnt) {
+            if (i < old_child_cnt && (j == new_child_cnt 
+                || old_node.children[i]->path < new_node.children[j]->path)) {
+                    steps.push_back({old_node.children[i].get(), nullptr});
+                    ++i;
+            }
+            else if (j < new_child_cnt && (i == old_child_cnt
+                || new_node.children[j]->path < old_node.children[i]->path)) {
+                    steps.push_back({nullptr, new_node.children[j].get()});
+                    ++j;
+            }
+            else {
+                // 哈希值相同的子树无变化，无需记录
+                if (old_node.children[i]->hash != new_node.children[j]->hash) {
+                    steps.push_back({old_node.children[i].get()
+                                    , new_node.children[j].get()});
+                    if (worth_forking(steps.back())) ++forks;
+                }
+                ++i;++j;
+            }
+        }
+
+        // 只有一个较大的变化子树或线程池没有工作线程时并行无收益，直接串行比较
+        if (forks < 2 || util::ThreadPool::instance().workers() == 0) {
+            for (const auto& step: steps) run_step(step, sink);
+            return;
+        }
+
+        // 先派发所有较大的子目录对，缓冲区数量预先确定，运行期间不会重新分配
+        std::vector<DiffBuffer> buffers(forks);
+        std::atomic<int64_t> budget{static_cast<int64_t>(DIFF_BUFFER_ENTRIES)};
+        util::TaskGroup group;
+        size_t idx = 0;
+        for (const auto& step: steps) {
+            if (!worth_forking(step)) continue;
+            DiffBuffer* buf = &buffers[idx++];
+            if (DIFF_BUFFER_ENTRIES > 0) buf->budget = &budget;
+            group.run([&step, buf]{
+                if (!buf->claimed.exchange(true)) buf->produce(step);
+            });
+        }
+
+        // 按归并顺序输出
+        try {
+            idx = 0;
+            for (const auto& step: steps) {
+                if (!worth_forking(step)) {
+                    run_step(step, sink);
+                    continue;
+                }
+                DiffBuffer& buf = buffers[idx++];
+                if (!buf.claimed.exchange(true) || !buf.drain_to(sink)) run_step(step, sink);
+            }
+        }
+        catch (...) {
+            // 尚未开始的任务不再执行，运行中的任务提前结束
+            for (auto& buf: buffers) {
+                buf.claimed.exchange(true);
+                buf.abandoned = true;
+            }
+            try { group.wait(); } catch (...) {}
+            throw;
+        }
+        group.wait();
     }
 
-    void diff_nodes(const Node& old_node, const Node& new_node
-                                            , std::vector<DiffEntry>& out) {
+    void diff_nodes(const Node& old_node, const Node& new_node, DiffSink& sink) {
         // 节点hash值相同，节点对应子树无变化
         if (old_node.hash == new_node.hash) return;
         // 旧节点为叶子节点，而新节点为内部节点
-        if (!(old_node.is_dir && !old_node.is_symlink) 
-            && (new_node.is_dir && !new_node.is_symlink)) {
+        if (!is_real_dir(old_node) && is_real_dir(new_node)) {
             // 旧节点标记为删除，新节点标记为新增（包括其子树）
-            out.push_back(DiffEntry{.type = ChangeType::Deleted, .path = old_node.path, 
-                        .old_size = old_node.size, .old_mtime = old_node.mtime, 
-                        .old_hash = old_node.hash});
+            DiffEntry de;
+            de.type = ChangeType::Deleted;
+            de.path = old_node.path;
+            de.old_size = old_node.size;
+            de.old_mtime = old_node.mtime;
+            de.old_hash = old_node.hash;
+            de.content_hash = old_node.content_hash;
+            sink.on_entry(de);
             
             // 新节点及其子树标记为新增
-            mark_subtree(new_node, ChangeType::Added, out);
+            mark_subtree(new_node, ChangeType::Added, sink);
         }
         // 旧节点为内部节点，而新节点为叶子节点
-        else if ((old_node.is_dir && !old_node.is_symlink) 
-            && !(new_node.is_dir && !new_node.is_symlink)) {
+        else if (is_real_dir(old_node) && !is_real_dir(new_node)) {
             // 旧节点及其子树标记为删除
-            mark_subtree(old_node, ChangeType::Deleted, out);
+            mark_subtree(old_node, ChangeType::Deleted, sink);
             // 新节点标记为新增
-            out.push_back(DiffEntry{.type = ChangeType::Added, .path = new_node.path,
-                        .new_size = new_node.size, .new_mtime = new_node.mtime, 
-                        .new_hash = new_node.hash});
+            DiffEntry de;
+            de.type = ChangeType::Added;
+            de.path = new_node.path;
+            de.new_size = new_node.size;
+            de.new_mtime = new_node.mtime;
+            de.new_hash = new_node.hash;
+            de.content_hash = new_node.content_hash;
+            sink.on_entry(de);
         }
         // 旧节点和新节点均为叶子节点
-        else if (!(old_node.is_dir && !old_node.is_symlink)
-            && !(new_node.is_dir && !new_node.is_symlink)) {
+        else if (!is_real_dir(old_node) && !is_real_dir(new_node)) {
             // 直接标记为修改即可
-            out.push_back(DiffEntry{.type = ChangeType::Modified, .path = new_node.path, 
+            sink.on_entry(DiffEntry{.type = ChangeType::Modified, .path = new_node.path, .old_path = {},
                         .old_size = old_node.size, .new_size = new_node.size, 
                         .old_mtime = old_node.mtime, .new_mtime = new_node.mtime, 
-                        .old_hash = old_node.hash, .new_hash = new_node.hash});
+                        .old_hash = old_node.hash, .new_hash = new_node.hash,
+                        .content_hash = new_node.content_hash});
         }
         // 否则，旧节点和新节点均为目录，递归处理其子节点
-        else {
-            // 目录树创建时，节点子节点已按照其路径字典序排序，故无需再次排序
-            // 见 snapshot.cpp::walk_dir
-            size_t i = 0, j = 0;
-            size_t old_child_cnt = old_node.children.size();
-            size_t new_child_cnt = new_node.children.size();
-
-            while (i < old_child_cnt || j < new_child_cnt) {
-                if (i < old_child_cnt && (j == new_child_cnt 
-                    || old_node.children[i]->path < new_node.children[j]->path)) {
-                        mark_subtree(*old_node.children[i], ChangeType::Deleted, out);
-                        ++i;
-                }
-                else if (j < new_child_cnt && (i == old_child_cnt
-                    || new_node.children[j]->path < old_node.children[i]->path)) {
-                        mark_subtree(*new_node.children[j], ChangeType::Added, out);
-                        ++j;
-                }
-                else {
-                    diff_nodes(*old_node.children[i], *new_node.children[j], out);
-                    ++i;++j;
-                }
-            }
+        else diff_children(old_node, new_node, sink);
+    }
+
+    void diff_nodes(const Node& old_node, const Node& new_node
+                                            , std::vector<DiffEntry>& out) {
+        DiffCollector sink(out);
+        diff_nodes(old_node, new_node, sink);
+    }
+
+    // @brief 辅助函数，判断 path 是否位于目录 dir 之下
+    static bool is_under(const std::string& path, const std::string& dir) {
+        if (dir.empty()) return !path.empty();
+        return path.size() > dir.size() && path[dir.size()] == '/'
+                                        && path.compare(0, dir.size(), dir) == 0;
+    }
+
+    std::vector<std::string> normalize_scopes(const std::vector<std::string>& paths) {
+        std::vector<std::string> scopes;
+        for (const auto& p: paths) {
+            std::vector<std::string> prefixes = path_prefixes(p);
+            // 根目录覆盖所有范围
+            if (prefixes.empty()) return {"."};
+            scopes.push_back(prefixes.back());
+        }
+        std::sort(scopes.begin(), scopes.end());
+        scopes.erase(std::unique(scopes.begin(), scopes.end()), scopes.end());
+
+        // "a-b" 排在 "a" 与 "a/b" 之间，需与所有已保留的路径比较
+        std::vector<std::string> res;
+        for (const auto& scope: scopes) {
+            bool covered = std::any_of(res.begin(), res.end()
+                        , [&](const std::string& kept){return is_under(scope, kept);});
+            if (!covered) res.push_back(scope);
+        }
+        return res;
+    }
+
+    void diff_paths(const Node& old_root, const Node& new_root
+                    , const std::vector<std::string>& paths, DiffSink& sink) {
+        for (const auto& scope: normalize_scopes(paths)) {
+            const Node* old_node = find_path(old_root, scope);
+            const Node* new_node = find_path(new_root, scope);
+            if (old_node && new_node) diff_nodes(*old_node, *new_node, sink);
+            else if (old_node) mark_subtree(*old_node, ChangeType::Deleted, sink);
+            else if (new_node) mark_subtree(*new_node, ChangeType::Added, sink);
         }
     }
 
-    void diff(const Node& old_root, const Node& new_root) {
-        std::vector<DiffEntry> out;
-        diff_nodes(old_root, new_root, out);
+    // @brief 辅助函数，获取路径的父目录部分
+    static std::string parent_of(const std::string& path) {
+        size_t pos = path.rfind('/');
+        return pos == std::string::npos? std::string(): path.substr(0, pos);
+    }
 
-        if (out.empty()) {
-            std::cout << "No changes." << std::endl;
-            return;
+    // @brief 辅助函数，获取路径的最后一段
+    static std::string name_of(const std::string& path) {
+        size_t pos = path.rfind('/');
+        return pos == std::string::npos? path: path.substr(pos + 1);
+    }
+
+    void RenameDetector::finish() {
+        std::vector<DiffEntry>& es = entries_;
+        std::vector<bool> consumed(es.size(), false);
+
+        // es[k] 子孙条目的末尾下标，mark_subtree 按 dfs 先序输出，子孙条目紧随其后
+        auto subtree_end = [&](size_t k) {
+            size_t i = k + 1;
+            if (!es[k].is_dir) return i;
+            while (i < es.size() && es[i].type == es[k].type
+                                 && is_under(es[i].path, es[k].path)) ++i;
+            return i;
+        };
+        auto consume_subtree = [&](size_t k) {
+            for (size_t i = k, end = subtree_end(k); i < end; ++i) consumed[i] = true;
+        };
+        auto intact = [&](size_t k) {
+            for (size_t i = k, end = subtree_end(k); i < end; ++i) {
+                if (consumed[i]) return false;
+            }
+            return true;
+        };
+        // 空文件与空目录内容哈希相同，配对没有意义；旧快照节点缺少内容哈希
+        auto pairable = [](const DiffEntry& e) {
+            return e.content_hash != std::array<uint8_t, 32>{0}
+                                    && e.old_size + e.new_size > 0;
+        };
+
+        // 同一内容哈希的候选删除条目，游标之前的条目均已不可用（被配对后不会恢复）
+        struct Candidates {
+            std::vector<size_t> idx;
+            size_t cursor = 0;
+        };
+        auto next_intact = [&](Candidates& c) {
+            while (c.cursor < c.idx.size() && !intact(c.idx[c.cursor])) ++c.cursor;
+            return c.cursor < c.idx.size()? c.idx[c.cursor]: es.size();
+        };
+
+        // 先配对目录再配对文件，使整棵子树的移动优先于其中单个文件的移动
+        for (bool dirs: {true, false}) {
+            // 以内容哈希、内容哈希加文件名为键索引删除条目，每次配对摊还 O(1)
+            std::unordered_map<std::string, Candidates> by_hash, by_name;
+            for (size_t k = 0; k < es.size(); ++k) {
+                if (es[k].type != ChangeType::Deleted || es[k].is_dir != dirs
+                                                      || !pairable(es[k])) continue;
+                std::string key = util::hash_to_str(es[k].content_hash);
+                by_name[key + name_of(es[k].path)].idx.push_back(k);
+                by_hash[std::move(key)].idx.push_back(k);
+            }
+            if (by_hash.empty()) continue;
+
+            for (size_t k = 0; k < es.size(); ++k) {
+                DiffEntry& added = es[k];
+                if (consumed[k] || added.type != ChangeType::Added
+                                || added.is_dir != dirs || !pairable(added)) continue;
+
+                std::string key = util::hash_to_str(added.content_hash);
+                auto it = by_hash.find(key);
+                if (it == by_hash.end()) continue;
+
+                // 优先选择同名条目（纯移动），否则取第一个可用条目；
+                // 子树中已有条目被配对的目录不再整体配对
+                size_t match = es.size();
+                auto named = by_name.find(key + name_of(added.path));
+                if (named != by_name.end()) match = next_intact(named->second);
+                if (match == es.size()) match = next_intact(it->second);
+                if (match == es.size()) continue;
+
+                // 删除一侧整棵子树不再输出，新增一侧仅保留当前条目
+                const DiffEntry& old = es[match];
+                consume_subtree(match);
+                consume_subtree(k);
+                consumed[k] = false;
+
+                added.type = parent_of(old.path) == parent_of(added.path)?
+                                            ChangeType::Renamed: ChangeType::Moved;
+                added.old_path = old.path;
+                added.old_size = old.old_size;
+                added.old_mtime = old.old_mtime;
+                added.old_hash = old.old_hash;
+            }
+        }
+
+        for (size_t k = 0; k < es.size(); ++k) {
+            if (!consumed[k]) next_.on_entry(es[k]);
+        }
+        entries_.clear();
+        next_.finish();
+    }
+
+    void diff(const Node& old_root, const Node& new_root, bool renames) {
+        DiffPrinter printer(std::cout);
+        if (renames) {
+            RenameDetector detector(printer);
+            diff_nodes(old_root, new_root, detector);
+            detector.finish();
         }
-        std::cout << "Changes between snapshots: " << std::endl;
-        std::cout << std::right << std::setw(4) << "type"
-                  << std::right << std::setw(22) << "time"
-                  << std::right << std::setw(20) << "size[B]"
-                  << std::left << std::setw(23) << ""
-                  << "path" << std::endl;
-        for (const auto& e: out) {
-            print_colored_DiffEntry(e);
+        else {
+            diff_nodes(old_root, new_root, printer);
+            printer.finish();
         }
     }
 
+    bool same_snapshot(const fs::path& old_snap, const fs::path& new_snap) {
+        // 根节点哈希覆盖整棵目录树的路径与内容，相同即无任何变化
+        return read_snapshot_header(old_snap).root_hash
+                    == read_snapshot_header(new_snap).root_hash;
+    }
+
     fs::path latest_snap(const fs::path& target_dir){
         // 确保target_dir为绝对路径
         fs::path target_abs = fs::absolute(target_dir);
@@ -175,31 +583,10 @@ namespace dirhist {
             return {};
         }
 
-        fs::path out;
-        int64_t max_ts = INT64_MIN;
-        for (const auto& e: fs::directory_iterator(target_dir)){
-            if(!e.is_regular_file()) continue;
-            if(!util::is_snap_bin_file(e.path())) continue;
-
-            std::ifstream ifs(e.path());
-            if (!ifs) {
-                throw std::runtime_error("Error opening snapshot file: "
-                                            + e.path().string());
-            }
-            // 读取文件头
-            Header hdr;
-            read(ifs, hdr);
-
-            // 检查文件头
-            if (hdr.magic != MAGIC || hdr.version != 1) continue;
-            if (hdr.timestamp > max_ts) {
-                out = e.path();
-                max_ts = hdr.timestamp;
-            }
-        }
-
+        // 从快照目录中读取最新条目
+        std::optional<CatalogEntry> entry = latest_entry(target_dir);
         // 当没有快照文件时
-        if (max_ts == INT64_MIN) return {};
-        return out;
+        if (!entry.has_value()) return {};
+        return snapshot_path(target_dir, entry.value());
     }
 }
\ No newline at end of file
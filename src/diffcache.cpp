@@ -0,0 +1,140 @@
+/*
+ * @file    src/diffcache.cpp
+ * @brief   This source file implements the persistent diff cache keyed by root hashes.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include "dirhist/diffcache.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    // 临时文件超过该时长仍未改名，视为写入进程异常退出的残留
+    constexpr auto ORPHAN_TMP_AGE = std::chrono::hours(1);
+
+    DiffCacheKey diff_cache_key(const Header& old_hdr, const Header& new_hdr) {
+        return DiffCacheKey{old_hdr.root_hash, old_hdr.timestamp
+                            , new_hdr.root_hash, new_hdr.timestamp};
+    }
+
+    fs::path diff_cache_path(const fs::path& store_dir, const DiffCacheKey& key) {
+        return store_dir / "diffcache" / (util::hash_to_hex(key.old_hash) + "-"
+                                        + std::to_string(key.old_ts) + "-"
+                                        + util::hash_to_hex(key.new_hash) + "-"
+                                        + std::to_string(key.new_ts) + ".bin");
+    }
+
+    bool load_cached_diff(const fs::path& store_dir, const DiffCacheKey& key
+                                                            , DiffSink& sink) {
+        fs::path path = diff_cache_path(store_dir, key);
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) return false;
+
+        // 先完整解析到内存，缓存损坏时不向 sink 输出任何内容
+        std::vector<DiffEntry> entries;
+        DiffCollector collector(entries);
+        try {
+            read_binary_diff(ifs, collector);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Discard corrupted diff cache: " << path.string() << std::endl;
+            ifs.close();
+            std::error_code ec;
+            fs::remove(path, ec);
+            return false;
+        }
+
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+        for (const auto& de: entries) sink.on_entry(de);
+        return true;
+    }
+
+    DiffCacheWriter::DiffCacheWriter(DiffSink& next, const fs::path& store_dir
+                    , const DiffCacheKey& key, uint64_t max_bytes)
+        : next_(next), store_dir_(store_dir), key_(key)
+        , max_bytes_(max_bytes), recorder_(data_) {}
+
+    void DiffCacheWriter::on_entry(const DiffEntry& entry) {
+        next_.on_entry(entry);
+        if (overflow_) return;
+        recorder_.on_entry(entry);
+        // 已写出的部分超过上限时停止记录并释放内存
+        if (static_cast<uint64_t>(data_.tellp()) > max_bytes_) {
+            overflow_ = true;
+            data_.str(std::string());
+        }
+    }
+
+    void DiffCacheWriter::commit() {
+        recorder_.finish();
+        std::string data = data_.str();
+        if (overflow_ || data.size() > max_bytes_) return;
+
+        // 先写临时文件再改名，并发读取时不会看到写了一半的缓存；
+        // 临时文件名各不相同且以 .bin 结尾，异常退出后的残留会被淘汰
+        fs::path path = diff_cache_path(store_dir_, key_);
+        fs::path tmp = path;
+        tmp.replace_extension();
+        tmp += util::tmp_suffix() + ".bin";
+        // 快照目录不存在时不创建，避免在任意位置留下缓存目录
+        std::error_code ec;
+        if (!fs::is_directory(store_dir_, ec)) return;
+        fs::create_directories(path.parent_path(), ec);
+        {
+            std::ofstream ofs(tmp, std::ios::binary);
+            if (!ofs) return;
+            ofs.write(data.data(), data.size());
+            if (!ofs) {
+                ofs.close();
+                fs::remove(tmp, ec);
+                return;
+            }
+        }
+        fs::rename(tmp, path, ec);
+        if (ec) {
+            fs::remove(tmp, ec);
+            return;
+        }
+        evict_diff_cache(store_dir_, max_bytes_);
+    }
+
+    uint64_t evict_diff_cache(const fs::path& store_dir, uint64_t max_bytes) {
+        struct CacheFile {
+            fs::path path;
+            uint64_t size;
+            fs::file_time_type used;
+        };
+        std::vector<CacheFile> files;
+        uint64_t total = 0;
+        std::error_code ec;
+        auto orphan_before = fs::file_time_type::clock::now() - ORPHAN_TMP_AGE;
+        for (const auto& entry: fs::directory_iterator(store_dir / "diffcache", ec)) {
+            std::string name = entry.path().filename().string();
+            if (!entry.is_regular_file(ec) || !util::ends_with_suffix(name, ".bin")) continue;
+            CacheFile f{entry.path(), entry.file_size(ec), entry.last_write_time(ec)};
+            if (name.find(".tmp-") != std::string::npos && f.used < orphan_before) {
+                fs::remove(f.path, ec);
+                continue;
+            }
+            total += f.size;
+            files.push_back(std::move(f));
+        }
+        if (total <= max_bytes) return 0;
+
+        std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b)
+                                                        {return a.used < b.used;});
+        uint64_t removed = 0;
+        for (const auto& f: files) {
+            if (total <= max_bytes) break;
+            if (fs::remove(f.path, ec)) {
+                total -= f.size;
+                ++removed;
+            }
+        }
+        return removed;
+    }
+}
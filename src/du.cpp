@@ -0,0 +1,188 @@
+/*
+ * @file    src/du.cpp
+ * @brief   This source file implements the functions for 'du' command.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include "dirhist/du.h"
+
+namespace dirhist {
+    // @brief 辅助类，保留排序键最大的 n 个条目
+    // @note 以最小堆保存，堆顶为当前排名中的最小值，新条目只需与堆顶比较
+    class TopN {
+    public:
+        explicit TopN(size_t n): n_(n) {}
+
+        // @brief 排名是否已满
+        bool full() const { return heap_.size() >= n_; }
+
+        // @brief 排名已满时进入排名所需超过的键值
+        int64_t threshold() const { return heap_.front().first; }
+
+        // @brief 尝试加入排名
+        void offer(int64_t key, const DuEntry& entry) {
+            if (n_ == 0) return;
+            if (full()) {
+                if (key <= threshold()) return;
+                std::pop_heap(heap_.begin(), heap_.end(), greater);
+                heap_.pop_back();
+            }
+            heap_.emplace_back(key, entry);
+            std::push_heap(heap_.begin(), heap_.end(), greater);
+        }
+
+        // @brief 返回按键值降序排列的条目
+        std::vector<DuEntry> sorted() const {
+            auto items = heap_;
+            std::sort(items.begin(), items.end(), [](const Item& a, const Item& b)
+                    {return a.first != b.first? a.first > b.first
+                                              : a.second.path < b.second.path;});
+            std::vector<DuEntry> res;
+            res.reserve(items.size());
+            for (auto& item: items) res.push_back(std::move(item.second));
+            return res;
+        }
+
+    private:
+        using Item = std::pair<int64_t, DuEntry>;
+        static bool greater(const Item& a, const Item& b) { return a.first > b.first; }
+
+        size_t n_;
+        std::vector<Item> heap_;
+    };
+
+    // @brief 辅助函数，判断节点是否为可展开的目录
+    static bool real_dir(const Node& node) {
+        return node.is_dir && !node.is_symlink;
+    }
+
+    // @brief 辅助函数，两个排名均已满时，大小不超过 bound 的子树不可能进入排名
+    static bool cannot_enter(const TopN& dirs, const TopN& files, int64_t bound) {
+        return dirs.full() && files.full()
+                && bound <= std::min(dirs.threshold(), files.threshold());
+    }
+
+    DuReport largest_entries(const SnapReader& reader, size_t top, int depth) {
+        DuReport report;
+        report.total = reader.root().info.size;
+        TopN dirs(top), files(top);
+
+        // 待展开的目录，按大小组织为最大堆
+        struct Pending {
+            NodeRef ref;
+            int level;
+        };
+        auto smaller = [](const Pending& a, const Pending& b)
+                            {return a.ref.info.size < b.ref.info.size;};
+        std::vector<Pending> frontier;
+        if (real_dir(reader.root().info)) frontier.push_back(Pending{*reader.lookup("."), 0});
+
+        while (!frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), smaller);
+            Pending cur = std::move(frontier.back());
+            frontier.pop_back();
+            // 其余待展开目录均不大于当前目录，子孙节点更不可能进入排名
+            if (cannot_enter(dirs, files, static_cast<int64_t>(cur.ref.info.size))) break;
+
+            for (auto& child: reader.children(cur.ref)) {
+                const Node& info = child.info;
+                DuEntry entry{info.path, info.size, 0};
+                int64_t key = static_cast<int64_t>(info.size);
+                if (!real_dir(info)) {
+                    files.offer(key, entry);
+                    continue;
+                }
+                dirs.offer(key, entry);
+                if (depth >= 0 && cur.level + 1 >= depth) continue;
+                if (cannot_enter(dirs, files, key)) continue;
+                frontier.push_back(Pending{std::move(child), cur.level + 1});
+                std::push_heap(frontier.begin(), frontier.end(), smaller);
+            }
+        }
+
+        report.dirs = dirs.sorted();
+        report.files = files.sorted();
+        return report;
+    }
+
+    // @brief 辅助函数，比较两侧目录的子节点并累计增长排名
+    // @param old_ref 旧快照中的节点，不存在时为空
+    // @param new_ref 新快照中的目录节点
+    static void aux_growth(const NodeRef* old_ref, const NodeRef& new_ref, int level
+                            , int depth, TopN& dirs, TopN& files) {
+        std::vector<NodeRef> old_children;
+        if (old_ref && real_dir(old_ref->info)) {
+            old_children = old_ref->reader->children(*old_ref);
+        }
+        std::vector<NodeRef> new_children = new_ref.reader->children(new_ref);
+
+        // 子节点均按路径字典序排列，归并查找同名节点
+        size_t i = 0;
+        for (const auto& child: new_children) {
+            while (i < old_children.size() && old_children[i].info.path < child.info.path) ++i;
+            const NodeRef* old_child = (i < old_children.size()
+                        && old_children[i].info.path == child.info.path)? &old_children[i]: nullptr;
+
+            const Node& info = child.info;
+            int64_t growth = static_cast<int64_t>(info.size)
+                    - (old_child? static_cast<int64_t>(old_child->info.size): 0);
+            DuEntry entry{info.path, info.size, growth};
+            if (growth > 0) (real_dir(info)? dirs: files).offer(growth, entry);
+
+            if (!real_dir(info)) continue;
+            if (old_child && old_child->info.hash == info.hash) continue;
+            if (depth >= 0 && level + 1 >= depth) continue;
+            // 新增子树中任意节点的增长量不超过其大小
+            if (!old_child && cannot_enter(dirs, files, static_cast<int64_t>(info.size))) continue;
+            aux_growth(old_child, child, level + 1, depth, dirs, files);
+        }
+    }
+
+    DuReport largest_growth(const SnapReader& old_reader, const SnapReader& new_reader
+                            , size_t top, int depth) {
+        DuReport report;
+        const NodeRef& old_root = old_reader.root();
+        const NodeRef& new_root = new_reader.root();
+        report.total = new_root.info.size;
+        report.growth = static_cast<int64_t>(new_root.info.size)
+                      - static_cast<int64_t>(old_root.info.size);
+        if (old_root.info.hash == new_root.info.hash || !real_dir(new_root.info)) return report;
+
+        TopN dirs(top), files(top);
+        aux_growth(&old_root, new_root, 0, depth, dirs, files);
+        report.dirs = dirs.sorted();
+        report.files = files.sorted();
+        return report;
+    }
+
+    // @brief 辅助函数，打印一个排名表
+    static void aux_print_rank(const std::vector<DuEntry>& entries, bool growth
+                                , std::ostream& os) {
+        if (entries.empty()) {
+            os << "  (none)" << std::endl;
+            return;
+        }
+        if (growth) os << "  Growth          Size            Path" << std::endl;
+        else os << "  Size            Path" << std::endl;
+        for (const auto& e: entries) {
+            os << "  ";
+            if (growth) {
+                os << std::left << std::setw(14) << ("+" + std::to_string(e.growth)) << "  ";
+            }
+            os << std::left << std::setw(14) << e.size << "  " << e.path << std::endl;
+        }
+    }
+
+    void print_du(const DuReport& report, bool growth, std::ostream& os) {
+        os << "Total: " << report.total;
+        if (growth) os << " (" << (report.growth >= 0? "+": "") << report.growth << ")";
+        os << std::endl;
+        os << (growth? "Fastest growing directories:": "Largest directories:") << std::endl;
+        aux_print_rank(report.dirs, growth, os);
+        os << (growth? "Fastest growing files:": "Largest files:") << std::endl;
+        aux_print_rank(report.files, growth, os);
+    }
+}
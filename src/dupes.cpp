@@ -0,0 +1,120 @@
+/*
+ * @file    src/dupes.cpp
+ * @brief   This source file implements the functions for 'dupes' command.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <unordered_map>
+#include "dirhist/dupes.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    // @brief 分组键：文件大小与内容哈希值
+    struct DupeKey {
+        uint64_t size;
+        std::array<uint8_t, 32> content_hash;
+
+        bool operator==(const DupeKey& other) const {
+            return size == other.size && content_hash == other.content_hash;
+        }
+    };
+
+    struct DupeKeyHash {
+        size_t operator()(const DupeKey& key) const {
+            // 内容哈希本身均匀分布，取前 8 字节即可
+            uint64_t h = 0;
+            std::memcpy(&h, key.content_hash.data(), sizeof(h));
+            return static_cast<size_t>(h ^ key.size);
+        }
+    };
+
+    // @brief 分组状态：首次出现时只记录路径，出现第二份时才创建重复组
+    struct DupeSlot {
+        std::string first;          // 首个文件路径
+        size_t group = SIZE_MAX;    // 重复组下标，尚未重复时为 SIZE_MAX
+    };
+
+    // @brief 辅助函数，判断子树中是否可能有参与比较的文件
+    static bool may_have_files(const Node& node, uint64_t min_size) {
+        return node.file_cnt != 0 && node.max_file_size > min_size;
+    }
+
+    // @brief 辅助函数，递归遍历目录并分组
+    static void aux_dupes(const SnapReader& reader, const NodeRef& dir, uint64_t min_size
+                        , std::unordered_map<DupeKey, DupeSlot, DupeKeyHash>& slots
+                        , DupeReport& report) {
+        for (const auto& child: reader.children(dir)) {
+            const Node& info = child.info;
+            if (info.is_symlink) continue;
+            if (info.is_dir) {
+                if (may_have_files(info, min_size)) {
+                    aux_dupes(reader, child, min_size, slots, report);
+                }
+                continue;
+            }
+            if (info.size <= min_size) continue;
+
+            ++report.files;
+            report.bytes += info.size;
+            DupeSlot& slot = slots[DupeKey{info.size, info.content_hash}];
+            if (slot.group == SIZE_MAX && slot.first.empty()) {
+                slot.first = info.path;
+                continue;
+            }
+            if (slot.group == SIZE_MAX) {
+                slot.group = report.groups.size();
+                DupeGroup group;
+                group.size = info.size;
+                group.content_hash = info.content_hash;
+                group.paths.push_back(std::move(slot.first));
+                report.groups.push_back(std::move(group));
+            }
+            report.groups[slot.group].paths.push_back(info.path);
+            ++report.duplicates;
+            report.reclaimable += info.size;
+        }
+    }
+
+    DupeReport find_dupes(const SnapReader& reader, uint64_t min_size) {
+        if (!has_content_hash(reader.header().version)) {
+            throw std::runtime_error("Snapshot has no content hashes, take a new snapshot: "
+                                                            + reader.path().string());
+        }
+        DupeReport report;
+        std::unordered_map<DupeKey, DupeSlot, DupeKeyHash> slots;
+        const NodeRef& root = reader.root();
+        if (may_have_files(root.info, min_size)) aux_dupes(reader, root, min_size, slots, report);
+
+        std::sort(report.groups.begin(), report.groups.end()
+                    , [](const DupeGroup& a, const DupeGroup& b) {
+                        if (a.reclaimable() != b.reclaimable()) {
+                            return a.reclaimable() > b.reclaimable();
+                        }
+                        return a.paths.front() < b.paths.front();
+                    });
+        return report;
+    }
+
+    void print_dupes(const DupeReport& report, size_t top, std::ostream& os) {
+        os << "Files: " << report.files << " (" << report.bytes << " bytes)" << std::endl;
+        os << "Duplicate groups: " << report.groups.size()
+           << ", redundant copies: " << report.duplicates
+           << ", reclaimable: " << report.reclaimable << " bytes" << std::endl;
+        size_t shown = std::min(top, report.groups.size());
+        for (size_t i = 0; i < shown; ++i) {
+            const DupeGroup& g = report.groups[i];
+            os << std::endl << util::hash_to_hex(g.content_hash).substr(0, 12)
+               << "  " << g.paths.size() << " x " << g.size
+               << " bytes, reclaimable " << g.reclaimable() << std::endl;
+            for (const auto& p: g.paths) os << "  " << p << std::endl;
+        }
+        if (shown < report.groups.size()) {
+            os << std::endl << "... " << report.groups.size() - shown
+               << " more groups" << std::endl;
+        }
+    }
+}
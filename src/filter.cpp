@@ -0,0 +1,139 @@
+/*
+ * @file    src/filter.cpp
+ * @brief   This source file implements the compiled path filter for tree display.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include "dirhist/filter.h"
+#include "dirhist/snapshot.h"
+
+namespace dirhist {
+    PathFilter::PathFilter(bool all, const std::vector<std::string>& excludes
+                            , const std::string& abs_root): all_(all) {
+        for (const auto& raw: excludes) {
+            std::string rule = raw;
+            fs::path p(raw);
+            if (p.is_absolute()) {
+                if (abs_root.empty()) continue;
+                fs::path rel = p.lexically_normal().lexically_relative(
+                                        fs::path(abs_root).lexically_normal());
+                std::string rel_str = rel.generic_string();
+                if (rel.empty() || rel_str == ".." || rel_str.rfind("../", 0) == 0) continue;
+                rule = rel_str;
+            }
+
+            // 统一为 path_prefixes 的形式，去除 "./"、重复的 '/' 与末尾 '/'
+            std::vector<std::string> prefixes = path_prefixes(rule);
+            std::string norm = prefixes.empty()? ".": prefixes.back();
+            if (!GlobPattern::is_glob(norm)) paths_.insert(norm);
+            else globs_.emplace_back(norm);
+        }
+    }
+
+    bool PathFilter::visible(const std::string& path) const {
+        if (paths_.count(path)) return false;
+        if (path == ".") return true;
+
+        size_t slash = path.rfind('/');
+        std::string name = slash == std::string::npos? path: path.substr(slash + 1);
+        // 任意层级的隐藏文件（夹）
+        if (!all_ && !name.empty() && name[0] == '.') return false;
+
+        for (const auto& glob: globs_) {
+            if (glob.match(glob.full_path()? path: name)) return false;
+        }
+        return true;
+    }
+
+    bool GlobPattern::is_glob(const std::string& str) {
+        return str.find_first_of("*?[") != std::string::npos;
+    }
+
+    GlobPattern::GlobPattern(const std::string& pattern) {
+        full_path_ = pattern.find('/') != std::string::npos;
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            Token tok;
+            char c = pattern[i];
+            if (c == '*') {
+                bool twice = i + 1 < pattern.size() && pattern[i + 1] == '*';
+                tok.kind = twice? Token::DoubleStar: Token::Star;
+                // 连续的 '*' 合并为一个状态
+                while (i + 1 < pattern.size() && pattern[i + 1] == '*') ++i;
+            }
+            else if (c == '?') tok.kind = Token::Any;
+            else if (c == '[' && pattern.find(']', i + 2) != std::string::npos) {
+                // 字符类：[abc]、[a-z]、[!abc]，首个 ']' 视为普通字符
+                size_t j = i + 1;
+                bool negate = pattern[j] == '!' || pattern[j] == '^';
+                if (negate) ++j;
+                size_t end = pattern.find(']', j + 1);
+                if (end == std::string::npos) {
+                    tok.ch = c;
+                    tokens_.push_back(tok);
+                    continue;
+                }
+                tok.kind = Token::Class;
+                for (size_t k = j; k < end; ++k) {
+                    unsigned char lo = pattern[k];
+                    if (k + 2 < end && pattern[k + 1] == '-') {
+                        unsigned char hi = pattern[k + 2];
+                        for (unsigned v = lo; v <= hi; ++v) tok.set.set(v);
+                        k += 2;
+                    }
+                    else tok.set.set(lo);
+                }
+                if (negate) tok.set.flip();
+                tok.set.reset('/');
+                i = end;
+            }
+            else tok.ch = c;
+            tokens_.push_back(tok);
+        }
+    }
+
+    bool GlobPattern::match(const std::string& str) const {
+        const auto& toks = tokens_;
+        size_t n = toks.size();
+        // active[i] 表示已匹配前 i 个状态转移条件
+        std::vector<char> active(n + 1, 0), next(n + 1, 0);
+        // '*' 可以匹配空串，沿其向后闭包
+        auto closure = [&](std::vector<char>& states) {
+            for (size_t i = 0; i < n; ++i) {
+                if (states[i] && (toks[i].kind == Token::Star
+                                || toks[i].kind == Token::DoubleStar)) states[i + 1] = 1;
+            }
+        };
+        active[0] = 1;
+        closure(active);
+        for (char c: str) {
+            std::fill(next.begin(), next.end(), 0);
+            bool any = false;
+            for (size_t i = 0; i < n; ++i) {
+                if (!active[i]) continue;
+                const Token& tok = toks[i];
+                switch (tok.kind) {
+                case Token::Char:
+                    if (tok.ch == c) next[i + 1] = any = 1;
+                    break;
+                case Token::Any:
+                    if (c != '/') next[i + 1] = any = 1;
+                    break;
+                case Token::Class:
+                    if (tok.set.test(static_cast<unsigned char>(c))) next[i + 1] = any = 1;
+                    break;
+                case Token::Star:
+                    if (c != '/') next[i] = any = 1;
+                    break;
+                case Token::DoubleStar:
+                    next[i] = any = 1;
+                    break;
+                }
+            }
+            if (!any) return false;
+            closure(next);
+            active.swap(next);
+        }
+        return active[n];
+    }
+}
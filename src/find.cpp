@@ -0,0 +1,97 @@
+/*
+ * @file    src/find.cpp
+ * @brief   This source file implements the functions for 'find' command.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include "dirhist/find.h"
+#include "dirhist/filter.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    // 输出缓冲区达到该大小时整块写出
+    constexpr size_t FIND_FLUSH_BLOCK = 1 << 20;
+
+    // @brief 辅助函数，根据子树聚合信息判断子树中是否可能存在匹配节点
+    static bool may_match(const Node& node, const FindQuery& query) {
+        if (query.newer && node.max_mtime <= *query.newer) return false;
+        if (query.larger && (node.file_cnt == 0 || node.max_file_size <= *query.larger)) {
+            return false;
+        }
+        return true;
+    }
+
+    // @brief 辅助函数，判断节点自身是否匹配
+    static bool matches(const Node& node, const FindQuery& query
+                        , const std::optional<GlobPattern>& glob) {
+        bool dir = node.is_dir && !node.is_symlink;
+        if (query.newer && node.mtime <= *query.newer) return false;
+        if (query.larger && (dir || node.size <= *query.larger)) return false;
+        if (glob) {
+            size_t slash = node.path.rfind('/');
+            std::string name = slash == std::string::npos? node.path: node.path.substr(slash + 1);
+            if (!glob->match(glob->full_path()? node.path: name)) return false;
+        }
+        return true;
+    }
+
+    // @brief 辅助函数，递归查找目录的子节点
+    static void aux_find(const SnapReader& reader, const NodeRef& dir, const FindQuery& query
+                        , const std::optional<GlobPattern>& glob
+                        , const std::function<void(const Node&)>& on_match, FindStats& stats) {
+        for (const auto& child: reader.children(dir)) {
+            ++stats.visited;
+            const Node& info = child.info;
+            if (!may_match(info, query)) {
+                ++stats.pruned;
+                continue;
+            }
+            if (matches(info, query, glob)) {
+                ++stats.matched;
+                on_match(info);
+            }
+            if (info.is_dir && !info.is_symlink) {
+                aux_find(reader, child, query, glob, on_match, stats);
+            }
+        }
+    }
+
+    FindStats find_nodes(const SnapReader& reader, const FindQuery& query
+                        , const std::function<void(const Node&)>& on_match) {
+        FindStats stats;
+        std::optional<GlobPattern> glob;
+        if (query.name) glob.emplace(*query.name);
+
+        const NodeRef& root = reader.root();
+        if (!may_match(root.info, query)) {
+            ++stats.pruned;
+            return stats;
+        }
+        aux_find(reader, root, query, glob, on_match, stats);
+        return stats;
+    }
+
+    FindStats print_find(const fs::path& snapshot, const FindQuery& query, std::ostream& os) {
+        SnapReader reader(snapshot);
+        std::string buf = "Type     Size         Mtime                Path\n";
+        FindStats stats = find_nodes(reader, query, [&](const Node& info){
+            std::string type = info.is_symlink? "symlink": info.is_dir? "dir": "file";
+            std::string size = std::to_string(info.size);
+            buf += type;
+            buf.append(type.size() < 9? 9 - type.size(): 1, ' ');
+            buf += size;
+            buf.append(size.size() < 13? 13 - size.size(): 1, ' ');
+            buf += util::ts_str(info.mtime);
+            buf += "  ";
+            buf += info.path;
+            buf += '\n';
+            if (buf.size() >= FIND_FLUSH_BLOCK) {
+                os << buf;
+                buf.clear();
+            }
+        });
+        os << buf << std::flush;
+        return stats;
+    }
+}
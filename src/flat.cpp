@@ -0,0 +1,246 @@
+/*
+ * @file    src/flat.cpp
+ * @brief   This source file implements the columnar, pre-order tree representation.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <cstring>
+#include "dirhist/flat.h"
+#include "dirhist/filter.h"
+#include "internal/tree_printer.h"
+
+namespace dirhist {
+    // @brief 辅助函数，先序追加节点及其子树
+    static void aux_flatten(const Node& node, FlatTree& tree) {
+        size_t idx = tree.size();
+        tree.sizes.push_back(node.size);
+        tree.mtimes.push_back(node.mtime);
+        tree.flags.push_back((node.is_dir? FLAT_DIR: 0) | (node.is_symlink? FLAT_SYMLINK: 0));
+        tree.ends.push_back(0);
+        tree.hashes.push_back(node.hash);
+        tree.content_hashes.push_back(node.content_hash);
+        tree.path_data += node.path;
+        tree.path_offsets.push_back(tree.path_data.size());
+        for (const auto& child: node.children) aux_flatten(*child, tree);
+        tree.ends[idx] = static_cast<uint32_t>(tree.size());
+    }
+
+    FlatTree flatten(const Node& root) {
+        FlatTree tree;
+        tree.abs_root = root.abs_root;
+        tree.path_offsets.push_back(0);
+        aux_flatten(root, tree);
+        return tree;
+    }
+
+    std::unique_ptr<Node> unflatten(const FlatTree& tree, size_t i) {
+        auto node = std::make_unique<Node>();
+        node->path = std::string(tree.path(i));
+        node->abs_root = tree.abs_root;
+        node->is_dir = tree.flags[i] & FLAT_DIR;
+        node->is_symlink = tree.flags[i] & FLAT_SYMLINK;
+        node->size = tree.sizes[i];
+        node->mtime = tree.mtimes[i];
+        node->hash = tree.hashes[i];
+        node->content_hash = tree.content_hashes[i];
+        for (size_t c = i + 1; c < tree.ends[i]; c = tree.ends[c]) {
+            node->children.push_back(unflatten(tree, c));
+        }
+        return node;
+    }
+
+    void mark_subtree(const FlatTree& tree, size_t i, ChangeType type, DiffSink& sink) {
+        DiffEntry de;
+        de.type = type;
+        for (size_t k = i; k < tree.ends[i]; ++k) {
+            de.path.assign(tree.path(k));
+            de.is_dir = tree.is_real_dir(k);
+            de.content_hash = tree.content_hashes[k];
+            if (type == ChangeType::Added) {
+                de.new_size = tree.sizes[k];
+                de.new_mtime = tree.mtimes[k];
+                de.new_hash = tree.hashes[k];
+            }
+            else {
+                de.old_size = tree.sizes[k];
+                de.old_mtime = tree.mtimes[k];
+                de.old_hash = tree.hashes[k];
+            }
+            sink.on_entry(de);
+        }
+    }
+
+    // @brief 辅助函数，比较两棵扁平目录树中的一对节点，分支与 diff_nodes 一一对应
+    static void aux_diff(const FlatTree& a, size_t i, const FlatTree& b, size_t j
+                        , DiffSink& sink) {
+        if (a.hashes[i] == b.hashes[j]) return;
+        bool old_dir = a.is_real_dir(i);
+        bool new_dir = b.is_real_dir(j);
+        if (!old_dir && new_dir) {
+            DiffEntry de;
+            de.type = ChangeType::Deleted;
+            de.path.assign(a.path(i));
+            de.old_size = a.sizes[i];
+            de.old_mtime = a.mtimes[i];
+            de.old_hash = a.hashes[i];
+            de.content_hash = a.content_hashes[i];
+            sink.on_entry(de);
+            mark_subtree(b, j, ChangeType::Added, sink);
+        }
+        else if (old_dir && !new_dir) {
+            mark_subtree(a, i, ChangeType::Deleted, sink);
+            DiffEntry de;
+            de.type = ChangeType::Added;
+            de.path.assign(b.path(j));
+            de.new_size = b.sizes[j];
+            de.new_mtime = b.mtimes[j];
+            de.new_hash = b.hashes[j];
+            de.content_hash = b.content_hashes[j];
+            sink.on_entry(de);
+        }
+        else if (!old_dir && !new_dir) {
+            DiffEntry de;
+            de.type = ChangeType::Modified;
+            de.path.assign(b.path(j));
+            de.old_size = a.sizes[i];
+            de.new_size = b.sizes[j];
+            de.old_mtime = a.mtimes[i];
+            de.new_mtime = b.mtimes[j];
+            de.old_hash = a.hashes[i];
+            de.new_hash = b.hashes[j];
+            de.content_hash = b.content_hashes[j];
+            sink.on_entry(de);
+        }
+        else {
+            // 子节点按路径字典序排列，归并比较；相同的子树直接跳到下一个兄弟节点
+            size_t ci = i + 1, cj = j + 1;
+            while (ci < a.ends[i] || cj < b.ends[j]) {
+                if (ci < a.ends[i] && (cj == b.ends[j] || a.path(ci) < b.path(cj))) {
+                    mark_subtree(a, ci, ChangeType::Deleted, sink);
+                    ci = a.ends[ci];
+                }
+                else if (cj < b.ends[j] && (ci == a.ends[i] || b.path(cj) < a.path(ci))) {
+                    mark_subtree(b, cj, ChangeType::Added, sink);
+                    cj = b.ends[cj];
+                }
+                else {
+                    aux_diff(a, ci, b, cj, sink);
+                    ci = a.ends[ci];
+                    cj = b.ends[cj];
+                }
+            }
+        }
+    }
+
+    void diff_nodes(const FlatTree& old_tree, const FlatTree& new_tree, DiffSink& sink) {
+        if (old_tree.size() == 0 || new_tree.size() == 0) return;
+        aux_diff(old_tree, 0, new_tree, 0, sink);
+    }
+
+    // @brief 辅助函数，判断子节点是否会被打印
+    static bool aux_shown(const FlatTree& tree, size_t i, int level, int max_depth
+                        , const PathFilter& filter) {
+        return (max_depth == -1 || level <= max_depth)
+                    && filter.visible(std::string(tree.path(i)));
+    }
+
+    // @brief 辅助函数，递归打印扁平目录树，与 snapshot.cpp 中 aux_display_tree 一致
+    static void aux_display_flat(const FlatTree& tree, size_t i, int level, bool is_last
+                        , int max_depth, const PathFilter& filter, TreePrinter& out) {
+        // 最后一个可见子节点，决定连接符
+        size_t last = tree.ends[i];
+        if (tree.is_real_dir(i)) {
+            for (size_t c = i + 1; c < tree.ends[i]; c = tree.ends[c]) {
+                if (aux_shown(tree, c, level + 1, max_depth, filter)) last = c;
+            }
+        }
+        if (level == 0) is_last = last == tree.ends[i];
+
+        out.line(tree.path(i), tree.flags[i] & FLAT_DIR, tree.flags[i] & FLAT_SYMLINK, is_last);
+        if (last == tree.ends[i]) return;
+
+        size_t len = out.push(is_last);
+        for (size_t c = i + 1; c <= last; c = tree.ends[c]) {
+            if (!aux_shown(tree, c, level + 1, max_depth, filter)) continue;
+            aux_display_flat(tree, c, level + 1, c == last, max_depth, filter, out);
+        }
+        out.pop(len);
+    }
+
+    void display_tree(const FlatTree& tree, int max_depth
+        , bool all, const std::vector<std::string>& no_list) {
+        if (tree.size() == 0) {
+            std::cerr << "Tree root is nullptr" << std::endl;
+            return;
+        }
+        TreePrinter out;
+        out.text("[" + tree.abs_root + "]");
+        PathFilter filter(all, no_list, tree.abs_root);
+        if (filter.visible(std::string(tree.path(0))))
+            aux_display_flat(tree, 0, 0, true, max_depth, filter, out);
+        out.text("done.");
+    }
+
+#if defined(__GNUC__)
+    // 4 路 64 位整数向量（GCC/Clang 向量扩展），由编译器映射为目标平台的 SIMD 指令：
+    // AVX2 下每次比较为一条指令，SSE/NEON 下拆分为两条
+    typedef int64_t vec_i64 __attribute__((vector_size(32)));
+    typedef uint64_t vec_u64 __attribute__((vector_size(32)));
+    constexpr size_t VEC_LANES = sizeof(vec_i64) / sizeof(int64_t);
+#endif
+
+    std::vector<uint32_t> select_nodes(const FlatTree& tree, const FindQuery& query) {
+        size_t n = tree.size();
+        // 对整列做无分支比较，未设置的条件恒为真
+        uint8_t any_mtime = !query.newer.has_value();
+        int64_t newer = any_mtime? 0: *query.newer;
+        uint8_t any_size = !query.larger.has_value();
+        uint64_t larger = any_size? 0: *query.larger;
+        std::vector<uint8_t> keep(n);
+        const int64_t* mtimes = tree.mtimes.data();
+        const uint64_t* sizes = tree.sizes.data();
+        const uint8_t* flags = tree.flags.data();
+        size_t i = 0;
+#if defined(__GNUC__)
+        // 每次处理 VEC_LANES 个节点，比较结果各通道为全1或全0
+        vec_i64 newer_v = vec_i64{} + newer;
+        vec_u64 larger_v = vec_u64{} + larger;
+        vec_i64 any_mtime_v = vec_i64{} - any_mtime;
+        vec_i64 any_size_v = vec_i64{} - any_size;
+        for (; i + VEC_LANES <= n; i += VEC_LANES) {
+            vec_i64 mt;
+            vec_u64 sz;
+            std::memcpy(&mt, mtimes + i, sizeof(mt));
+            std::memcpy(&sz, sizes + i, sizeof(sz));
+            vec_i64 fl = {flags[i], flags[i + 1], flags[i + 2], flags[i + 3]};
+            vec_i64 file = (fl & (FLAT_DIR | FLAT_SYMLINK)) != FLAT_DIR;
+            vec_i64 m = ((mt > newer_v) | any_mtime_v)
+                      & (((sz > larger_v) & file) | any_size_v);
+            for (size_t k = 0; k < VEC_LANES; ++k) keep[i + k] = m[k] & 1;
+        }
+#endif
+        // 剩余节点（或不支持向量扩展的编译器）逐个比较
+        for (; i < n; ++i) {
+            uint8_t file = (flags[i] & (FLAT_DIR | FLAT_SYMLINK)) != FLAT_DIR;
+            keep[i] = (any_mtime | (mtimes[i] > newer))
+                    & (any_size | (file & (sizes[i] > larger)));
+        }
+
+        std::optional<GlobPattern> glob;
+        if (query.name) glob.emplace(*query.name);
+        std::vector<uint32_t> res;
+        for (size_t i = 1; i < n; ++i) {
+            if (!keep[i]) continue;
+            if (glob) {
+                std::string_view path = tree.path(i);
+                size_t slash = path.rfind('/');
+                std::string_view name = slash == std::string_view::npos?
+                                                path: path.substr(slash + 1);
+                if (!glob->match(std::string(glob->full_path()? path: name))) continue;
+            }
+            res.push_back(static_cast<uint32_t>(i));
+        }
+        return res;
+    }
+}
@@ -0,0 +1,285 @@
+/*
+ * @file    src/format.cpp
+ * @brief   This source file implements the machine readable diff output formats.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include "dirhist/format.h"
+
+namespace dirhist {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    const char* change_type_name(ChangeType type) {
+        switch (type) {
+            case ChangeType::Added: return "added";
+            case ChangeType::Deleted: return "deleted";
+            case ChangeType::Modified: return "modified";
+            case ChangeType::Renamed: return "renamed";
+            case ChangeType::Moved: return "moved";
+        }
+        return "unknown";
+    }
+
+    // @brief 辅助函数，追加整数的十进制表示
+    template<typename T>
+    static void append_int(std::string& buf, T val) {
+        char tmp[24];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), val);
+        buf.append(tmp, res.ptr);
+    }
+
+    // @brief 辅助函数，追加哈希值的十六进制表示
+    static void append_hex(std::string& buf, const std::array<uint8_t, 32>& hash) {
+        size_t pos = buf.size();
+        buf.resize(pos + hash.size() * 2);
+        for (size_t i = 0; i < hash.size(); ++i) {
+            buf[pos + 2*i] = HEX_DIGITS[hash[i] >> 4];
+            buf[pos + 2*i + 1] = HEX_DIGITS[hash[i] & 0xF];
+        }
+    }
+
+    // @brief 辅助函数，判断该侧哈希值是否存在
+    static bool has_hash(const std::array<uint8_t, 32>& hash) {
+        return hash != std::array<uint8_t, 32>{0};
+    }
+
+    // @brief 辅助函数，追加 JSON 字符串（含引号）
+    static void append_json_str(std::string& buf, const std::string& str) {
+        buf += '"';
+        for (unsigned char c: str) {
+            switch (c) {
+                case '"': buf += "\\\""; break;
+                case '\\': buf += "\\\\"; break;
+                case '\n': buf += "\\n"; break;
+                case '\r': buf += "\\r"; break;
+                case '\t': buf += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        buf += "\\u00";
+                        buf += HEX_DIGITS[c >> 4];
+                        buf += HEX_DIGITS[c & 0xF];
+                    }
+                    else buf += static_cast<char>(c);
+            }
+        }
+        buf += '"';
+    }
+
+    // @brief 辅助函数，追加 JSON 哈希字段值，不存在时为 null
+    static void append_json_hash(std::string& buf, const std::array<uint8_t, 32>& hash) {
+        if (!has_hash(hash)) {
+            buf += "null";
+            return;
+        }
+        buf += '"';
+        append_hex(buf, hash);
+        buf += '"';
+    }
+
+    void NdjsonSink::on_entry(const DiffEntry& de) {
+        buf_ += "{\"type\":\"";
+        buf_ += change_type_name(de.type);
+        buf_ += "\",\"path\":";
+        append_json_str(buf_, de.path);
+        buf_ += de.is_dir? ",\"is_dir\":true": ",\"is_dir\":false";
+        buf_ += ",\"old_size\":";
+        append_int(buf_, de.old_size);
+        buf_ += ",\"new_size\":";
+        append_int(buf_, de.new_size);
+        buf_ += ",\"old_mtime\":";
+        append_int(buf_, de.old_mtime);
+        buf_ += ",\"new_mtime\":";
+        append_int(buf_, de.new_mtime);
+        buf_ += ",\"old_hash\":";
+        append_json_hash(buf_, de.old_hash);
+        buf_ += ",\"new_hash\":";
+        append_json_hash(buf_, de.new_hash);
+        buf_ += ",\"content_hash\":";
+        append_json_hash(buf_, de.content_hash);
+        if (de.type == ChangeType::Renamed || de.type == ChangeType::Moved) {
+            buf_ += ",\"old_path\":";
+            append_json_str(buf_, de.old_path);
+        }
+        buf_ += "}\n";
+        commit();
+    }
+
+    // @brief 辅助函数，追加转义后的 TSV 字段
+    static void append_tsv_str(std::string& buf, const std::string& str) {
+        for (char c: str) {
+            switch (c) {
+                case '\t': buf += "\\t"; break;
+                case '\n': buf += "\\n"; break;
+                case '\r': buf += "\\r"; break;
+                case '\\': buf += "\\\\"; break;
+                default: buf += c;
+            }
+        }
+    }
+
+    void TsvSink::header() {
+        buf_ += "type\tpath\told_path\tis_dir\told_size\tnew_size\told_mtime\tnew_mtime"
+                "\told_hash\tnew_hash\tcontent_hash\n";
+    }
+
+    void TsvSink::on_entry(const DiffEntry& de) {
+        if (count_ == 0) header();
+        buf_ += change_type_name(de.type);
+        buf_ += '\t';
+        append_tsv_str(buf_, de.path);
+        buf_ += '\t';
+        append_tsv_str(buf_, de.old_path);
+        buf_ += de.is_dir? "\t1\t": "\t0\t";
+        append_int(buf_, de.old_size);
+        buf_ += '\t';
+        append_int(buf_, de.new_size);
+        buf_ += '\t';
+        append_int(buf_, de.old_mtime);
+        buf_ += '\t';
+        append_int(buf_, de.new_mtime);
+        buf_ += '\t';
+        if (has_hash(de.old_hash)) append_hex(buf_, de.old_hash);
+        buf_ += '\t';
+        if (has_hash(de.new_hash)) append_hex(buf_, de.new_hash);
+        buf_ += '\t';
+        if (has_hash(de.content_hash)) append_hex(buf_, de.content_hash);
+        buf_ += '\n';
+        commit();
+    }
+
+    void TsvSink::finish() {
+        // 没有差异时也输出列名，便于下游统一处理
+        if (count_ == 0) header();
+        BufferedDiffSink::finish();
+    }
+
+    // @brief 辅助函数，按小端序追加整数
+    template<typename T>
+    static void append_le(std::string& buf, T val) {
+        using U = std::make_unsigned_t<T>;
+        U u = static_cast<U>(val);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            buf += static_cast<char>((u >> (8 * i)) & 0xFF);
+        }
+    }
+
+    void BinarySink::header() {
+        append_le(buf_, DIFF_MAGIC);
+    }
+
+    void BinarySink::on_entry(const DiffEntry& de) {
+        if (count_ == 0) header();
+
+        // 先预留长度字段，写完记录后回填
+        size_t len_pos = buf_.size();
+        append_le(buf_, uint32_t(0));
+        buf_ += static_cast<char>(de.type);
+        buf_ += static_cast<char>(de.is_dir);
+        append_le(buf_, de.old_size);
+        append_le(buf_, de.new_size);
+        append_le(buf_, de.old_mtime);
+        append_le(buf_, de.new_mtime);
+        buf_.append(reinterpret_cast<const char*>(de.old_hash.data()), de.old_hash.size());
+        buf_.append(reinterpret_cast<const char*>(de.new_hash.data()), de.new_hash.size());
+        buf_.append(reinterpret_cast<const char*>(de.content_hash.data())
+                                                        , de.content_hash.size());
+        append_le(buf_, static_cast<uint32_t>(de.path.size()));
+        buf_ += de.path;
+        append_le(buf_, static_cast<uint32_t>(de.old_path.size()));
+        buf_ += de.old_path;
+
+        uint32_t len = static_cast<uint32_t>(buf_.size() - len_pos - sizeof(uint32_t));
+        for (size_t i = 0; i < sizeof(len); ++i) {
+            buf_[len_pos + i] = static_cast<char>((len >> (8 * i)) & 0xFF);
+        }
+        commit();
+    }
+
+    void BinarySink::finish() {
+        if (count_ == 0) header();
+        BufferedDiffSink::finish();
+    }
+
+    // @brief 辅助函数，按小端序读取整数
+    template<typename T>
+    static T take_le(const char*& p) {
+        using U = std::make_unsigned_t<T>;
+        U u = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            u |= static_cast<U>(static_cast<uint8_t>(p[i])) << (8 * i);
+        }
+        p += sizeof(T);
+        return static_cast<T>(u);
+    }
+
+    // @brief 辅助函数，读取定长哈希值
+    static void take_hash(const char*& p, std::array<uint8_t, 32>& hash) {
+        std::memcpy(hash.data(), p, hash.size());
+        p += hash.size();
+    }
+
+    uint64_t read_binary_diff(std::istream& is, DiffSink& sink) {
+        char head[sizeof(DIFF_MAGIC)];
+        if (!is.read(head, sizeof(head))) {
+            throw std::runtime_error("Truncated binary diff");
+        }
+        const char* hp = head;
+        if (take_le<uint64_t>(hp) != DIFF_MAGIC) {
+            throw std::runtime_error("Invaild binary diff format");
+        }
+
+        // 定长部分：type + is_dir + 4 个 64 位整数 + 3 个哈希值 + 两个字符串长度
+        constexpr size_t FIXED = 2 + 4 * 8 + 3 * 32 + 2 * 4;
+        uint64_t cnt = 0;
+        std::string rec;
+        DiffEntry de;
+        char len_buf[sizeof(uint32_t)];
+        while (is.read(len_buf, sizeof(len_buf))) {
+            const char* lp = len_buf;
+            uint32_t len = take_le<uint32_t>(lp);
+            rec.resize(len);
+            if (len < FIXED || !is.read(rec.data(), len)) {
+                throw std::runtime_error("Truncated binary diff");
+            }
+
+            const char* p = rec.data();
+            de.type = static_cast<ChangeType>(static_cast<uint8_t>(*p++));
+            de.is_dir = *p++ != 0;
+            de.old_size = take_le<uint64_t>(p);
+            de.new_size = take_le<uint64_t>(p);
+            de.old_mtime = take_le<int64_t>(p);
+            de.new_mtime = take_le<int64_t>(p);
+            take_hash(p, de.old_hash);
+            take_hash(p, de.new_hash);
+            take_hash(p, de.content_hash);
+            uint32_t path_len = take_le<uint32_t>(p);
+            if (FIXED + path_len > len) throw std::runtime_error("Truncated binary diff");
+            de.path.assign(p, path_len);
+            p += path_len;
+            uint32_t old_path_len = take_le<uint32_t>(p);
+            if (FIXED + path_len + old_path_len > len) {
+                throw std::runtime_error("Truncated binary diff");
+            }
+            de.old_path.assign(p, old_path_len);
+
+            sink.on_entry(de);
+            ++cnt;
+        }
+        if (is.gcount() != 0) throw std::runtime_error("Truncated binary diff");
+        return cnt;
+    }
+
+    std::unique_ptr<BufferedDiffSink> make_diff_sink(const std::string& format
+                                                            , std::ostream& os) {
+        if (format == "text") return std::make_unique<DiffPrinter>(os);
+        if (format == "ndjson") return std::make_unique<NdjsonSink>(os);
+        if (format == "tsv") return std::make_unique<TsvSink>(os);
+        if (format == "binary") return std::make_unique<BinarySink>(os);
+        return nullptr;
+    }
+}
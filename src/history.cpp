@@ -0,0 +1,91 @@
+/*
+ * @file    src/history.cpp
+ * @brief   This source file implements the functions for 'history' command.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include "dirhist/history.h"
+#include "dirhist/catalog.h"
+#include "dirhist/format.h"
+#include "dirhist/reader.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    std::vector<HistoryEntry> path_history(const fs::path& store_dir
+                        , const std::string& path, int64_t since, int64_t until) {
+        std::vector<CatalogEntry> snaps = query_catalog(store_dir, -1, since, until);
+        std::reverse(snaps.begin(), snaps.end());
+        std::vector<std::string> prefixes = path_prefixes(path);
+
+        std::vector<HistoryEntry> res;
+        // 上一快照中沿路径各层节点的哈希值，trail[0] 为根节点，
+        // 路径在上一快照中存在时 trail.size() == prefixes.size() + 1
+        std::vector<std::array<uint8_t, 32>> trail;
+        std::optional<HistoryEntry> last;   // 上一快照中的目标节点，不存在时为空
+        for (const auto& snap: snaps) {
+            if (!trail.empty() && snap.root_hash == trail[0]) continue;
+
+            SnapReader reader(snapshot_path(store_dir, snap));
+            std::vector<std::array<uint8_t, 32>> cur_trail;
+            std::optional<NodeRef> holder;
+            const NodeRef* cur = &reader.root();
+            bool same = false;
+            for (size_t depth = 0; ; ++depth) {
+                // 哈希值与路径绑定，同层哈希相同即整棵子树相同
+                if (depth < trail.size() && cur->info.hash == trail[depth]) {
+                    same = true;
+                    break;
+                }
+                cur_trail.push_back(cur->info.hash);
+                if (depth == prefixes.size()) break;
+                holder = reader.child(*cur, prefixes[depth]);
+                if (!holder) break;
+                cur = &holder.value();
+            }
+
+            if (same) {
+                std::copy(cur_trail.begin(), cur_trail.end(), trail.begin());
+                continue;
+            }
+            trail = std::move(cur_trail);
+
+            if (trail.size() != prefixes.size() + 1) {
+                if (last) {
+                    last->timestamp = snap.timestamp;
+                    last->type = ChangeType::Deleted;
+                    res.push_back(*last);
+                    last.reset();
+                }
+                continue;
+            }
+
+            HistoryEntry entry;
+            entry.timestamp = snap.timestamp;
+            entry.type = last? ChangeType::Modified: ChangeType::Added;
+            entry.is_dir = cur->info.is_dir;
+            entry.size = cur->info.size;
+            entry.hash = cur->info.hash;
+            res.push_back(entry);
+            last = entry;
+        }
+        return res;
+    }
+
+    void print_history(const std::vector<HistoryEntry>& entries) {
+        if (entries.empty()) {
+            std::cout << "No changes." << std::endl;
+            return;
+        }
+        std::cout << "Timestamp            Change     Type  Size         Hash" << std::endl;
+        for (const auto& e: entries) {
+            std::cout << util::ts_str(e.timestamp) << "  "
+                      << std::left << std::setw(9) << change_type_name(e.type) << "  "
+                      << std::left << std::setw(4) << (e.is_dir? "dir": "file") << "  "
+                      << std::left << std::setw(11) << e.size << "  "
+                      << util::hash_to_hex(e.hash).substr(0, 12) << std::endl;
+        }
+    }
+}
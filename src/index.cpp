@@ -0,0 +1,468 @@
+/*
+ * @file    src/index.cpp
+ * @brief   This source file implements the per-tree content index segments and the 'where' query.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <queue>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "dirhist/index.h"
+#include "dirhist/catalog.h"
+#include "dirhist/reader.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    static_assert(sizeof(IndexHeader) == 72, "IndexHeader must be tightly packed");
+    static_assert(sizeof(IndexRecord) == 56, "IndexRecord must be tightly packed");
+    static_assert(sizeof(IndexMask) == 16, "IndexMask must be tightly packed");
+
+    constexpr size_t INDEX_HEADER_V1_SIZE = offsetof(IndexHeader, mask_count);
+
+    // @brief 只读映射的索引段文件
+    class MappedSegment {
+    public:
+        explicit MappedSegment(const fs::path& path) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return;
+            struct stat st{};
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                size_ = static_cast<size_t>(st.st_size);
+                void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) data_ = static_cast<const char*>(p);
+            }
+            ::close(fd);
+        }
+
+        ~MappedSegment() {
+            if (data_) ::munmap(const_cast<char*>(data_), size_);
+        }
+
+        MappedSegment(const MappedSegment&) = delete;
+        MappedSegment& operator=(const MappedSegment&) = delete;
+
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // @brief 已映射并校验过文件头的索引段
+    class IndexSegment {
+    public:
+        explicit IndexSegment(const fs::path& path): seg_(path) {
+            const char* data = seg_.data();
+            size_t size = seg_.size();
+            if (!data || size < INDEX_HEADER_V1_SIZE) return;
+            std::memcpy(static_cast<void*>(&hdr_), data, INDEX_HEADER_V1_SIZE);
+            size_t hdr_size = INDEX_HEADER_V1_SIZE;
+            if (hdr_.magic == INDEX_MAGIC) {
+                if (size < sizeof(IndexHeader)) return;
+                std::memcpy(static_cast<void*>(&hdr_), data, sizeof(IndexHeader));
+                hdr_size = sizeof(IndexHeader);
+            }
+            else if (hdr_.magic != INDEX_MAGIC_V1) return;
+
+            // 各区域紧跟在文件头之后，mmap 返回页对齐地址，记录按 8 字节对齐
+            size_t rest = size - hdr_size;
+            if (hdr_.count > rest / sizeof(IndexRecord)) return;
+            rest -= hdr_.count * sizeof(IndexRecord);
+            if (hdr_.mask_count > rest / sizeof(IndexMask)) return;
+            rest -= hdr_.mask_count * sizeof(IndexMask);
+            if (hdr_.paths_size != rest) return;
+            records_ = reinterpret_cast<const IndexRecord*>(data + hdr_size);
+            masks_ = reinterpret_cast<const IndexMask*>(records_ + hdr_.count);
+            paths_ = reinterpret_cast<const char*>(masks_ + hdr_.mask_count);
+
+            // 遮蔽记录通常很少，打开时即校验，之后二分查找无需逐条检查
+            for (uint64_t i = 0; i < hdr_.mask_count; ++i) {
+                if (!in_range(masks_[i].path_offset, masks_[i].path_len)) return;
+            }
+            valid_ = true;
+        }
+
+        bool valid() const { return valid_; }
+        const IndexHeader& header() const { return hdr_; }
+        const IndexRecord* begin() const { return records_; }
+        const IndexRecord* end() const { return records_ + hdr_.count; }
+
+        // @brief 记录的路径，越界时返回空
+        std::optional<std::string_view> path(const IndexRecord& r) const {
+            if (!in_range(r.path_offset, r.path_len)) return std::nullopt;
+            return std::string_view(paths_ + r.path_offset, r.path_len);
+        }
+
+        // @brief 本段是否遮蔽了父段链中的路径
+        bool masks(std::string_view path) const {
+            const IndexMask* last = masks_ + hdr_.mask_count;
+            const IndexMask* it = std::lower_bound(masks_, last, path
+                        , [this](const IndexMask& m, std::string_view p)
+                            {return mask_path(m) < p;});
+            return it != last && mask_path(*it) == path;
+        }
+
+    private:
+        bool in_range(uint64_t offset, uint32_t len) const {
+            return offset <= hdr_.paths_size && len <= hdr_.paths_size - offset;
+        }
+
+        std::string_view mask_path(const IndexMask& m) const {
+            return std::string_view(paths_ + m.path_offset, m.path_len);
+        }
+
+        MappedSegment seg_;
+        IndexHeader hdr_;
+        const IndexRecord* records_ = nullptr;
+        const IndexMask* masks_ = nullptr;
+        const char* paths_ = nullptr;
+        bool valid_ = false;
+    };
+
+    fs::path index_path(const fs::path& store_dir, const std::array<uint8_t, 32>& root_hash) {
+        return store_dir / "index" / (util::hash_to_hex(root_hash) + ".idx");
+    }
+
+    // @brief 辅助函数，打开根哈希对应的索引段及其全部父段
+    // @param hashes 非空时写入各段对应的根哈希
+    // @return 返回自新到旧排列的段；任一段缺失或损坏、或链长超过上限时返回空列表
+    static std::vector<std::unique_ptr<IndexSegment>> aux_open_chain(const fs::path& store_dir
+                        , const std::array<uint8_t, 32>& root_hash
+                        , std::vector<std::array<uint8_t, 32>>* hashes = nullptr) {
+        std::vector<std::unique_ptr<IndexSegment>> chain;
+        std::array<uint8_t, 32> hash = root_hash;
+        if (hashes) hashes->clear();
+        do {
+            // 父段被改写后可能成环，按链长上限截断
+            if (chain.size() > INDEX_MAX_CHAIN) return {};
+            auto seg = std::make_unique<IndexSegment>(index_path(store_dir, hash));
+            if (!seg->valid()) return {};
+            if (hashes) hashes->push_back(hash);
+            hash = seg->header().base_hash;
+            chain.push_back(std::move(seg));
+        } while (hash != std::array<uint8_t, 32>{0});
+        return chain;
+    }
+
+    // @brief 辅助函数，按路径升序逐个还原索引段链表示的全部文件
+    // @param chain aux_open_chain 返回的段
+    // @param visit 对每个文件调用 visit(路径, 记录)，记录的 path_offset 属于其所在段
+    // @return 记录路径越界时返回false
+    // @note 段内记录按内容哈希排序，先为每段建立按路径排序的视图，再对各段做 k 路归并：
+    //       同一路径取最新段中的记录，若比该段更新的段遮蔽了该路径则已删除
+    template <typename Visit>
+    static bool aux_resolve(const std::vector<std::unique_ptr<IndexSegment>>& chain
+                        , Visit&& visit) {
+        using View = std::vector<std::pair<std::string_view, const IndexRecord*>>;
+        std::vector<View> views(chain.size());
+        for (size_t k = 0; k < chain.size(); ++k) {
+            views[k].reserve(chain[k]->header().count);
+            for (const IndexRecord& r: *chain[k]) {
+                auto path = chain[k]->path(r);
+                if (!path) return false;
+                views[k].emplace_back(*path, &r);
+            }
+            std::sort(views[k].begin(), views[k].end());
+        }
+
+        // 堆顶为路径最小、同一路径中最新的段
+        using Cursor = std::pair<size_t, size_t>;  // 段序号，视图中的位置
+        auto later = [&views](const Cursor& a, const Cursor& b) {
+            std::string_view pa = views[a.first][a.second].first;
+            std::string_view pb = views[b.first][b.second].first;
+            return pa != pb? pa > pb: a.first > b.first;
+        };
+        std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> heap(later);
+        for (size_t k = 0; k < views.size(); ++k) {
+            if (!views[k].empty()) heap.push({k, 0});
+        }
+        while (!heap.empty()) {
+            auto [k, pos] = heap.top();
+            auto [path, rec] = views[k][pos];
+            // 较旧段中的同名记录已被替换
+            while (!heap.empty() && views[heap.top().first][heap.top().second].first == path) {
+                Cursor c = heap.top();
+                heap.pop();
+                if (++c.second < views[c.first].size()) heap.push(c);
+            }
+            bool masked = false;
+            for (size_t j = 0; j < k && !masked; ++j) masked = chain[j]->masks(path);
+            if (!masked) visit(path, *rec);
+        }
+        return true;
+    }
+
+    // @brief 辅助函数，收集子树中内容哈希已知的普通文件
+    static void aux_collect(const Node& node, std::vector<const Node*>& files) {
+        if (node.is_symlink) return;
+        if (!node.is_dir) {
+            if (has_content_hash(node)) files.push_back(&node);
+            return;
+        }
+        for (const auto& child: node.children) aux_collect(*child, files);
+    }
+
+    // @brief 辅助函数，写入索引段，写入临时文件后改名
+    // @param base 非空时尝试以该根哈希的索引段为父段写入增量段
+    // @return 写入失败返回false
+    static bool write_index(const fs::path& store_dir, const Node& root
+                        , const std::array<uint8_t, 32>* base) {
+        std::vector<const Node*> files;
+        aux_collect(root, files);
+        std::sort(files.begin(), files.end(), [](const Node* a, const Node* b) {
+            return a->path < b->path;
+        });
+
+        IndexHeader hdr;
+        std::vector<const Node*> added = files;
+        std::vector<std::string> masked;
+        std::vector<std::array<uint8_t, 32>> hashes;
+        std::vector<std::unique_ptr<IndexSegment>> chain;
+        if (base && *base != root.hash) chain = aux_open_chain(store_dir, *base, &hashes);
+        if (!chain.empty() && chain.front()->header().chain_len < INDEX_MAX_CHAIN
+                && std::find(hashes.begin(), hashes.end(), root.hash) == hashes.end()) {
+            // 两侧均按路径升序，归并得到新增或内容变化的文件与需遮蔽的路径
+            std::vector<const Node*> diff;
+            std::vector<std::string> gone;
+            size_t i = 0;
+            bool ok = aux_resolve(chain, [&](std::string_view path, const IndexRecord& r) {
+                for (; i < files.size() && files[i]->path < path; ++i) diff.push_back(files[i]);
+                if (i < files.size() && files[i]->path == path) {
+                    if (r.content_hash != files[i]->content_hash || r.size != files[i]->size) {
+                        diff.push_back(files[i]);
+                        gone.emplace_back(path);
+                    }
+                    ++i;
+                }
+                else gone.emplace_back(path);
+            });
+            for (; i < files.size(); ++i) diff.push_back(files[i]);
+
+            // 变化过多时增量段不比完整段小，且会拖慢查询
+            if (ok && diff.size() + gone.size() < files.size()) {
+                added.swap(diff);
+                masked.swap(gone);
+                hdr.base_hash = *base;
+                hdr.chain_len = chain.front()->header().chain_len + 1;
+            }
+        }
+        std::sort(added.begin(), added.end(), [](const Node* a, const Node* b) {
+            if (a->content_hash != b->content_hash) return a->content_hash < b->content_hash;
+            return a->path < b->path;
+        });
+
+        hdr.count = added.size();
+        hdr.mask_count = masked.size();
+        std::vector<IndexRecord> records(added.size());
+        std::vector<IndexMask> masks(masked.size());
+        std::string paths;
+        for (size_t i = 0; i < added.size(); ++i) {
+            records[i].content_hash = added[i]->content_hash;
+            records[i].path_offset = paths.size();
+            records[i].size = added[i]->size;
+            records[i].path_len = static_cast<uint32_t>(added[i]->path.size());
+            paths += added[i]->path;
+        }
+        for (size_t i = 0; i < masked.size(); ++i) {
+            masks[i].path_offset = paths.size();
+            masks[i].path_len = static_cast<uint32_t>(masked[i].size());
+            paths += masked[i];
+        }
+        hdr.paths_size = paths.size();
+
+        fs::path path = index_path(store_dir, root.hash);
+        fs::path tmp = path;
+        tmp += util::tmp_suffix();
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        {
+            std::ofstream ofs(tmp, std::ios::binary);
+            if (!ofs) return false;
+            write(ofs, hdr);
+            ofs.write(reinterpret_cast<const char*>(records.data())
+                                    , records.size() * sizeof(IndexRecord));
+            ofs.write(reinterpret_cast<const char*>(masks.data())
+                                    , masks.size() * sizeof(IndexMask));
+            ofs.write(paths.data(), paths.size());
+            if (!ofs) {
+                ofs.close();
+                fs::remove(tmp, ec);
+                return false;
+            }
+        }
+        fs::rename(tmp, path, ec);
+        if (ec) fs::remove(tmp, ec);
+        return !ec;
+    }
+
+    void save_index(const fs::path& store_dir, const Node& root) {
+        std::error_code ec;
+        if (fs::exists(index_path(store_dir, root.hash), ec)) return;
+
+        // 以最近一棵根哈希不同的目录树为父段，新快照刚登记，取最近两条即可
+        std::optional<std::array<uint8_t, 32>> base;
+        try {
+            for (const auto& e: query_catalog(store_dir, 2)) {
+                if (e.root_hash != root.hash) {
+                    base = e.root_hash;
+                    break;
+                }
+            }
+        }
+        catch (const std::exception&) {}
+        write_index(store_dir, root, base? &*base: nullptr);
+    }
+
+    // @brief 一次查询中已打开的索引段及段内命中的记录，按根哈希缓存
+    // @note 相邻目录树的段链大多重合，缓存后每个段在一次查询中只映射、查找一次；
+    //       只缓存有效的段，查询中途为旧快照生成的段之后仍可打开
+    class SegmentCache {
+    public:
+        SegmentCache(const fs::path& store_dir, const std::array<uint8_t, 32>& content)
+            : store_dir_(store_dir), content_(content) {}
+
+        // @brief 打开的索引段及其内容哈希命中的记录
+        struct Entry {
+            std::unique_ptr<IndexSegment> seg;
+            std::vector<const IndexRecord*> matches;
+        };
+
+        // @brief 获取根哈希对应的索引段及其全部父段
+        // @return 返回自新到旧排列的段；任一段缺失或损坏、或链长超过上限时返回空列表
+        std::vector<const Entry*> chain(const std::array<uint8_t, 32>& root_hash) {
+            std::vector<const Entry*> res;
+            std::array<uint8_t, 32> hash = root_hash;
+            do {
+                // 父段被改写后可能成环，按链长上限截断
+                if (res.size() > INDEX_MAX_CHAIN) return {};
+                const Entry* entry = open(hash);
+                if (!entry) return {};
+                res.push_back(entry);
+                hash = entry->seg->header().base_hash;
+            } while (hash != std::array<uint8_t, 32>{0});
+            return res;
+        }
+
+    private:
+        // @brief 打开并查找一个段，段无效或命中记录的路径越界时返回空
+        const Entry* open(const std::array<uint8_t, 32>& hash) {
+            auto it = entries_.find(hash);
+            if (it != entries_.end()) return &it->second;
+
+            Entry entry;
+            entry.seg = std::make_unique<IndexSegment>(index_path(store_dir_, hash));
+            const IndexSegment& seg = *entry.seg;
+            if (!seg.valid()) return nullptr;
+            auto r = std::lower_bound(seg.begin(), seg.end(), content_
+                        , [](const IndexRecord& rec, const std::array<uint8_t, 32>& h)
+                            {return rec.content_hash < h;});
+            for (; r != seg.end() && r->content_hash == content_; ++r) {
+                if (!seg.path(*r)) return nullptr;
+                entry.matches.push_back(&*r);
+            }
+            return &entries_.emplace(hash, std::move(entry)).first->second;
+        }
+
+        fs::path store_dir_;
+        std::array<uint8_t, 32> content_;
+        std::map<std::array<uint8_t, 32>, Entry> entries_;
+    };
+
+    // @brief 辅助函数，通过缓存的索引段查找，见 lookup_index
+    static std::optional<std::vector<ContainsHit>> aux_lookup(SegmentCache& cache
+                        , const std::array<uint8_t, 32>& root_hash) {
+        auto chain = cache.chain(root_hash);
+        if (chain.empty()) return std::nullopt;
+
+        std::vector<ContainsHit> res;
+        for (size_t k = 0; k < chain.size(); ++k) {
+            const IndexSegment& seg = *chain[k]->seg;
+            for (const IndexRecord* r: chain[k]->matches) {
+                std::string_view path = *seg.path(*r);
+                // 被更新的段遮蔽的路径已删除或内容已变化
+                bool masked = false;
+                for (size_t j = 0; j < k && !masked; ++j) masked = chain[j]->seg->masks(path);
+                if (!masked) res.push_back(ContainsHit{0, std::string(path), false, r->size});
+            }
+        }
+        std::sort(res.begin(), res.end(), [](const ContainsHit& a, const ContainsHit& b) {
+            return a.path < b.path;
+        });
+        return res;
+    }
+
+    std::optional<std::vector<ContainsHit>> lookup_index(const fs::path& store_dir
+                        , const std::array<uint8_t, 32>& root_hash
+                        , const std::array<uint8_t, 32>& content) {
+        SegmentCache cache(store_dir, content);
+        return aux_lookup(cache, root_hash);
+    }
+
+    ContainsStats where_content(const fs::path& store_dir
+                        , const std::array<uint8_t, 32>& content
+                        , std::vector<ContainsHit>& hits, int64_t since, int64_t until) {
+        std::vector<CatalogEntry> snaps = query_catalog(store_dir, -1, since, until);
+        std::reverse(snaps.begin(), snaps.end());
+
+        ContainsStats stats;
+        SegmentCache cache(store_dir, content);
+        std::map<std::array<uint8_t, 32>, std::vector<ContainsHit>> found;
+        std::optional<std::array<uint8_t, 32>> indexed;     // 上一棵已有索引段的目录树
+        for (const auto& snap: snaps) {
+            ++stats.snapshots;
+            auto it = found.find(snap.root_hash);
+            if (it == found.end()) {
+                ++stats.trees;
+                ++stats.opened;
+                auto res = aux_lookup(cache, snap.root_hash);
+                if (res) indexed = snap.root_hash;
+                else {
+                    SnapReader reader(snapshot_path(store_dir, snap));
+                    if (!has_content_hash(reader.header().version)) {
+                        // 旧版本快照没有内容哈希，无法按内容查找，也不为其生成索引段
+                        ++stats.skipped;
+                        res.emplace();
+                    }
+                    else {
+                        // 旧快照没有索引段，读取整棵目录树生成，之后的查询直接查找
+                        ++stats.built;
+                        auto root = reader.load(reader.root());
+                        if (write_index(store_dir, *root, indexed? &*indexed: nullptr)) {
+                            res = aux_lookup(cache, snap.root_hash);
+                        }
+                        if (res) indexed = snap.root_hash;
+                        else {
+                            // 索引段无法写入（如快照目录只读）时直接在目录树中查找
+                            std::vector<const Node*> files;
+                            aux_collect(*root, files);
+                            res.emplace();
+                            for (const Node* f: files) {
+                                if (f->content_hash == content) {
+                                    res->push_back(ContainsHit{0, f->path, false, f->size});
+                                }
+                            }
+                            std::sort(res->begin(), res->end()
+                                , [](const ContainsHit& a, const ContainsHit& b)
+                                    {return a.path < b.path;});
+                        }
+                    }
+                }
+                it = found.emplace(snap.root_hash, std::move(*res)).first;
+            }
+            for (const auto& hit: it->second) {
+                hits.push_back(hit);
+                hits.back().timestamp = snap.timestamp;
+            }
+        }
+        return stats;
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * @file    src/internal/record.h
+ * @brief   This header file defines the pread based access to node records in snapshot files.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <vector>
+#include "dirhist/serialize.h"
+
+namespace dirhist {
+    // @brief 只读快照文件句柄
+    // @note 所有读取均通过 pread 按偏移进行，没有共享的文件位置，可被多个线程同时使用
+    class SnapFile {
+    public:
+        explicit SnapFile(const fs::path& path);
+        ~SnapFile();
+
+        SnapFile(const SnapFile&) = delete;
+        SnapFile& operator=(const SnapFile&) = delete;
+
+        // @brief 从 offset 处读取至多 n 字节
+        // @return 返回实际读取的字节数
+        size_t read_at(void* buf, size_t n, uint64_t offset) const;
+
+        // @brief 文件大小
+        uint64_t size() const { return size_; }
+
+        // @brief 文件路径
+        const fs::path& path() const { return path_; }
+
+    private:
+        int fd_ = -1;
+        uint64_t size_ = 0;
+        fs::path path_;
+    };
+
+    // @brief 读取 offset 处的节点记录（格式见 write_node）
+    // @param file 快照文件
+    // @param offset 节点偏移
+    // @param node 读取到的节点信息，不含子节点
+    // @param child_offsets 读取到的子节点偏移表
+    // @param version 快照文件版本号
+    // @return 返回记录中的子节点数量字段（增量快照中可能为 INHERIT，此时偏移表为空；
+    //         或为 INHERIT_RUNS，此时偏移表中可能含有继承区间表项，见 delta.h）
+    uint32_t read_record(const SnapFile& file, uint64_t offset, Node& node
+                , std::vector<uint64_t>& child_offsets, uint8_t version = VERSION);
+}
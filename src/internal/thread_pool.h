@@ -0,0 +1,88 @@
+/*
+ * @file    src/internal/thread_pool.h
+ * @brief   This header file defines the thread pool used for fork-join tasks.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+    // @brief 固定大小的线程池
+    // @note 等待任务完成的线程会亲自执行本组中尚未开始的任务（见 TaskGroup::wait），
+    //       因此任务内部可以继续派发子任务并等待，不会因线程耗尽而死锁；
+    //       等待线程不会执行其他组的任务，任务中可以安全地阻塞等待本组之外的消费者
+    class ThreadPool {
+    public:
+        // @param workers 工作线程数量，为0时任务仅由等待线程执行
+        explicit ThreadPool(size_t workers);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // @brief 提交任务
+        void submit(std::function<void()> task);
+
+        // @brief 工作线程数量
+        size_t workers() const { return threads_.size(); }
+
+        // @brief 全局共享线程池，工作线程数为硬件线程数减一
+        static ThreadPool& instance();
+
+    private:
+        void worker_loop();
+
+        std::vector<std::thread> threads_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+    };
+
+    // @brief 一组可等待的任务
+    // @note run 与 wait 只能由创建该组的线程调用
+    class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool& pool = ThreadPool::instance()): pool_(pool) {}
+        // 析构时等待所有任务完成，但不再抛出任务中的异常
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        // @brief 派发任务
+        void run(std::function<void()> task);
+
+        // @brief 等待所有任务完成，先在当前线程执行本组尚未被工作线程取走的任务，
+        //        再在条件变量上等待其余任务完成
+        // @note 若有任务抛出异常，重新抛出第一个异常
+        void wait();
+
+    private:
+        // 任务同时位于线程池队列与本组列表中，先认领者执行
+        struct Task {
+            std::function<void()> fn;
+            std::atomic<bool> claimed{false};
+        };
+
+        void execute(Task& task);
+        void drain();
+
+        ThreadPool& pool_;
+        std::vector<std::shared_ptr<Task>> tasks_;
+        size_t pending_ = 0;
+        std::exception_ptr error_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+    };
+}
@@ -0,0 +1,92 @@
+/*
+ * @file    src/internal/tree_printer.h
+ * @brief   This header file defines the buffered printer shared by the tree renderers.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#pragma once
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "dirhist/snapshot.h"
+#include "util.h"
+
+namespace dirhist {
+    // 目录树输出缓冲区达到该大小时整块写出
+    constexpr size_t TREE_FLUSH_BLOCK = 1 << 20;
+
+    // @brief 辅助类，带缓冲的目录树打印器
+    // @note 所有层级共用一个缩进前缀缓冲区，进入子目录时追加、返回时截断；
+    //       输出先写入缓冲区，按块写出。标准输出不是终端时不输出颜色
+    class TreePrinter {
+    public:
+        TreePrinter(): tty_(util::stdout_is_tty()) {
+            buf_.reserve(TREE_FLUSH_BLOCK + 4096);
+        }
+        ~TreePrinter() { flush(); }
+
+        // @brief 标准输出是否为终端
+        bool interactive() const { return tty_; }
+
+        // @brief 打印一行原始文本
+        void text(const std::string& str) {
+            buf_ += str;
+            buf_ += '\n';
+            if (buf_.size() >= TREE_FLUSH_BLOCK) flush();
+        }
+
+        // @brief 以当前缩进前缀打印一个节点
+        // @param node 目录树节点
+        // @param is_last 是否为最后一个子节点
+        void line(const Node& node, bool is_last) {
+            line(node.path, node.is_dir, node.is_symlink, is_last);
+        }
+
+        // @brief 以当前缩进前缀打印一个节点
+        // @param path 节点相对路径
+        // @param is_dir 是否为目录
+        // @param is_symlink 是否为符号链接
+        // @param is_last 是否为最后一个子节点
+        void line(std::string_view path, bool is_dir, bool is_symlink, bool is_last) {
+            bool dir = is_dir && !is_symlink;
+            buf_ += prefix_;
+            buf_ += is_last? "└── ": "├── ";
+            if (tty_) {
+                buf_ += dir? util::color::GREEN
+                           : is_symlink? util::color::YELLOW: util::color::RED;
+            }
+            buf_ += path;
+            if (dir) buf_ += "[DIR]";
+            else if (is_symlink) buf_ += "[SIMLINK]";
+            if (tty_) buf_ += util::color::RESET;
+            buf_ += '\n';
+            if (buf_.size() >= TREE_FLUSH_BLOCK) flush();
+        }
+
+        // @brief 进入子节点层级，追加缩进
+        // @param is_last 当前节点是否为最后一个子节点
+        // @return 返回追加前的前缀长度，供 pop 恢复
+        size_t push(bool is_last) {
+            size_t len = prefix_.size();
+            prefix_ += is_last? "    ": "│   ";
+            return len;
+        }
+
+        // @brief 返回上一层级，恢复缩进
+        void pop(size_t len) { prefix_.resize(len); }
+
+        // @brief 将缓冲区写出到标准输出
+        void flush() {
+            if (buf_.empty()) return;
+            std::cout.write(buf_.data(), buf_.size());
+            std::cout.flush();
+            buf_.clear();
+        }
+
+    private:
+        bool tty_;
+        std::string prefix_;
+        std::string buf_;
+    };
+}
@@ -9,6 +9,7 @@
 #include <array>
 #include <string>
 #include <cstdint>
+#include <optional>
 
 // 简化命名空间名称书写
 namespace fs = std::filesystem;
@@ -19,6 +20,7 @@ namespace util {
         constexpr const char* RED    = "\033[31m";
         constexpr const char* GREEN  = "\033[32m";
         constexpr const char* YELLOW = "\033[33m";
+        constexpr const char* CYAN   = "\033[36m";
         constexpr const char* RESET  = "\033[0m";
     }
 
@@ -27,15 +29,63 @@ namespace util {
     // @return  返回计算后的SHA-256哈希值，长度32字节
     std::array<uint8_t, 32> sha256(const std::string& data);
 
+    // @brief 增量计算SHA-256哈希值，用于分块读取的大文件
+    class Sha256 {
+    public:
+        Sha256();
+        ~Sha256();
+
+        Sha256(const Sha256&) = delete;
+        Sha256& operator=(const Sha256&) = delete;
+
+        // @brief 追加数据
+        void update(const void* data, size_t len);
+
+        // @brief 结束计算并返回哈希值，之后不可再追加数据
+        std::array<uint8_t, 32> final();
+
+    private:
+        void* ctx_ = nullptr;   // EVP_MD_CTX*
+    };
+
+    // @brief   分块读取文件并计算其内容的SHA-256哈希值，与快照中文件的内容哈希一致
+    // @param path 文件路径
+    // @return  文件无法打开时返回空
+    std::optional<std::array<uint8_t, 32>> sha256_file(const fs::path& path);
+
     // @brief   将SHA-256哈希值按字节转换字符串
     // @param hash 待转换的SHA-256哈希值
     // @return 返回转换后的字符串
     std::string hash_to_str(const std::array<uint8_t, 32>& hash);
 
+    // @brief   将SHA-256哈希值转换为十六进制字符串
+    // @param hash 待转换的SHA-256哈希值
+    // @return 返回长度为64的小写十六进制字符串
+    std::string hash_to_hex(const std::array<uint8_t, 32>& hash);
+
+    // @brief   将十六进制字符串解析为SHA-256哈希值
+    // @param hex 长度为64的十六进制字符串，大小写均可
+    // @return 格式不合法时返回空
+    std::optional<std::array<uint8_t, 32>> hex_to_hash(const std::string& hex);
+
     // @brief 返回当前时间戳，精确到毫秒
     // @return 返回毫秒级时间戳
     int64_t now_ms();
 
+    // @brief 生成临时文件名后缀，形如 ".tmp-<pid>-<序号>"
+    // @return 返回在进程间与进程内均不重复的后缀，并发写入同一目标时互不覆盖
+    std::string tmp_suffix();
+
+    // @brief 将文件修改时间转换为毫秒级 Unix 时间戳
+    // @param ft 文件时间（std::filesystem::file_time_type）
+    // @return 返回毫秒级时间戳
+    int64_t file_time_ms(const fs::file_time_type& ft);
+
+    // @brief 将旧版本快照中以文件时钟计数保存的修改时间转换为毫秒级 Unix 时间戳
+    // @param ticks file_time_type::duration 的计数值
+    // @return 返回毫秒级时间戳
+    int64_t file_ticks_ms(int64_t ticks);
+
     // @brief 检查是否以指定字符串为后缀
     // @param str 目标字符串
     // @param prefix 待查找后缀字符串
@@ -55,6 +105,11 @@ namespace util {
     // @return 返回可读字符串
     std::string ts_str(int64_t ts);
 
+    // @brief 将时间字符串解析为毫秒级时间戳
+    // @param str 毫秒级时间戳，或本地时间 "YYYY-MM-DD HH:MM:SS"、"YYYY-MM-DD"
+    // @return 解析失败时返回空
+    std::optional<int64_t> parse_ts(const std::string& str);
+
     // @brief 去除前导和后导空格
     // @return 返回处理后的字符串
     std::string trim(const std::string& str);
@@ -64,6 +119,9 @@ namespace util {
     // @result 返回解析后的子串集合
     std::vector<std::string> split_by_comma(const std::string& str);
 
+    // @brief 判断标准输出是否为终端，用于决定是否输出颜色
+    bool stdout_is_tty();
+
     // @brief 比较两个路径（绝对或相对）是否相同
     // @param path1
     // @param path2
@@ -6,10 +6,12 @@
  */
 #include <algorithm>
 #include "dirhist/log.h"
+#include "dirhist/catalog.h"
 #include "internal/util.h"
 
 namespace dirhist {
-    void list_snapshots(int n, const fs::path& target_dir){
+    void list_snapshots(int n, const fs::path& target_dir
+                                            , int64_t since, int64_t until){
         // 确保target_dir为绝对路径
         fs::path target_abs = fs::absolute(target_dir);
         // 检查根目录是否存在
@@ -29,23 +31,16 @@ namespace dirhist {
             return;
         }
 
-        std::vector<LogEntry> entries;
-        for (const auto& e: fs::directory_iterator(target_dir)){
-            if(!e.is_regular_file()) continue;
-            if(!util::is_snap_bin_file(e.path())) continue;
-
-            std::ifstream ifs(e.path());
-            if (!ifs) {
-                throw std::runtime_error("Error opening snapshot file: "
-                                            + e.path().string());
-            }
-            // 读取文件头
-            Header hdr;
-            read(ifs, hdr);
+        if (n < -1) {
+            std::cerr << "Invaild num: " << n << "[num >= -1]"<< std::endl;
+            return;
+        }
 
-            // 检查文件头
-            if (hdr.magic != MAGIC || hdr.version != 1) continue;
-            entries.emplace_back(LogEntry{hdr.timestamp, e.file_size(), e.path()});
+        // 从快照目录中按时间范围查询，结果已按时间戳降序排列
+        std::vector<LogEntry> entries;
+        for (const auto& e: query_catalog(target_dir, n, since, until)){
+            entries.emplace_back(LogEntry{e.timestamp, e.file_size
+                                    , snapshot_path(target_dir, e), e.stats});
         }
 
         if (!(entries.size())){
@@ -55,29 +50,17 @@ namespace dirhist {
                       << std::endl;
             return;
         }
-
-        // 基于时间戳排序
-        std::sort(entries.begin(), entries.end(), 
-            [](const auto& a, const auto& b){return a.timestamp > b.timestamp;});
         
         // 打印日志
-        std::cout << "Timestamp            Size        File" << std::endl;
-        // 默认情况打印所有记录
-        if (n == -1) {
-            for (const auto& e: entries){
-                std::cout << util::ts_str(e.timestamp) << "  "
-                          << std::left << std::setw(9) << e.file_size << "  "
-                          << e.path << std::endl;
-            }
-        } else if (n >= 0) {
-            for (int i = 0; i < n && i < entries.size(); ++i){
-                auto e = entries.at(i);
-                std::cout << util::ts_str(e.timestamp) << "  "
-                          << std::left << std::setw(9) << e.file_size << "  "
-                          << e.path << std::endl;
-            }
-        } else {
-            std::cerr << "Invaild num: " << n << "[num >= -1]"<< std::endl;
+        std::cout << "Timestamp            Size       Files      Dirs       Bytes        File"
+                  << std::endl;
+        for (const auto& e: entries){
+            std::cout << util::ts_str(e.timestamp) << "  "
+                      << std::left << std::setw(9) << e.file_size << "  "
+                      << std::left << std::setw(9) << e.stats.file_cnt << "  "
+                      << std::left << std::setw(9) << e.stats.dir_cnt << "  "
+                      << std::left << std::setw(11) << e.stats.total_bytes << "  "
+                      << e.path << std::endl;
         }
     }
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
  * @author  yannn
  * @date    2025-07-28
  */
-// g++ -std=c++17 -I./include -o bin/dirhist src/main.cpp  src/snapshot.cpp src/serialize.cpp src/log.cpp src/diff.cpp src/util.cpp src/cli.cpp -lssl -lcrypto
+// g++ -std=c++17 -I./include -o bin/dirhist src/main.cpp  src/snapshot.cpp src/serialize.cpp src/log.cpp src/diff.cpp src/util.cpp src/cli.cpp src/objstore.cpp src/delta.cpp src/catalog.cpp src/thread_pool.cpp src/format.cpp src/reader.cpp src/history.cpp src/summary.cpp src/stat.cpp src/diffcache.cpp src/filter.cpp src/du.cpp src/find.cpp src/flat.cpp src/bloom.cpp src/dupes.cpp src/index.cpp -lssl -lcrypto
 
 #include <iostream>
 #include <algorithm>
@@ -19,7 +19,7 @@ int main(int argc, char *argv[]){
     // parse the command line instructions
     if (argc < 2){
         std::cerr << "Usage: dirhist <cmd> [--options>]" << std::endl
-                  << "  cmd: snap | tree | log | diff | rm" << std::endl;
+                  << "  cmd: snap | tree | log | diff | status | history | stat | find | du | contains | dupes | where | rm | gc" << std::endl;
         return -1;
     }
 
@@ -36,12 +36,39 @@ int main(int argc, char *argv[]){
     else if (cmd == "diff") {
         return dirhist::process_diff(argc, argv);
     }
+    else if (cmd == "status") {
+        return dirhist::process_status(argc, argv);
+    }
+    else if (cmd == "history") {
+        return dirhist::process_history(argc, argv);
+    }
+    else if (cmd == "stat") {
+        return dirhist::process_stat(argc, argv);
+    }
+    else if (cmd == "find") {
+        return dirhist::process_find(argc, argv);
+    }
+    else if (cmd == "du") {
+        return dirhist::process_du(argc, argv);
+    }
+    else if (cmd == "contains") {
+        return dirhist::process_contains(argc, argv);
+    }
+    else if (cmd == "dupes") {
+        return dirhist::process_dupes(argc, argv);
+    }
+    else if (cmd == "where") {
+        return dirhist::process_where(argc, argv);
+    }
     else if (cmd == "rm"){
         return dirhist::process_rm(argc, argv);
     }
+    else if (cmd == "gc"){
+        return dirhist::process_gc(argc, argv);
+    }
     else {
         std::cerr << "Usage: dirhist <cmd> [--options>]" << std::endl
-                  << "  cmd: snap | tree | log | diff | rm" << std::endl;
+                  << "  cmd: snap | tree | log | diff | status | history | stat | find | du | contains | dupes | where | rm | gc" << std::endl;
         return -1;
     }
     return 0;
@@ -0,0 +1,296 @@
+/*
+ * @file    src/objstore.cpp
+ * @brief   This source file implements the content-addressed object store.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <sstream>
+#include <unordered_set>
+#include "dirhist/objstore.h"
+#include "dirhist/bloom.h"
+#include "dirhist/catalog.h"
+#include "dirhist/index.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    fs::path object_path(const fs::path& store_dir
+                                    , const std::array<uint8_t, 32>& key) {
+        std::string hex = util::hash_to_hex(key);
+        return store_dir / "objects" / hex.substr(0, 2) / hex.substr(2);
+    }
+
+    // @brief 辅助函数，判断节点是否对应对象（目录节点，符号链接除外）
+    static bool has_object(const Node& node) {
+        return node.is_dir && !node.is_symlink;
+    }
+
+    // @brief 辅助函数，自底向上序列化目录对象并计算对象键
+    // @param dir 目录节点
+    // @param store_dir 快照目录，为空时只计算对象键、不写入
+    // @param written 新写入的对象数量
+    // @return 返回目录的对象键
+    static std::array<uint8_t, 32> store_object(const Node& dir
+                                    , const fs::path* store_dir, uint64_t& written) {
+        // 子目录的对象键依赖其内容，需先处理子目录
+        std::ostringstream oss;
+        write(oss, OBJ_MAGIC);
+        write(oss, static_cast<uint32_t>(dir.children.size()));
+        for (const auto& child: dir.children) {
+            write_node_info(oss, *child, false);
+            if (!has_object(*child)) continue;
+            auto key = store_object(*child, store_dir, written);
+            oss.write(reinterpret_cast<const char*>(key.data()), key.size());
+        }
+        std::string data = oss.str();
+        auto key = util::sha256(data);
+        if (!store_dir) return key;
+
+        // 对象键相同即内容相同，已存在的对象无需重复写入
+        fs::path obj = object_path(*store_dir, key);
+        if (fs::exists(obj)) return key;
+
+        // 写入临时文件后再重命名，保证对象文件要么完整要么不存在
+        fs::create_directories(obj.parent_path());
+        fs::path tmp = obj;
+        tmp += util::tmp_suffix();
+        {
+            std::ofstream ofs(tmp, std::ios::binary);
+            if (!ofs) {
+                throw std::runtime_error("Error opening object file: "
+                                                    + tmp.string());
+            }
+            ofs.write(data.data(), data.size());
+            if (!ofs) {
+                throw std::runtime_error("Error writing object file: "
+                                                    + tmp.string());
+            }
+        }
+        fs::rename(tmp, obj);
+        ++written;
+        return key;
+    }
+
+    std::array<uint8_t, 32> object_key(const Node& dir) {
+        if (!has_object(dir)) return dir.hash;
+        uint64_t written = 0;
+        return store_object(dir, nullptr, written);
+    }
+
+    uint64_t write_objects(const Node& node, const fs::path& store_dir
+                                    , std::array<uint8_t, 32>* key) {
+        if (!has_object(node)) {
+            if (key) *key = node.hash;
+            return 0;
+        }
+        uint64_t written = 0;
+        auto root_key = store_object(node, &store_dir, written);
+        if (key) *key = root_key;
+        return written;
+    }
+
+    bool has_object_key(uint8_t version) {
+        return version >= 7;
+    }
+
+    std::array<uint8_t, 32> read_root_key(std::ifstream& ifs, const Node& root
+                                                            , uint8_t version) {
+        if (!has_object_key(version)) return root.hash;
+        std::array<uint8_t, 32> key{0};
+        ifs.read(reinterpret_cast<char*>(key.data()), key.size());
+        return key;
+    }
+
+    std::vector<std::unique_ptr<Node>> read_object(const fs::path& store_dir
+                                    , const std::array<uint8_t, 32>& key
+                                    , std::vector<std::array<uint8_t, 32>>* keys) {
+        fs::path obj = object_path(store_dir, key);
+        std::ifstream ifs(obj, std::ios::binary);
+        if (!ifs) {
+            throw std::runtime_error("Missing object: " + obj.string());
+        }
+
+        uint64_t magic = 0;
+        read(ifs, magic);
+        if (magic != OBJ_MAGIC && magic != OBJ_MAGIC_V3
+                        && magic != OBJ_MAGIC_V2 && magic != OBJ_MAGIC_V1) {
+            throw std::runtime_error("Invaild object format: " + obj.string());
+        }
+        // 旧格式对象分别与 version 6、5、4 快照的节点记录相同，且不含子目录对象键
+        uint8_t version = magic == OBJ_MAGIC? VERSION: magic == OBJ_MAGIC_V3? 6
+                        : magic == OBJ_MAGIC_V2? 5: 4;
+        bool with_keys = magic == OBJ_MAGIC;
+
+        uint32_t cnt = 0;
+        read(ifs, cnt);
+        std::vector<std::unique_ptr<Node>> children;
+        children.reserve(cnt);
+        if (keys) {
+            keys->clear();
+            keys->reserve(cnt);
+        }
+        for (uint32_t i = 0; i < cnt; ++i) {
+            auto child = std::make_unique<Node>();
+            read_node_info(ifs, *child, version);
+            std::array<uint8_t, 32> child_key = child->hash;
+            if (with_keys && has_object(*child)) {
+                ifs.read(reinterpret_cast<char*>(child_key.data()), child_key.size());
+            }
+            if (keys) keys->push_back(child_key);
+            children.push_back(std::move(child));
+        }
+        if (!ifs) {
+            throw std::runtime_error("Truncated object: " + obj.string());
+        }
+        return children;
+    }
+
+    void read_objects(Node& dir, const fs::path& store_dir
+                                    , const std::array<uint8_t, 32>& key) {
+        if (!has_object(dir)) return;
+
+        // 先读完当前对象再递归，避免深层目录同时打开过多文件
+        std::vector<std::array<uint8_t, 32>> keys;
+        dir.children = read_object(store_dir, key, &keys);
+        for (size_t i = 0; i < dir.children.size(); ++i) {
+            dir.children[i]->abs_root = dir.abs_root;
+            read_objects(*dir.children[i], store_dir, keys[i]);
+        }
+    }
+
+    void write_object_snapshot(const Node& root, int64_t ts
+                                            , const fs::path& output_dir) {
+        // 设置输出目录及文件
+        fs::create_directories(output_dir);
+        std::array<uint8_t, 32> key{0};
+        uint64_t written = write_objects(root, output_dir, &key);
+        std::cout << "Stored " << written << " new objects at: "
+                  << (output_dir / "objects").string() << std::endl;
+
+        fs::path output_file = output_dir / ("snap-" + std::to_string(ts) + ".bin");
+        std::ofstream ofs(output_file, std::ios::binary);
+        if (!ofs) {
+            throw std::runtime_error("Error opening output file: "
+                                            + output_file.string());
+        }
+
+        // 设置文件头，快照文件只保存根节点信息及根目录对象键
+        Header hdr;
+        hdr.kind = static_cast<uint8_t>(SnapKind::Object);
+        hdr.timestamp = ts;
+        hdr.root_offset = sizeof(Header);
+        hdr.root_hash = root.hash;
+        hdr.stats = tree_stats(root);
+
+        ofs.seekp(hdr.root_offset);
+        write_node_info(ofs, root);
+        ofs.write(reinterpret_cast<const char*>(key.data()), key.size());
+        hdr.data_size = static_cast<uint64_t>(ofs.tellp()) - hdr.root_offset;
+
+        ofs.seekp(0, std::ios::beg);
+        write(ofs, hdr);
+        ofs.close();
+
+        // 登记到快照目录，并生成路径与内容哈希过滤器及内容索引段
+        catalog_add(output_file, hdr);
+        save_filters(output_file.parent_path(), root);
+        save_index(output_file.parent_path(), root);
+    }
+
+    // @brief 辅助函数，标记目录节点及其子树引用的所有对象
+    // @param dir 目录节点
+    // @param key 目录的对象键
+    // @param store_dir 快照目录
+    // @param live 已标记对象集合（十六进制对象键）
+    static void mark_objects(const Node& dir, const std::array<uint8_t, 32>& key
+            , const fs::path& store_dir, std::unordered_set<std::string>& live) {
+        if (!has_object(dir)) return;
+        // 已标记过的对象，其子树也已标记
+        if (!live.insert(util::hash_to_hex(key)).second) return;
+
+        std::vector<std::array<uint8_t, 32>> keys;
+        auto children = read_object(store_dir, key, &keys);
+        for (size_t i = 0; i < children.size(); ++i) {
+            mark_objects(*children[i], keys[i], store_dir, live);
+        }
+    }
+
+    uint64_t gc_objects(const fs::path& store_dir) {
+        fs::path objects_dir = store_dir / "objects";
+        std::error_code ec;
+        if (!fs::exists(objects_dir, ec)) {
+            std::cout << "No object store at: " << store_dir.string() << std::endl;
+            return 0;
+        }
+
+        // 标记：从所有对象库快照的根节点出发，标记可达对象
+        std::unordered_set<std::string> live;
+        for (const auto& e: fs::directory_iterator(store_dir)) {
+            if (!util::is_snap_bin_file(e.path())) continue;
+
+            std::ifstream ifs(e.path(), std::ios::binary);
+            Header hdr;
+            if (!ifs || !read_header(ifs, hdr)) {
+                // 无法确认该快照引用了哪些对象时，放弃清理
+                std::cerr << "Unreadable snapshot, gc aborted: "
+                          << e.path().string() << std::endl;
+                return 0;
+            }
+            // 完整快照自身保存整棵目录树，不引用对象；增量快照中继承的子树
+            // 经由父快照文件读取，父快照若为对象库快照会在遍历到它时被标记
+            switch (static_cast<SnapKind>(hdr.kind)) {
+                case SnapKind::Full:
+                case SnapKind::Delta: continue;
+                case SnapKind::Object: break;
+                default:
+                    std::cerr << "Unknown snapshot kind " << int(hdr.kind)
+                              << ", gc aborted: " << e.path().string() << std::endl;
+                    return 0;
+            }
+
+            // 对象缺失或损坏时无法确认其子树引用了哪些对象，同样放弃清理
+            try {
+                Node root;
+                ifs.seekg(hdr.root_offset);
+                read_node_info(ifs, root, hdr.version);
+                auto key = read_root_key(ifs, root, hdr.version);
+                if (!ifs) {
+                    throw std::runtime_error("Truncated snapshot file: "
+                                                    + e.path().string());
+                }
+                mark_objects(root, key, store_dir, live);
+            }
+            catch (const std::exception& ex) {
+                std::cerr << "Broken snapshot " << e.path().string()
+                          << " (" << ex.what() << "), gc aborted" << std::endl;
+                return 0;
+            }
+        }
+
+        // 清除：删除未被标记的对象及残留的临时文件
+        std::vector<fs::path> garbage;
+        for (const auto& e: fs::recursive_directory_iterator(objects_dir)) {
+            if (!e.is_regular_file()) continue;
+            std::string hex = e.path().parent_path().filename().string()
+                            + e.path().filename().string();
+            if (!live.count(hex)) garbage.push_back(e.path());
+        }
+
+        uint64_t removed = 0;
+        for (const auto& p: garbage) {
+            if (fs::remove(p, ec)) ++removed;
+            else std::cerr << "Failed to remove: " << p << std::endl;
+        }
+
+        // 删除空的扇出目录
+        for (const auto& e: fs::directory_iterator(objects_dir)) {
+            if (e.is_directory() && fs::is_empty(e.path(), ec)) {
+                fs::remove(e.path(), ec);
+            }
+        }
+
+        std::cout << "Removed " << removed << " unreferenced objects, "
+                  << live.size() << " objects in use." << std::endl;
+        return removed;
+    }
+}
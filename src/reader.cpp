@@ -0,0 +1,285 @@
+/*
+ * @file    src/reader.cpp
+ * @brief   This source file implements the lazy, path directed snapshot reader.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <algorithm>
+#include "dirhist/reader.h"
+#include "dirhist/delta.h"
+#include "dirhist/objstore.h"
+#include "internal/record.h"
+
+namespace dirhist {
+    // @brief 辅助函数，复制节点自身信息（不含子节点）
+    static Node copy_info(const Node& src) {
+        Node node;
+        node.path = src.path;
+        node.abs_root = src.abs_root;
+        node.is_dir = src.is_dir;
+        node.is_symlink = src.is_symlink;
+        node.size = src.size;
+        node.mtime = src.mtime;
+        node.hash = src.hash;
+        node.content_hash = src.content_hash;
+        node.max_mtime = src.max_mtime;
+        node.max_file_size = src.max_file_size;
+        node.file_cnt = src.file_cnt;
+        return node;
+    }
+
+    SnapReader::SnapReader(const fs::path& snapshot): path_(snapshot) {
+        std::ifstream ifs(snapshot, std::ios::binary);
+        if (!ifs) {
+            throw std::runtime_error("Error opening input file: " + snapshot.string());
+        }
+        if (!read_header(ifs, hdr_)) {
+            throw std::runtime_error("Invaild snapshot format: " + snapshot.string());
+        }
+
+        root_.reader = this;
+        root_.offset = hdr_.root_offset;
+        // 对象库快照文件内仅有根节点信息，没有子节点数量与偏移表
+        if (hdr_.kind == static_cast<uint8_t>(SnapKind::Object)) {
+            ifs.seekg(hdr_.root_offset);
+            read_node_info(ifs, root_.info, hdr_.version);
+            root_.key = read_root_key(ifs, root_.info, hdr_.version);
+            if (!ifs) {
+                throw std::runtime_error("Truncated snapshot file: " + snapshot.string());
+            }
+            return;
+        }
+
+        file_ = std::make_unique<SnapFile>(snapshot);
+        std::vector<uint64_t> offsets;
+        read_record(*file_, hdr_.root_offset, root_.info, offsets, hdr_.version);
+    }
+
+    SnapReader::~SnapReader() = default;
+
+    NodeRef SnapReader::base_of(const NodeRef& dir) const {
+        if (!parent_) {
+            fs::path parent = path_.parent_path()
+                            / ("snap-" + std::to_string(hdr_.parent_ts) + ".bin");
+            parent_ = std::make_unique<SnapReader>(parent);
+        }
+        auto base = parent_->lookup(dir.info.path);
+        if (!base || !base->info.is_dir || base->info.is_symlink) {
+            throw std::runtime_error("Corrupted delta snapshot, missing base for: "
+                                                                + dir.info.path);
+        }
+        return std::move(*base);
+    }
+
+    NodeRef SnapReader::inherited(const NodeRef& dir) const {
+        NodeRef base = base_of(dir);
+        if (base.info.hash != dir.info.hash
+                || (inherit_checks_info(hdr_.version) && !same_node_info(base.info, dir.info))) {
+            throw std::runtime_error("Corrupted delta snapshot, missing base for: "
+                                                                + dir.info.path);
+        }
+        return base;
+    }
+
+    std::vector<NodeRef> SnapReader::children(const NodeRef& dir) const {
+        std::vector<NodeRef> res;
+        if (!dir.info.is_dir || dir.info.is_symlink) return res;
+        if (dir.reader != this) return dir.reader->children(dir);
+
+        if (!file_) {
+            std::vector<std::array<uint8_t, 32>> keys;
+            auto nodes = read_object(path_.parent_path(), dir.key, &keys);
+            res.reserve(nodes.size());
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                NodeRef ref;
+                ref.info = std::move(*nodes[i]);
+                ref.info.abs_root = dir.info.abs_root;
+                ref.reader = this;
+                ref.key = keys[i];
+                res.push_back(std::move(ref));
+            }
+            return res;
+        }
+
+        Node tmp;
+        std::vector<uint64_t> offsets;
+        uint32_t cnt = read_record(*file_, dir.offset, tmp, offsets, hdr_.version);
+        if (cnt == INHERIT) return children(inherited(dir));
+        res.reserve(offsets.size());
+        std::vector<uint64_t> tmp_offsets;
+        std::vector<NodeRef> base_children;     // 按区间继承的子节点位于父快照中
+        if (cnt == INHERIT_RUNS) base_children = children(base_of(dir));
+        for (uint64_t off: offsets) {
+            if (cnt == INHERIT_RUNS && (off & RUN_FLAG)) {
+                uint64_t start = run_start(off);
+                uint64_t end = start + run_len(off);
+                if (end > base_children.size()) {
+                    throw std::runtime_error("Corrupted delta snapshot, missing base for: "
+                                                                    + dir.info.path);
+                }
+                for (uint64_t t = start; t < end; ++t) {
+                    res.push_back(std::move(base_children[t]));
+                }
+                continue;
+            }
+            if (off == 0) continue;
+            NodeRef ref;
+            ref.reader = this;
+            ref.offset = off;
+            read_record(*file_, off, ref.info, tmp_offsets, hdr_.version);
+            res.push_back(std::move(ref));
+        }
+        return res;
+    }
+
+    std::optional<NodeRef> SnapReader::child(const NodeRef& dir
+                                            , const std::string& path) const {
+        if (!dir.info.is_dir || dir.info.is_symlink) return std::nullopt;
+        if (dir.reader != this) return dir.reader->child(dir, path);
+
+        // 对象需整体读取，读入后在内存中查找
+        if (!file_) {
+            auto res = children(dir);
+            auto it = std::lower_bound(res.begin(), res.end(), path
+                        , [](const NodeRef& ref, const std::string& p)
+                            {return ref.info.path < p;});
+            if (it == res.end() || it->info.path != path) return std::nullopt;
+            return std::move(*it);
+        }
+
+        Node tmp;
+        std::vector<uint64_t> offsets;
+        uint32_t cnt = read_record(*file_, dir.offset, tmp, offsets, hdr_.version);
+        if (cnt == INHERIT) return child(inherited(dir), path);
+        // 含继承区间的目录读入全部子节点后查找
+        if (cnt == INHERIT_RUNS) {
+            auto res = children(dir);
+            auto it = std::lower_bound(res.begin(), res.end(), path
+                        , [](const NodeRef& ref, const std::string& p)
+                            {return ref.info.path < p;});
+            if (it == res.end() || it->info.path != path) return std::nullopt;
+            return std::move(*it);
+        }
+        offsets.erase(std::remove(offsets.begin(), offsets.end(), 0), offsets.end());
+
+        // 子节点记录按路径字典序排列，每次比较只读取一条记录
+        size_t lo = 0, hi = offsets.size();
+        std::vector<uint64_t> child_offsets;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            NodeRef ref;
+            read_record(*file_, offsets[mid], ref.info, child_offsets, hdr_.version);
+            if (ref.info.path == path) {
+                ref.reader = this;
+                ref.offset = offsets[mid];
+                return ref;
+            }
+            if (ref.info.path < path) lo = mid + 1;
+            else hi = mid;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<NodeRef> SnapReader::lookup(const std::string& path) const {
+        NodeRef cur{copy_info(root_.info), root_.reader, root_.offset, root_.key};
+        for (const auto& prefix: path_prefixes(path)) {
+            auto next = child(cur, prefix);
+            if (!next) return std::nullopt;
+            cur = std::move(*next);
+        }
+        return cur;
+    }
+
+    std::vector<std::optional<NodeRef>> SnapReader::lookup(
+                                    const std::vector<std::string>& paths) const {
+        std::vector<std::vector<std::string>> prefixes;
+        prefixes.reserve(paths.size());
+        for (const auto& p: paths) prefixes.push_back(path_prefixes(p));
+        std::vector<size_t> order(paths.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                                            {return prefixes[a] < prefixes[b];});
+
+        // levels[k] 为上一路径第 k 层的节点，levels[0] 为根节点
+        std::vector<NodeRef> levels;
+        levels.push_back(NodeRef{copy_info(root_.info), root_.reader, root_.offset, root_.key});
+        std::vector<std::optional<NodeRef>> res(paths.size());
+        for (size_t idx: order) {
+            const auto& pre = prefixes[idx];
+            size_t common = 0;
+            while (common + 1 < levels.size() && common < pre.size()
+                        && levels[common + 1].info.path == pre[common]) ++common;
+            levels.resize(common + 1);
+
+            bool found = true;
+            for (size_t k = common; k < pre.size(); ++k) {
+                auto next = child(levels.back(), pre[k]);
+                if (!next) {
+                    found = false;
+                    break;
+                }
+                levels.push_back(std::move(*next));
+            }
+            if (found) {
+                const NodeRef& ref = levels.back();
+                res[idx] = NodeRef{copy_info(ref.info), ref.reader, ref.offset, ref.key};
+            }
+        }
+        return res;
+    }
+
+    std::unique_ptr<Node> SnapReader::load(const NodeRef& ref, int max_depth
+                    , const std::function<bool(const Node&)>& keep) const {
+        auto node = std::make_unique<Node>(copy_info(ref.info));
+        if (max_depth == 0) return node;
+        for (const auto& child: children(ref)) {
+            if (keep && !keep(child.info)) continue;
+            node->children.push_back(load(child, max_depth < 0? -1: max_depth - 1, keep));
+        }
+        return node;
+    }
+
+    // @brief 辅助函数，按需读取子节点并比较两个节点
+    static void diff_refs(const NodeRef& old_ref, const NodeRef& new_ref, DiffSink& sink) {
+        const Node& old_info = old_ref.info;
+        const Node& new_info = new_ref.info;
+        if (old_info.hash == new_info.hash) return;
+
+        // 叶子节点或类型变化的节点读入后交给 diff_nodes，保证输出一致
+        bool old_dir = old_info.is_dir && !old_info.is_symlink;
+        bool new_dir = new_info.is_dir && !new_info.is_symlink;
+        if (!old_dir || !new_dir) {
+            diff_nodes(*old_ref.reader->load(old_ref), *new_ref.reader->load(new_ref), sink);
+            return;
+        }
+
+        std::vector<NodeRef> old_children = old_ref.reader->children(old_ref);
+        std::vector<NodeRef> new_children = new_ref.reader->children(new_ref);
+        size_t i = 0, j = 0;
+        while (i < old_children.size() || j < new_children.size()) {
+            if (i < old_children.size() && (j == new_children.size()
+                    || old_children[i].info.path < new_children[j].info.path)) {
+                const NodeRef& ref = old_children[i++];
+                mark_subtree(*ref.reader->load(ref), ChangeType::Deleted, sink);
+            }
+            else if (j < new_children.size() && (i == old_children.size()
+                    || new_children[j].info.path < old_children[i].info.path)) {
+                const NodeRef& ref = new_children[j++];
+                mark_subtree(*ref.reader->load(ref), ChangeType::Added, sink);
+            }
+            else diff_refs(old_children[i++], new_children[j++], sink);
+        }
+    }
+
+    void diff_paths(const SnapReader& old_reader, const SnapReader& new_reader
+                    , const std::vector<std::string>& paths, DiffSink& sink) {
+        for (const auto& scope: normalize_scopes(paths)) {
+            auto old_ref = old_reader.lookup(scope);
+            auto new_ref = new_reader.lookup(scope);
+            if (old_ref && new_ref) diff_refs(*old_ref, *new_ref, sink);
+            else if (old_ref) mark_subtree(*old_reader.load(*old_ref), ChangeType::Deleted, sink);
+            else if (new_ref) mark_subtree(*new_reader.load(*new_ref), ChangeType::Added, sink);
+        }
+    }
+}
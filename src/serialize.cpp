@@ -5,24 +5,320 @@
  * @date    2025-07-28
  */
 
+#include <cstddef>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "dirhist/serialize.h"
+#include "dirhist/objstore.h"
+#include "dirhist/delta.h"
+#include "dirhist/bloom.h"
+#include "dirhist/catalog.h"
+#include "dirhist/index.h"
 #include "internal/util.h"
+#include "internal/record.h"
+#include "internal/thread_pool.h"
 
 namespace dirhist {
-    void write_node(std::ofstream& ofs, const Node& node, uint64_t& offset) {
-        // 先将文件指针移动到 offset 处
-        ofs.seekp(offset);
+    // 子树数据量不小于该值时派发到线程池并行读取
+    constexpr uint64_t PARALLEL_READ_BYTES = 256 * 1024;
 
-        // 写入节点基本信息
+    SnapFile::SnapFile(const fs::path& path): path_(path) {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::runtime_error("Error opening input file: " + path.string());
+        }
+        struct stat st{};
+        if (::fstat(fd_, &st) == 0) size_ = static_cast<uint64_t>(st.st_size);
+    }
+
+    SnapFile::~SnapFile() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    size_t SnapFile::read_at(void* buf, size_t n, uint64_t offset) const {
+        size_t done = 0;
+        while (done < n) {
+            ssize_t r = ::pread(fd_, static_cast<char*>(buf) + done, n - done
+                                            , static_cast<off_t>(offset + done));
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("Error reading file: " + path_.string());
+            }
+            if (r == 0) break;  // 文件末尾
+            done += static_cast<size_t>(r);
+        }
+        return done;
+    }
+
+    // @brief 辅助函数，按记录格式（见 write_node）解析节点记录
+    // @param take 依次取出 n 字节的函数
+    template<typename Take>
+    static uint32_t parse_record(Take&& take, Node& node
+                    , std::vector<uint64_t>& child_offsets, uint8_t version) {
+        uint32_t len = 0;
+        take(&len, sizeof(len));
+        node.path.resize(len);
+        take(node.path.data(), len);
+        take(&len, sizeof(len));
+        node.abs_root.resize(len);
+        take(node.abs_root.data(), len);
+
+        uint8_t flag = 0;
+        take(&flag, sizeof(flag)); node.is_dir = flag != 0;
+        take(&flag, sizeof(flag)); node.is_symlink = flag != 0;
+        take(&node.size, sizeof(node.size));
+        take(&node.mtime, sizeof(node.mtime));
+        take(node.hash.data(), node.hash.size());
+        if (has_content_hash(version)) take(node.content_hash.data(), node.content_hash.size());
+        if (has_aggregates(version)) {
+            take(&node.max_mtime, sizeof(node.max_mtime));
+            take(&node.max_file_size, sizeof(node.max_file_size));
+            take(&node.file_cnt, sizeof(node.file_cnt));
+        }
+        else upgrade_node_info(node, version);
+
+        uint32_t cnt = 0;
+        take(&cnt, sizeof(cnt));
+        child_offsets.clear();
+        if (cnt == INHERIT_RUNS) {
+            uint32_t entries = 0;
+            take(&entries, sizeof(entries));
+            child_offsets.resize(entries);
+            take(child_offsets.data(), entries * sizeof(uint64_t));
+        }
+        else if (cnt != INHERIT && cnt > 0) {
+            child_offsets.resize(cnt);
+            take(child_offsets.data(), cnt * sizeof(uint64_t));
+        }
+        return cnt;
+    }
+
+    uint32_t read_record(const SnapFile& file, uint64_t offset, Node& node
+                        , std::vector<uint64_t>& child_offsets, uint8_t version) {
+        // 大多数记录小于一个块，先整块读入，不足时再补读
+        constexpr size_t BLOCK = 4096;
+        thread_local std::vector<char> buf;
+        if (buf.size() < BLOCK) buf.resize(BLOCK);
+
+        size_t got = file.read_at(buf.data(), BLOCK, offset);
+        size_t pos = 0;
+        auto take = [&](void* dst, size_t n) {
+            if (pos + n > got) {
+                if (pos + n > buf.size()) buf.resize(pos + n);
+                got += file.read_at(buf.data() + got, pos + n - got, offset + got);
+                if (pos + n > got) {
+                    throw std::runtime_error("Truncated snapshot file: "
+                                                        + file.path().string());
+                }
+            }
+            std::memcpy(dst, buf.data() + pos, n);
+            pos += n;
+        };
+        return parse_record(take, node, child_offsets, version);
+    }
+
+    // @brief 顺序读取窗口
+    // @note 完整快照按 dfs 顺序写入，读取一棵子树时记录偏移单调递增，
+    //       以窗口为单位大块 pread，避免每条记录（约 150 字节）一次系统调用
+    struct ReadWindow {
+        std::vector<char> buf;
+        uint64_t start = 0;     // 窗口对应的文件偏移
+        size_t len = 0;         // 窗口内有效字节数
+        uint64_t limit = 0;     // 预读上限，即所属子树的数据末尾
+    };
+
+    // @brief 辅助函数，经由读取窗口读取 offset 处的节点记录
+    static uint32_t read_record(const SnapFile& file, ReadWindow& win, uint64_t offset
+            , Node& node, std::vector<uint64_t>& child_offsets, uint8_t version) {
+        uint64_t pos = offset;
+        auto take = [&](void* dst, size_t n) {
+            if (pos < win.start || pos + n > win.start + win.len) {
+                // 记录跨越窗口末尾时从当前位置重新填充，至多预读到子树末尾
+                size_t want = std::max<uint64_t>(n, std::min<uint64_t>(
+                                    PARALLEL_READ_BYTES, win.limit > pos? win.limit - pos: 0));
+                if (win.buf.size() < want) win.buf.resize(want);
+                win.start = pos;
+                win.len = file.read_at(win.buf.data(), want, pos);
+                if (win.len < n) {
+                    throw std::runtime_error("Truncated snapshot file: "
+                                                        + file.path().string());
+                }
+            }
+            std::memcpy(dst, win.buf.data() + (pos - win.start), n);
+            pos += n;
+        };
+        return parse_record(take, node, child_offsets, version);
+    }
+
+    // @brief 辅助函数，基于 pread 并行读取 [offset, end) 范围内的子树
+    // @param file 快照文件
+    // @param win 当前任务的读取窗口，派发到线程池的子树使用各自的窗口
+    // @param offset 子树根节点偏移
+    // @param end 子树数据末尾，用于估计子树大小
+    // @param version 快照文件版本号
+    // @return 返回读取到的节点指针
+    // @note 完整快照按 dfs 顺序写入，相邻子节点偏移之差即为前一子树的数据量
+    static std::unique_ptr<Node> read_tree(const SnapFile& file, ReadWindow& win
+                            , uint64_t offset, uint64_t end, uint8_t version) {
+        auto node = std::make_unique<Node>();
+        std::vector<uint64_t> offsets;
+        read_record(file, win, offset, *node, offsets, version);
+        offsets.erase(std::remove(offsets.begin(), offsets.end(), 0), offsets.end());
+        if (offsets.empty()) return node;
+
+        // 子节点位置预先确定，各任务直接写入对应槽位，无需加锁；
+        // 线程池没有工作线程时派发无意义，所有子树沿同一窗口顺序读取
+        node->children.resize(offsets.size());
+        util::TaskGroup group;
+        bool parallel = util::ThreadPool::instance().workers() > 0;
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            uint64_t child_end = i + 1 < offsets.size()? offsets[i+1]: end;
+            uint64_t span = child_end > offsets[i]? child_end - offsets[i]: 0;
+            Node* parent = node.get();
+            uint64_t child_offset = offsets[i];
+            if (parallel && span >= PARALLEL_READ_BYTES) {
+                group.run([&file, parent, i, child_offset, child_end, version]{
+                    ReadWindow child_win;
+                    child_win.limit = child_end;
+                    parent->children[i] = read_tree(file, child_win, child_offset
+                                                        , child_end, version);
+                });
+            }
+            else parent->children[i] = read_tree(file, win, child_offset, child_end, version);
+        }
+        group.wait();
+        return node;
+    }
+
+    size_t header_size(uint8_t version) {
+        switch (version) {
+            case 1: return offsetof(Header, kind);
+            case 2: return offsetof(Header, parent_ts);
+            case 3: return offsetof(Header, stats);
+            case 4:
+            case 5:
+            case 6:
+            case 7:
+            case 8: return sizeof(Header);
+            default: return 0;
+        }
+    }
+
+    bool read_header(std::ifstream& ifs, Header& hdr) {
+        // 各版本文件头均以 version 1 文件头为前缀，先读取公共部分
+        hdr = Header{};
+        ifs.read(reinterpret_cast<char*>(&hdr), header_size(1));
+        if (!ifs || hdr.magic != MAGIC || hdr.version == 0 
+                                        || hdr.version > VERSION) return false;
+
+        if (hdr.version > 1) {
+            ifs.read(reinterpret_cast<char*>(&hdr) + header_size(1)
+                            , header_size(hdr.version) - header_size(1));
+            return static_cast<bool>(ifs);
+        }
+
+        // version 1 文件头没有根哈希，从根节点记录中补齐
+        Node root;
+        ifs.seekg(hdr.root_offset);
+        read_node_info(ifs, root, hdr.version);
+        hdr.root_hash = root.hash;
+        return static_cast<bool>(ifs);
+    }
+
+    bool has_stats(const Header& hdr) {
+        return hdr.version >= 4;
+    }
+
+    Header read_snapshot_header(const fs::path& snapshot) {
+        std::ifstream ifs(snapshot, std::ios::binary);
+        if (!ifs) {
+            throw std::runtime_error("Error opening input file: "
+                                                + snapshot.string());
+        }
+        Header hdr;
+        if (!read_header(ifs, hdr)) {
+            throw std::runtime_error("Invaild snapshot format: " + snapshot.string());
+        }
+        return hdr;
+    }
+
+    void write_node_info(std::ostream& ofs, const Node& node, bool with_abs_root) {
         write(ofs, static_cast<uint32_t>(node.path.size()));
         ofs.write(node.path.data(), node.path.size());
-        write(ofs, static_cast<uint32_t>(node.abs_root.size()));
-        ofs.write(node.abs_root.data(), node.abs_root.size());
+        if (with_abs_root) {
+            write(ofs, static_cast<uint32_t>(node.abs_root.size()));
+            ofs.write(node.abs_root.data(), node.abs_root.size());
+        }
+        else write(ofs, uint32_t(0));
         write(ofs, uint8_t(node.is_dir));
         write(ofs, uint8_t(node.is_symlink));
         write(ofs, node.size);
         write(ofs, node.mtime);
         ofs.write(reinterpret_cast<const char*>(node.hash.data()), node.hash.size());
+        ofs.write(reinterpret_cast<const char*>(node.content_hash.data())
+                                                , node.content_hash.size());
+        write(ofs, node.max_mtime);
+        write(ofs, node.max_file_size);
+        write(ofs, node.file_cnt);
+    }
+
+    bool has_content_hash(uint8_t version) {
+        return version >= 5;
+    }
+
+    bool has_aggregates(uint8_t version) {
+        return version >= 6;
+    }
+
+    void upgrade_node_info(Node& node, uint8_t version) {
+        if (has_aggregates(version)) return;
+        node.mtime = util::file_ticks_ms(node.mtime);
+        if (node.is_dir && !node.is_symlink) {
+            node.max_mtime = UNKNOWN_MTIME;
+            node.max_file_size = UNKNOWN_SIZE;
+            node.file_cnt = UNKNOWN_COUNT;
+        }
+        else set_leaf_aggregates(node);
+    }
+
+    void read_node_info(std::ifstream& ifs, Node& node, uint8_t version) {
+        uint32_t len = 0;
+        read(ifs, len);
+        node.path.resize(len);
+        ifs.read(node.path.data(), len);
+
+        read(ifs, len);
+        node.abs_root.resize(len);
+        ifs.read(node.abs_root.data(), len);
+
+        uint8_t flag = 0;
+        read(ifs, flag); node.is_dir = flag != 0;
+        read(ifs, flag); node.is_symlink = flag != 0;
+
+        read(ifs, node.size);
+        read(ifs, node.mtime);
+        ifs.read(reinterpret_cast<char*>(node.hash.data()), 32);
+        if (has_content_hash(version)) {
+            ifs.read(reinterpret_cast<char*>(node.content_hash.data()), 32);
+        }
+        if (has_aggregates(version)) {
+            read(ifs, node.max_mtime);
+            read(ifs, node.max_file_size);
+            read(ifs, node.file_cnt);
+        }
+        else upgrade_node_info(node, version);
+    }
+
+    void write_node(std::ofstream& ofs, const Node& node, uint64_t& offset) {
+        // 先将文件指针移动到 offset 处
+        ofs.seekp(offset);
+
+        // 写入节点基本信息
+        write_node_info(ofs, node);
 
         // 处理子节点
         write(ofs, static_cast<uint32_t>(node.children.size()));
@@ -47,30 +343,17 @@ namespace dirhist {
             write(ofs, child_offset);
         }
         ofs.seekp(back, std::ios::beg);  // 回到之前的位置
+        offset = back;  // 返回时 offset 指向子树数据末尾
     }
 
-    std::unique_ptr<Node> read_node(std::ifstream& ifs, uint64_t& offset) {
+    std::unique_ptr<Node> read_node(std::ifstream& ifs, uint64_t& offset
+                                                            , uint8_t version) {
         ifs.seekg(offset);
 
         auto node = std::make_unique<Node>();
 
         // 读节点头部
-        uint32_t len;
-        read(ifs, len);
-        node->path.resize(len);
-        ifs.read(node->path.data(), len);
-
-        read(ifs, len);
-        node->abs_root.resize(len);
-        ifs.read(node->abs_root.data(), len);
-
-        uint8_t flag;
-        read(ifs, flag); node->is_dir = flag != 0;
-        read(ifs, flag); node->is_symlink = flag != 0;
-
-        read(ifs, node->size);
-        read(ifs, node->mtime);
-        ifs.read(reinterpret_cast<char*>(node->hash.data()), 32);
+        read_node_info(ifs, *node, version);
 
         // 读子节点偏移量
         uint32_t cnt;
@@ -86,7 +369,7 @@ namespace dirhist {
         node->children.reserve(cnt);
         for (uint64_t child_offset : offsets) {
             if (child_offset != 0)
-                node->children.emplace_back(read_node(ifs, child_offset));
+                node->children.emplace_back(read_node(ifs, child_offset, version));
         }
         return node;
     }
@@ -107,6 +390,8 @@ namespace dirhist {
         Header hdr;
         hdr.timestamp = ts;
         hdr.root_offset = sizeof(Header);
+        hdr.root_hash = root.hash;
+        hdr.stats = tree_stats(root);
 
         uint64_t offset = hdr.root_offset;
         write_node(ofs, root, offset);
@@ -115,27 +400,18 @@ namespace dirhist {
         ofs.seekp(0, std::ios::beg);
         // 写入文件头
         write(ofs, hdr);
+        ofs.close();
+
+        // 登记到快照目录，并生成路径与内容哈希过滤器及内容索引段
+        catalog_add(output_file, hdr);
+        save_filters(output_file.parent_path(), root);
+        save_index(output_file.parent_path(), root);
     }
 
     std::unique_ptr<Node> read_snapshot(int64_t ts, const fs::path& input_dir){
         // 设置输入文件路径
         fs::path input_file = input_dir / ("snap-" + std::to_string(ts) + ".bin");
-        std::ifstream ifs(input_file, std::ios::binary);
-        if (!ifs){
-            throw std::runtime_error("Error opening input file: " 
-                                                + input_file.string());
-        }
-        
-        // 读取文件头，并作格式检查
-        Header hdr;
-        read(ifs, hdr);
-        if (hdr.magic != MAGIC || hdr.version != VERSION){
-            std::cerr << "Header.magic: " << hdr.magic << std::endl
-                      << "Header.version: " << hdr.version << std::endl;
-            throw std::runtime_error("Invaild snapshot format");
-        }
-        
-        return read_node(ifs, hdr.root_offset);
+        return read_snapshot(input_file);
     }
 
     std::unique_ptr<Node> read_snapshot(const fs::path& snapshot) {
@@ -147,14 +423,36 @@ namespace dirhist {
         
         // 读取文件头，并作格式检查
         Header hdr;
-        read(ifs, hdr);
-        if (hdr.magic != MAGIC || hdr.version != VERSION){
+        if (!read_header(ifs, hdr)){
             std::cerr << "Header.magic: " << hdr.magic << std::endl
-                      << "Header.version: " << hdr.version << std::endl;
+                      << "Header.version: " << int(hdr.version) << std::endl;
             throw std::runtime_error("Invaild snapshot format");
         }
+
+        // 对象库快照：文件内仅有根节点，目录内容从对象库中读取
+        if (hdr.kind == static_cast<uint8_t>(SnapKind::Object)) {
+            auto root = std::make_unique<Node>();
+            ifs.seekg(hdr.root_offset);
+            read_node_info(ifs, *root, hdr.version);
+            auto key = read_root_key(ifs, *root, hdr.version);
+            if (!ifs) {
+                throw std::runtime_error("Truncated snapshot file: " + snapshot.string());
+            }
+            read_objects(*root, snapshot.parent_path(), key);
+            return root;
+        }
+
+        // 增量快照：先读取父快照，再将增量覆盖其上
+        if (hdr.kind == static_cast<uint8_t>(SnapKind::Delta)) {
+            return read_delta(ifs, hdr, snapshot.parent_path());
+        }
         
-        return read_node(ifs, hdr.root_offset);
+        // 完整快照：按子节点偏移表并行读取
+        ifs.close();
+        SnapFile file(snapshot);
+        ReadWindow win;
+        win.limit = file.size();
+        return read_tree(file, win, hdr.root_offset, file.size(), hdr.version);
     }
 
     void clean_snapshots(const fs::path& target_dir){
@@ -176,6 +474,33 @@ namespace dirhist {
                 }
             }
         }
+
+        // 快照全部清空后，快照目录文件、对象库与各类缓存均不再有效
+        if (std::filesystem::exists(catalog_path(target_dir), ec)) {
+            std::filesystem::remove(catalog_path(target_dir), ec);
+            if (!ec) std::cout << "Removed: " << catalog_path(target_dir).filename() << '\n';
+            else std::cerr << "Failed to remove: " << catalog_path(target_dir) << '\n';
+        }
+        if (std::filesystem::exists(target_dir / "objects", ec)) {
+            std::filesystem::remove_all(target_dir / "objects", ec);
+            if (!ec) std::cout << "Removed: \"objects\"" << '\n';
+            else std::cerr << "Failed to remove: " << target_dir / "objects" << '\n';
+        }
+        if (std::filesystem::exists(target_dir / "diffcache", ec)) {
+            std::filesystem::remove_all(target_dir / "diffcache", ec);
+            if (!ec) std::cout << "Removed: \"diffcache\"" << '\n';
+            else std::cerr << "Failed to remove: " << target_dir / "diffcache" << '\n';
+        }
+        if (std::filesystem::exists(target_dir / "bloom", ec)) {
+            std::filesystem::remove_all(target_dir / "bloom", ec);
+            if (!ec) std::cout << "Removed: \"bloom\"" << '\n';
+            else std::cerr << "Failed to remove: " << target_dir / "bloom" << '\n';
+        }
+        if (std::filesystem::exists(target_dir / "index", ec)) {
+            std::filesystem::remove_all(target_dir / "index", ec);
+            if (!ec) std::cout << "Removed: \"index\"" << '\n';
+            else std::cerr << "Failed to remove: " << target_dir / "index" << '\n';
+        }
         std::cout << "Clean done." << std::endl;
     }
 }
\ No newline at end of file
@@ -7,13 +7,33 @@
 
 #include "dirhist/snapshot.h"
 #include "internal/util.h"
+#include "internal/tree_printer.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
 
 namespace dirhist {
+    // 文件分块读取的块大小
+    constexpr size_t HASH_BLOCK = 64 * 1024;
+
+    bool has_content_hash(const Node& node){
+        return node.content_hash != std::array<uint8_t, 32>{0};
+    }
+
+    void set_leaf_aggregates(Node& node){
+        node.max_mtime = node.mtime;
+        node.max_file_size = node.size;
+        node.file_cnt = 1;
+    }
+
+    // @brief 辅助函数，判断文件能否沿用先前节点的哈希值
+    static bool unchanged_file(const Node& node, const Node* prev){
+        return prev && !prev->is_dir && !prev->is_symlink
+                    && prev->size == node.size && prev->mtime == node.mtime;
+    }
+
     std::unique_ptr<Node>
-        walk_dir(const fs::path& current_path, const fs::path& root){
+        walk_dir(const fs::path& current_path, const fs::path& root, const Node* prev){
         // 设置当前节点
         // 不直接使用 is_symlink()来判断是否为符号链接
         fs::file_status st = fs::symlink_status(current_path);
@@ -25,8 +45,7 @@ namespace dirhist {
 
         // 针对符号链接，需要确保目标存在才能获取最后修改时间
         try {
-            current_node->mtime = fs::last_write_time(current_path)
-                                                .time_since_epoch().count();
+            current_node->mtime = util::file_time_ms(fs::last_write_time(current_path));
         }
         catch (const fs::filesystem_error& e){
             std::cerr << "Error getting last write time: " << e.what() 
@@ -55,15 +74,31 @@ namespace dirhist {
             
             // 目录节点的哈希值设置为SHA256(path+'\0'+所有子节点哈希按路径字典序拼接)
             std::string data = current_node->path + '\0';
+            // 内容哈希只包含子节点名称、类型与内容哈希，目录移动后保持不变
+            std::string content;
             uint64_t total_size = 0;
+            current_node->max_mtime = current_node->mtime;
             for (const auto& entry: entries){
                 // 递归处理其子节点，同时计算子节点大小之和作目录节点大小
-                std::unique_ptr<Node> child_node = walk_dir(entry.path(), root);
+                const Node* child_prev = nullptr;
+                if (prev && prev->is_dir && !prev->is_symlink){
+                    child_prev = find_child(*prev
+                            , entry.path().lexically_relative(root).string());
+                }
+                std::unique_ptr<Node> child_node = walk_dir(entry.path(), root, child_prev);
                 if (child_node) {
                     // 将子节点的哈希值拼接到当前节点数据中
                     data += util::hash_to_str(child_node->hash);
-                    // 累加子节点大小
+                    content += entry.path().filename().string() + '\0';
+                    content += child_node->is_symlink? 'l': child_node->is_dir? 'd': 'f';
+                    content += util::hash_to_str(child_node->content_hash);
+                    // 累加子节点大小，并汇总子树聚合信息
                     total_size += child_node->size;
+                    current_node->max_mtime = std::max(current_node->max_mtime
+                                                        , child_node->max_mtime);
+                    current_node->max_file_size = std::max(current_node->max_file_size
+                                                        , child_node->max_file_size);
+                    current_node->file_cnt += child_node->file_cnt;
                     // 将子节点添加到当前节点的子节点列表中
                     current_node->children.push_back(std::move(child_node));
                 }
@@ -71,6 +106,7 @@ namespace dirhist {
             // 设置节点大小为所有子节点大小之和，并计算哈希值
             current_node->size = total_size;
             current_node->hash = util::sha256(data);
+            current_node->content_hash = util::sha256(content);
         }
         // 处理符号链接（叶子节点）
         else if (current_node->is_symlink){
@@ -78,7 +114,10 @@ namespace dirhist {
                 // 将链接目标作为文件内容
                 std::string target_path = fs::read_symlink(current_path).string();
                 current_node->size = target_path.size();
+                set_leaf_aggregates(*current_node);
                 current_node->hash = util::sha256(current_node->path + '\0' + target_path);
+                current_node->content_hash 
+                        = util::sha256(std::string("\0symlink\0", 9) + target_path);
             } catch (const fs::filesystem_error& e) {
                 std::cerr << "Error reading symlink: "
                           << e.what()<< "for path: "<< current_path << std::endl;
@@ -88,98 +127,209 @@ namespace dirhist {
         // 处理文件节点（叶子节点）
         else {
             current_node->size = fs::file_size(current_path);
+            set_leaf_aggregates(*current_node);
+            // 大小与修改时间均未变化，信任先前的哈希值
+            if (unchanged_file(*current_node, prev)){
+                current_node->hash = prev->hash;
+                current_node->content_hash = prev->content_hash;
+                return current_node;
+            }
             // 若为文件节点（或符号链接），直接计算其SHA256哈希值
             std::ifstream file(current_path, std::ios::binary);
             if (!file){
                 std::cerr << "Error opening file: "<< current_path << std::endl;
                 return nullptr;
             }
-            // 这里采用一次性读入文件内容方式，后续可以针对大文件优化为分块计算的方式
-            std::stringstream ss;
-            ss << file.rdbuf();
-            // 设置当前节点哈希值
-            // 计算方式为 SHA256(path+‘\0’+raw_bytes)
-            current_node->hash 
-                    = util::sha256(current_node->path + '\0' + std::move(ss).str());
+            // 分块读取文件内容，一次读取同时计算两个哈希值
+            // hash 计算方式为 SHA256(path+‘\0’+raw_bytes)，content_hash 为 SHA256(raw_bytes)
+            util::Sha256 path_ctx, content_ctx;
+            path_ctx.update(current_node->path.data(), current_node->path.size());
+            path_ctx.update("\0", 1);
+            std::vector<char> block(HASH_BLOCK);
+            while (file) {
+                file.read(block.data(), block.size());
+                size_t got = static_cast<size_t>(file.gcount());
+                if (got == 0) break;
+                path_ctx.update(block.data(), got);
+                content_ctx.update(block.data(), got);
+            }
+            current_node->hash = path_ctx.final();
+            current_node->content_hash = content_ctx.final();
         }
         return current_node;
     }
 
-    std::unique_ptr<Node> build_tree(const fs::path& root){
-        // 确保root为绝对路径
-        fs::path root_abs = fs::canonical(fs::absolute(root));
-        // 检查根目录是否存在
-        if (!fs::exists(root_abs)){
-            std::cerr << "Root path does not exist: " << root_abs << std::endl;
+    std::unique_ptr<Node> build_tree(const fs::path& root, const Node* prev){
+        // 检查根目录是否存在，canonical 对不存在的路径会抛出异常
+        std::error_code ec;
+        if (!fs::exists(root, ec)){
+            std::cerr << "Root path does not exist: " << fs::absolute(root) << std::endl;
             return nullptr;
         }
+        // 确保root为绝对路径
+        fs::path root_abs = fs::canonical(fs::absolute(root));
         // 递归遍历目录，构建目录树
-        return walk_dir(root_abs, root_abs);
+        return walk_dir(root_abs, root_abs, prev);
     }
 
-    void aux_display_tree(const std::unique_ptr<Node>& node, int level
-        , bool is_last, std::string prefix, int max_depth
-        , bool all, const std::vector<std::string>& no_list){
-        if (!node) {
-            std::cerr << "Tree node is nullptr" << std::endl;
-            return;
+    TreeStats tree_stats(const Node& root){
+        TreeStats stats;
+        if (!root.is_dir || root.is_symlink) {
+            stats.file_cnt = 1;
+            stats.total_bytes = root.size;
+            return stats;
         }
 
-        std::string path = node->path;
-        // 若为隐藏文件（夹）且all为false，忽略
-        if (!all && (path != "." && (util::start_with_prefix(path, ".")))){
-            return;
+        stats.dir_cnt = 1;
+        for (const auto& child: root.children){
+            TreeStats sub = tree_stats(*child);
+            stats.file_cnt += sub.file_cnt;
+            stats.dir_cnt += sub.dir_cnt;
+            stats.total_bytes += sub.total_bytes;
         }
+        return stats;
+    }
+
+    Node* find_child(const Node& dir, const std::string& path){
+        // 同一目录下子节点路径仅最后一段不同，字符串字典序与 walk_dir 的排序一致
+        auto it = std::lower_bound(dir.children.begin(), dir.children.end(), path
+                        , [](const std::unique_ptr<Node>& child, const std::string& p)
+                            {return child->path < p;});
+        if (it == dir.children.end() || (*it)->path != path) return nullptr;
+        return it->get();
+    }
 
-        // 若文件（夹）路径在 no_list 中，忽略
-        for (const auto& it: no_list){
-            if (util::compare_paths(path, it)){
-                return;
+    std::vector<std::string> path_prefixes(const std::string& path) {
+        std::vector<std::string> res;
+        std::string cur;
+        size_t pos = 0;
+        while (pos <= path.size()) {
+            size_t next = path.find('/', pos);
+            if (next == std::string::npos) next = path.size();
+            std::string part = path.substr(pos, next - pos);
+            if (!part.empty() && part != ".") {
+                if (!cur.empty()) cur += '/';
+                cur += part;
+                res.push_back(cur);
             }
+            pos = next + 1;
+        }
+        return res;
+    }
+
+    const Node* find_path(const Node& root, const std::string& path){
+        const Node* cur = &root;
+        for (const auto& prefix: path_prefixes(path)) {
+            cur = find_child(*cur, prefix);
+            if (!cur) return nullptr;
         }
+        return cur;
+    }
 
-        // 若指定了打印深度，且当前level大于max_depth
-        if (max_depth != -1 && level > max_depth) return;
-
-        // 根据当前节点是否为最后一个节点选择前缀
-        std::string connector = is_last? "└── " : "├── ";
-        std::string indent = prefix + (is_last ? "    " : "│   ");
-
-        // 打印当前节点
-        // 定义颜色
-        const std::string RESET_COLOR = util::color::RESET;
-        const std::string DIR_COLOR = util::color::GREEN;  // 绿色
-        const std::string FILE_COLOR = util::color::RED; // 红色
-        const std::string SYMLINK_COLOR = util::color::YELLOW; // 黄色
-
-        std::string color = RESET_COLOR;
-        if (node->is_dir && !node->is_symlink){
-            color = DIR_COLOR;
-        } else if (node->is_symlink) {
-            color = SYMLINK_COLOR;
-        } else {
-            color = FILE_COLOR;
-        }
-
-        std::cout << prefix << connector << color << path;
-        if (node->is_dir && !node->is_symlink){
-            std::cout << "[DIR]";
-        } else if (node->is_symlink) {
-            std::cout << "[SIMLINK]";
-        }
-        std::cout << RESET_COLOR << std::endl;
-
-        // 若为目录（符号链接除外）
-        if (node->is_dir && !node->is_symlink){
-            uint32_t children_cnt = node->children.size();
-            for (uint32_t i = 0; i < children_cnt; ++i){
-                // 确定是否为最后一个子节点
-                bool is_last_child = (i == children_cnt-1);
-                // 递归调用
-                aux_display_tree(node->children[i], level+1
-                            , is_last_child, indent, max_depth, all, no_list);
+    // @brief 辅助函数，判断子节点是否会被打印
+    static bool aux_shown(const Node& node, int level, int max_depth, const PathFilter& filter){
+        return (max_depth == -1 || level <= max_depth) && filter.visible(node.path);
+    }
+
+    // @brief 辅助函数，递归打印目录结构
+    // @param node 目录树节点，调用方已确认其可见
+    // @param level 当前打印层级，用于控制打印深度
+    // @param is_last 是否为最后一个可见子节点
+    // @param max_depth 最大打印目录结构深度
+    // @param filter 编译后的路径过滤器，不可见节点的整棵子树均不打印
+    // @param out 目录树打印器
+    static void aux_display_tree(const Node& node, int level, bool is_last, int max_depth
+                                , const PathFilter& filter, TreePrinter& out){
+        // 最后一个可见子节点，决定连接符；根节点有可见子节点时连接符为 "├── "
+        size_t last = node.children.size();
+        if (node.is_dir && !node.is_symlink){
+            for (size_t i = node.children.size(); i-- > 0; ){
+                if (aux_shown(*node.children[i], level + 1, max_depth, filter)){
+                    last = i;
+                    break;
+                }
+            }
+        }
+        if (level == 0) is_last = last == node.children.size();
+
+        out.line(node, is_last);
+        if (last == node.children.size()) return;
+
+        size_t len = out.push(is_last);
+        for (size_t i = 0; i <= last; ++i){
+            const Node& child = *node.children[i];
+            if (!aux_shown(child, level + 1, max_depth, filter)) continue;
+            aux_display_tree(child, level + 1, i == last, max_depth, filter, out);
+        }
+        out.pop(len);
+    }
+
+    // @brief 辅助函数，读取目录的直接子节点，只获取路径与类型等元信息
+    // @param dir 目录的绝对路径
+    // @param root 根目录的绝对路径
+    // @return 返回按路径字典序排列的子节点，不打开文件内容、不计算哈希值
+    static std::vector<std::unique_ptr<Node>> aux_list_dir(const fs::path& dir
+                                                        , const fs::path& root){
+        std::vector<std::unique_ptr<Node>> res;
+        std::error_code ec; // 用于处理权限等错误
+        fs::directory_iterator it(dir, ec), end;
+        if (ec) {
+            std::cerr << "Error accessing directory: " << ec.message()
+                      << " for path: " << dir << std::endl;
+            return res;
+        }
+        for (; it != end; it.increment(ec)){
+            if (ec){
+                std::cerr << "Error accessing directory: "
+                          << ec.message() << std::endl;
+                break;
             }
+            auto node = std::make_unique<Node>();
+            node->path = it->path().lexically_relative(root).string();
+            node->abs_root = root.string();
+            node->is_symlink = it->is_symlink(ec);
+            node->is_dir = it->is_directory(ec);
+            res.push_back(std::move(node));
+        }
+        // 与 walk_dir 相同按路径字典序排序
+        std::sort(res.begin(), res.end(), [](const std::unique_ptr<Node>& a
+                                            , const std::unique_ptr<Node>& b)
+                                            {return fs::path(a->path) < fs::path(b->path);});
+        return res;
+    }
+
+    // @brief 辅助函数，边遍历磁盘目录边打印目录结构
+    // @param root 根目录的绝对路径
+    // @param node 当前节点，仅含元信息
+    // @param level 当前打印层级
+    // @param is_last 是否为最后一个子节点
+    // @param out 目录树打印器
+    static void aux_stream_tree(const fs::path& root, const Node& node, int level
+        , bool is_last, int max_depth, const PathFilter& filter, TreePrinter& out){
+        // 已到达深度上限的目录不再读取其子节点
+        std::vector<std::unique_ptr<Node>> children;
+        if (node.is_dir && !node.is_symlink && (max_depth == -1 || level < max_depth)){
+            // 终端中每读取一个目录前先输出已有内容，保证输出即时可见
+            if (out.interactive()) out.flush();
+            children = aux_list_dir(level == 0? root: root / node.path, root);
+            // 不可见的子节点及其子树在遍历时即被剪除
+            children.erase(std::remove_if(children.begin(), children.end()
+                        , [&](const std::unique_ptr<Node>& child)
+                            {return !filter.visible(child->path);})
+                        , children.end());
+        }
+
+        // 根节点的连接符与 display_tree 一致：有子节点时为 "├── "
+        if (level == 0) is_last = children.empty();
+        out.line(node, is_last);
+        if (children.empty()) return;
+
+        size_t len = out.push(is_last);
+        for (size_t i = 0; i < children.size(); ++i){
+            aux_stream_tree(root, *children[i], level + 1, i + 1 == children.size()
+                            , max_depth, filter, out);
         }
+        out.pop(len);
     }
 
     void display_tree(const std::unique_ptr<Node>& root, int max_depth
@@ -188,12 +338,36 @@ namespace dirhist {
             std::cerr << "Tree root is nullptr" << std::endl;
             return;
         }
+        TreePrinter out;
         // 打印根目录所在绝对路径
-        std::cout << "[" << root->abs_root << "]" << std::endl;
-        
-        if (root->children.size())
-            aux_display_tree(root, 0, false, "", max_depth, all, no_list);
-        else aux_display_tree(root, 0, true, "", max_depth, all, no_list);
-        std::cout << "done." << std::endl;
+        out.text("[" + root->abs_root + "]");
+
+        // 过滤规则只编译一次，遍历时仅在内存中匹配
+        PathFilter filter(all, no_list, root->abs_root);
+        if (filter.visible(root->path))
+            aux_display_tree(*root, 0, true, max_depth, filter, out);
+        out.text("done.");
+    }
+
+    bool stream_tree(const fs::path& root, int max_depth
+        , bool all, const std::vector<std::string>& no_list){
+        std::error_code ec;
+        if (!fs::exists(root, ec)){
+            std::cerr << "Root path does not exist: " << fs::absolute(root) << std::endl;
+            return false;
+        }
+        fs::path root_abs = fs::canonical(fs::absolute(root));
+        TreePrinter out;
+        out.text("[" + root_abs.string() + "]");
+
+        Node node;
+        node.path = ".";
+        node.abs_root = root_abs.string();
+        node.is_dir = fs::is_directory(root_abs, ec);
+        PathFilter filter(all, no_list, root_abs.string());
+        if (filter.visible(node.path))
+            aux_stream_tree(root_abs, node, 0, true, max_depth, filter, out);
+        out.text("done.");
+        return true;
     }
-}
\ No newline at end of file
+}
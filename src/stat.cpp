@@ -0,0 +1,46 @@
+/*
+ * @file    src/stat.cpp
+ * @brief   This source file implements the functions for 'stat' command.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include "dirhist/stat.h"
+#include "dirhist/reader.h"
+#include "internal/util.h"
+
+namespace dirhist {
+    bool stat_paths(const fs::path& snapshot, const std::vector<std::string>& paths) {
+        SnapReader reader(snapshot);
+        std::vector<std::optional<NodeRef>> refs = reader.lookup(paths);
+
+        // 路径数量可能很多，整体格式化后一次写出
+        std::string buf = "Type     Size         Mtime                Hash"
+                          "                                                              Path\n";
+        bool all_found = true;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (!refs[i]) {
+                all_found = false;
+                buf += "missing  -            -                    -";
+                buf.append(65, ' ');
+            }
+            else {
+                const Node& info = refs[i]->info;
+                std::string type = info.is_symlink? "symlink": info.is_dir? "dir": "file";
+                std::string size = std::to_string(info.size);
+                buf += type;
+                buf.append(type.size() < 9? 9 - type.size(): 1, ' ');
+                buf += size;
+                buf.append(size.size() < 13? 13 - size.size(): 1, ' ');
+                buf += util::ts_str(info.mtime);
+                buf += "  ";
+                buf += util::hash_to_hex(info.hash);
+                buf += "  ";
+            }
+            buf += paths[i];
+            buf += '\n';
+        }
+        std::cout << buf << std::flush;
+        return all_found;
+    }
+}
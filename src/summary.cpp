@@ -0,0 +1,126 @@
+/*
+ * @file    src/summary.cpp
+ * @brief   This source file implements the per-directory rollup of a diff.
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include <algorithm>
+#include <string_view>
+#include "dirhist/summary.h"
+
+namespace dirhist {
+    // @brief 辅助函数，累加汇总
+    static void accumulate(DiffSummary& dst, const DiffSummary& src) {
+        dst.added += src.added;
+        dst.deleted += src.deleted;
+        dst.modified += src.modified;
+        dst.renamed += src.renamed;
+        dst.bytes_added += src.bytes_added;
+        dst.bytes_removed += src.bytes_removed;
+    }
+
+    void SummarySink::on_entry(const DiffEntry& de) {
+        DiffSummary delta;
+        switch (de.type) {
+            case ChangeType::Added:
+                if (de.is_dir) return;
+                delta.added = 1;
+                delta.bytes_added = de.new_size;
+                break;
+            case ChangeType::Deleted:
+                if (de.is_dir) return;
+                delta.deleted = 1;
+                delta.bytes_removed = de.old_size;
+                break;
+            case ChangeType::Modified:
+                if (de.is_dir) return;
+                delta.modified = 1;
+                if (de.new_size >= de.old_size) delta.bytes_added = de.new_size - de.old_size;
+                else delta.bytes_removed = de.old_size - de.new_size;
+                break;
+            case ChangeType::Renamed:
+            case ChangeType::Moved:
+                delta.renamed = 1;
+                break;
+        }
+        accumulate(root_.stats, delta);
+
+        // 仅按目录分层，路径最后一段（条目自身）不建立节点
+        const std::string& path = de.path;
+        SummaryNode* cur = &root_;
+        size_t pos = 0;
+        for (int level = 0; depth_ < 0 || level < depth_; ++level) {
+            size_t slash = path.find('/', pos);
+            if (slash == std::string::npos) break;
+            std::string_view name(path.data() + pos, slash - pos);
+            auto it = cur->children.find(name);
+            if (it == cur->children.end()) {
+                it = cur->children.emplace(std::string(name)
+                                        , std::make_unique<SummaryNode>()).first;
+            }
+            cur = it->second.get();
+            accumulate(cur->stats, delta);
+            pos = slash + 1;
+        }
+    }
+
+    // @brief 辅助函数，计算名称列宽度（每层缩进4列）
+    static size_t name_width(const SummaryNode& node, size_t indent) {
+        size_t width = 0;
+        for (const auto& [name, child]: node.children) {
+            width = std::max(width, indent + 4 + name.size());
+            width = std::max(width, name_width(*child, indent + 4));
+        }
+        return width;
+    }
+
+    // @brief 辅助函数，追加右对齐的数值列
+    static void append_num(std::string& buf, uint64_t val, size_t width
+                                                , const char* sign = "") {
+        std::string num = sign + std::to_string(val);
+        if (num.size() < width) buf.append(width - num.size(), ' ');
+        buf += num;
+    }
+
+    // @brief 辅助函数，追加一行汇总
+    static void append_row(std::string& buf, const std::string& prefix
+                , const std::string& name, size_t visible, size_t width
+                , const DiffSummary& s) {
+        buf += prefix;
+        buf += name;
+        buf.append(width - visible, ' ');
+        append_num(buf, s.added, 10);
+        append_num(buf, s.deleted, 10);
+        append_num(buf, s.modified, 10);
+        append_num(buf, s.renamed, 10);
+        append_num(buf, s.bytes_added, 16, "+");
+        append_num(buf, s.bytes_removed, 16, "-");
+        buf += '\n';
+    }
+
+    // @brief 辅助函数，递归追加汇总树
+    static void append_tree(std::string& buf, const SummaryNode& node
+                , const std::string& prefix, size_t indent, size_t width) {
+        size_t i = 0;
+        for (const auto& [name, child]: node.children) {
+            bool is_last = ++i == node.children.size();
+            append_row(buf, prefix + (is_last? "└── ": "├── "), name + "/"
+                    , indent + 4 + name.size() + 1, width, child->stats);
+            append_tree(buf, *child, prefix + (is_last? "    ": "│   ")
+                    , indent + 4, width);
+        }
+    }
+
+    void SummarySink::finish() {
+        // 名称列额外留出目录名后的 '/'
+        size_t width = std::max<size_t>(name_width(root_, 0) + 1, 4);
+        std::string buf = "Path";
+        buf.append(width - 4, ' ');
+        buf += "     Added   Deleted  Modified   Renamed     Bytes added   Bytes removed\n";
+        append_row(buf, "", ".", 1, width, root_.stats);
+        append_tree(buf, root_, "", 0, width);
+        os_ << buf;
+        os_.flush();
+    }
+}
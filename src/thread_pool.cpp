@@ -0,0 +1,104 @@
+/*
+ * @file    src/thread_pool.cpp
+ * @brief   This source file implements the thread pool defined in src/internal/thread_pool.h
+ * @author  yannn
+ * @date    2025-07-28
+ */
+
+#include "internal/thread_pool.h"
+
+namespace util {
+    ThreadPool::ThreadPool(size_t workers) {
+        threads_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            threads_.emplace_back([this]{ worker_loop(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t: threads_) t.join();
+    }
+
+    void ThreadPool::submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    ThreadPool& ThreadPool::instance() {
+        size_t hw = std::thread::hardware_concurrency();
+        static ThreadPool pool(hw > 1? hw - 1: 0);
+        return pool;
+    }
+
+    void ThreadPool::worker_loop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cv_.wait(lock, [this]{ return stop_ || !tasks_.empty(); });
+                if (stop_ && tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    TaskGroup::~TaskGroup() {
+        drain();
+    }
+
+    void TaskGroup::run(std::function<void()> task) {
+        auto t = std::make_shared<Task>();
+        t->fn = std::move(task);
+        tasks_.push_back(t);
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            ++pending_;
+        }
+        // 已被等待线程认领的任务不再访问本组，组可能已经析构
+        pool_.submit([this, t]{
+            if (!t->claimed.exchange(true)) execute(*t);
+        });
+    }
+
+    void TaskGroup::execute(Task& task) {
+        try {
+            task.fn();
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!error_) error_ = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (--pending_ == 0) cv_.notify_all();
+    }
+
+    void TaskGroup::wait() {
+        drain();
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (error_) {
+            std::exception_ptr e = error_;
+            error_ = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    void TaskGroup::drain() {
+        // 按派发顺序执行尚未开始的任务，其余任务正由工作线程执行
+        for (auto& t: tasks_) {
+            if (!t->claimed.exchange(true)) execute(*t);
+        }
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this]{ return pending_ == 0; });
+        tasks_.clear();
+    }
+}
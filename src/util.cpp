@@ -6,12 +6,21 @@
  */
 
 #include <openssl/sha.h>
+#include <openssl/evp.h>
+#include <stdexcept>
 #include <chrono>
 #include <array>
+#include <atomic>
 #include <filesystem>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <ctime>
+#include <cctype>
+#include <unistd.h>
 #include "internal/util.h"
 
 namespace util {
@@ -21,10 +30,80 @@ namespace util {
         return hash;
     }
 
+    Sha256::Sha256(){
+        EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+        if (!ctx || EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr) != 1){
+            EVP_MD_CTX_free(ctx);
+            throw std::runtime_error("Error initializing SHA-256 context");
+        }
+        ctx_ = ctx;
+    }
+
+    Sha256::~Sha256(){
+        EVP_MD_CTX_free(static_cast<EVP_MD_CTX*>(ctx_));
+    }
+
+    void Sha256::update(const void* data, size_t len){
+        EVP_DigestUpdate(static_cast<EVP_MD_CTX*>(ctx_), data, len);
+    }
+
+    std::array<uint8_t, 32> Sha256::final(){
+        std::array<uint8_t, 32> hash{0};
+        unsigned int len = 0;
+        EVP_DigestFinal_ex(static_cast<EVP_MD_CTX*>(ctx_), hash.data(), &len);
+        return hash;
+    }
+
+    std::optional<std::array<uint8_t, 32>> sha256_file(const fs::path& path){
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return std::nullopt;
+        Sha256 ctx;
+        std::vector<char> block(64 * 1024);
+        while (file) {
+            file.read(block.data(), block.size());
+            size_t got = static_cast<size_t>(file.gcount());
+            if (got == 0) break;
+            ctx.update(block.data(), got);
+        }
+        return ctx.final();
+    }
+
     std::string hash_to_str(const std::array<uint8_t, 32>& hash){
         return std::string(reinterpret_cast<const char*>(hash.data()), hash.size());
     }
 
+    std::string hash_to_hex(const std::array<uint8_t, 32>& hash){
+        static const char digits[] = "0123456789abcdef";
+        std::string hex(hash.size() * 2, '0');
+        for (size_t i = 0; i < hash.size(); ++i){
+            hex[2*i] = digits[hash[i] >> 4];
+            hex[2*i+1] = digits[hash[i] & 0xF];
+        }
+        return hex;
+    }
+
+    std::optional<std::array<uint8_t, 32>> hex_to_hash(const std::string& hex){
+        if (hex.size() != 64) return std::nullopt;
+        auto nibble = [](char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+        std::array<uint8_t, 32> hash{0};
+        for (size_t i = 0; i < hash.size(); ++i){
+            int hi = nibble(hex[2*i]), lo = nibble(hex[2*i+1]);
+            if (hi < 0 || lo < 0) return std::nullopt;
+            hash[i] = static_cast<uint8_t>(hi << 4 | lo);
+        }
+        return hash;
+    }
+
+    std::string tmp_suffix(){
+        static std::atomic<uint64_t> seq{0};
+        return ".tmp-" + std::to_string(getpid()) + "-" + std::to_string(seq.fetch_add(1));
+    }
+
     int64_t now_ms(){
         return static_cast<std::int64_t>(
             std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -33,6 +112,28 @@ namespace util {
         );
     }
 
+    int64_t file_time_ms(const fs::file_time_type& ft){
+        using namespace std::chrono;
+        // 文件时钟与系统时钟的纪元相差整秒（libstdc++ 中为 2174-01-01），
+        // 测量两者之差后按秒取整，消除两次读取时钟之间的误差，使转换结果稳定
+        static const int64_t offset_ns = []{
+            int64_t f = duration_cast<nanoseconds>(
+                    fs::file_time_type::clock::now().time_since_epoch()).count();
+            int64_t s = duration_cast<nanoseconds>(
+                    system_clock::now().time_since_epoch()).count();
+            int64_t d = f - s;
+            constexpr int64_t SEC = 1000000000;
+            return (d >= 0? d + SEC / 2: d - SEC / 2) / SEC * SEC;
+        }();
+        // 向下取整，1970 年之前的时间（负值）不会向零偏移
+        int64_t ns = duration_cast<nanoseconds>(ft.time_since_epoch()).count();
+        return floor<milliseconds>(nanoseconds(ns - offset_ns)).count();
+    }
+
+    int64_t file_ticks_ms(int64_t ticks){
+        return file_time_ms(fs::file_time_type(fs::file_time_type::duration(ticks)));
+    }
+
     bool ends_with_suffix(const std::string& str, const std::string& suffix){
         return str.size() >= suffix.size() &&
            str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
@@ -60,6 +161,32 @@ namespace util {
         return oss.str();
     }
 
+    std::optional<int64_t> parse_ts(const std::string& str) {
+        if (str.empty()) return std::nullopt;
+        // 纯数字视为毫秒级时间戳
+        if (std::all_of(str.begin(), str.end()
+                        , [](unsigned char c){return std::isdigit(c);})) {
+            try {
+                return std::stoll(str);
+            }
+            catch (...) {
+                return std::nullopt;
+            }
+        }
+
+        for (const char* fmt: {"%Y-%m-%d %H:%M:%S", "%Y-%m-%d"}) {
+            std::tm tm{};
+            std::istringstream iss(str);
+            iss >> std::get_time(&tm, fmt);
+            if (iss.fail() || iss.peek() != EOF) continue;
+            tm.tm_isdst = -1;
+            std::time_t t = std::mktime(&tm);
+            if (t == -1) return std::nullopt;
+            return static_cast<int64_t>(t) * 1000;
+        }
+        return std::nullopt;
+    }
+
     std::string trim(const std::string& str) {
         size_t first = str.find_first_not_of(' ');
         if (first == std::string::npos)
@@ -89,4 +216,8 @@ namespace util {
 
         return path1_abs == path2_abs;
     }
-}
\ No newline at end of file
+
+    bool stdout_is_tty(){
+        return isatty(STDOUT_FILENO) == 1;
+    }
+}
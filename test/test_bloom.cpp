@@ -0,0 +1,233 @@
+/*
+ * @file    test/test_bloom.cpp
+ * @brief   This source file implemented to test the functions in src/bloom.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_bloom test/test_bloom.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/filter.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/bloom.h"
+#include "dirhist/catalog.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+class BloomTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_bloom_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_bloom_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+        std::filesystem::create_directories(test_dir / "conf");
+        create_file(test_dir / "conf" / "app.yaml", "app");
+        create_file(test_dir / "readme.md", "readme");
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+
+    // 以时间戳 ts 写入当前目录的快照
+    void snap(int64_t ts) {
+        auto root = dirhist::build_tree(test_dir);
+        dirhist::write_snapshot(*root, ts, output_dir);
+    }
+};
+
+// 测试过滤器不漏报，误判率接近预期
+TEST(BloomFilterTest, NoFalseNegatives) {
+    dirhist::BloomFilter filter(10000);
+    for (int i = 0; i < 10000; ++i) filter.add(dirhist::path_key("dir/f" + std::to_string(i)));
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_TRUE(filter.may_contain(dirhist::path_key("dir/f" + std::to_string(i))));
+    }
+    int false_pos = 0;
+    for (int i = 0; i < 10000; ++i) {
+        if (filter.may_contain(dirhist::path_key("other/g" + std::to_string(i)))) ++false_pos;
+    }
+    EXPECT_LT(false_pos, 300);
+
+    // 路径键与写法无关
+    EXPECT_EQ(dirhist::path_key("./a//b/"), dirhist::path_key("a/b"));
+    EXPECT_EQ(dirhist::path_key(""), dirhist::path_key("."));
+}
+
+// 测试快照写入时生成过滤器，按路径查询只打开可能包含的快照
+TEST_F(BloomTest, ContainsPathAcrossSnapshots) {
+    snap(100);
+    create_file(test_dir / "conf" / "secrets.env", "token");
+    snap(200);
+    snap(300);                                          // 与 200 根哈希相同
+    std::filesystem::remove(test_dir / "conf" / "secrets.env");
+    snap(400);
+
+    auto root = dirhist::build_tree(test_dir);
+    EXPECT_TRUE(std::filesystem::exists(dirhist::filter_path(output_dir, root->hash)));
+
+    dirhist::ContainsQuery query;
+    query.path = "./conf/secrets.env";
+    std::vector<dirhist::ContainsHit> hits;
+    dirhist::ContainsStats stats = dirhist::snapshots_containing(output_dir, query, hits);
+    ASSERT_EQ(hits.size(), 2);
+    EXPECT_EQ(hits[0].timestamp, 200);
+    EXPECT_EQ(hits[1].timestamp, 300);
+    EXPECT_EQ(hits[0].path, "conf/secrets.env");
+    EXPECT_EQ(hits[0].size, 5);
+    EXPECT_EQ(stats.snapshots, 4);
+    EXPECT_EQ(stats.trees, 2);                          // 400 与 100 内容相同
+    EXPECT_EQ(stats.built, 0);
+    EXPECT_LE(stats.opened, 2);
+
+    // 时间范围
+    hits.clear();
+    dirhist::snapshots_containing(output_dir, query, hits, 250);
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(hits[0].timestamp, 300);
+
+    // 不存在的路径
+    hits.clear();
+    query.path = "conf/missing";
+    dirhist::snapshots_containing(output_dir, query, hits);
+    EXPECT_TRUE(hits.empty());
+}
+
+// 测试按内容查询，以及缺少过滤器时查询中补建
+TEST_F(BloomTest, ContainsContentAndRebuild) {
+    snap(100);
+    std::filesystem::rename(test_dir / "conf" / "app.yaml", test_dir / "app.yaml");
+    snap(200);
+    aux_remove_all(output_dir / "bloom");
+
+    auto root = dirhist::build_tree(test_dir);
+    const dirhist::Node* moved = dirhist::find_path(*root, "app.yaml");
+    ASSERT_NE(moved, nullptr);
+
+    dirhist::ContainsQuery query;
+    query.content = moved->content_hash;
+    std::vector<dirhist::ContainsHit> hits;
+    dirhist::ContainsStats stats = dirhist::snapshots_containing(output_dir, query, hits);
+    ASSERT_EQ(hits.size(), 2);
+    EXPECT_EQ(hits[0].path, "conf/app.yaml");
+    EXPECT_EQ(hits[1].path, "app.yaml");
+    EXPECT_EQ(stats.built, 2);
+
+    // 补建的过滤器已保存
+    hits.clear();
+    stats = dirhist::snapshots_containing(output_dir, query, hits);
+    EXPECT_EQ(stats.built, 0);
+    EXPECT_EQ(hits.size(), 2);
+
+    // 损坏的过滤器视为缺失
+    {
+        std::ofstream ofs(dirhist::filter_path(output_dir, root->hash), std::ios::binary);
+        ofs << "broken";
+    }
+    EXPECT_FALSE(dirhist::load_filters(output_dir, root->hash).has_value());
+
+    dirhist::ContainsQuery both;
+    both.path = "a";
+    both.content = moved->content_hash;
+    EXPECT_THROW(dirhist::snapshots_containing(output_dir, both, hits), std::runtime_error);
+}
+
+// 测试内容过滤器只收录文件，目录与未知（全零）内容哈希查不到结果
+TEST_F(BloomTest, ContentFilterSkipsDirsAndUnknownHashes) {
+    snap(100);
+    auto root = dirhist::build_tree(test_dir);
+    const dirhist::Node* conf = dirhist::find_path(*root, "conf");
+    const dirhist::Node* app = dirhist::find_path(*root, "conf/app.yaml");
+    ASSERT_NE(conf, nullptr);
+    ASSERT_NE(app, nullptr);
+
+    dirhist::SnapFilters filters = dirhist::build_filters(*root);
+    EXPECT_TRUE(filters.contents.may_contain(dirhist::content_key(app->content_hash)));
+    EXPECT_TRUE(filters.paths.may_contain(dirhist::path_key("conf")));
+
+    dirhist::ContainsQuery query;
+    std::vector<dirhist::ContainsHit> hits;
+    query.content = conf->content_hash;
+    dirhist::snapshots_containing(output_dir, query, hits);
+    EXPECT_TRUE(hits.empty());
+
+    query.content = std::array<uint8_t, 32>{0};
+    dirhist::snapshots_containing(output_dir, query, hits);
+    EXPECT_TRUE(hits.empty());
+
+    query.content = app->content_hash;
+    dirhist::snapshots_containing(output_dir, query, hits);
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_FALSE(hits[0].is_dir);
+
+    // 过滤器写入时不留下临时文件
+    for (const auto& e: std::filesystem::directory_iterator(output_dir / "bloom")) {
+        EXPECT_EQ(e.path().extension(), ".bin");
+    }
+}
+
+// 测试按内容查询时跳过没有内容哈希的旧版本快照，并计入统计；按路径查询不受影响
+TEST_F(BloomTest, ContentQuerySkipsSnapshotsWithoutContentHash) {
+    snap(200);
+
+    // 手工写入只有根节点的 version 4 快照（节点记录不含内容哈希与聚合信息）
+    std::filesystem::path old_file = output_dir / "snap-100.bin";
+    dirhist::Header hdr;
+    hdr.version = 4;
+    hdr.timestamp = 100;
+    hdr.root_offset = sizeof(dirhist::Header);
+    hdr.root_hash[0] = 4;
+    {
+        std::ofstream ofs(old_file, std::ios::binary);
+        dirhist::write(ofs, hdr);
+        std::string path = ".";
+        dirhist::write(ofs, static_cast<uint32_t>(path.size()));
+        ofs.write(path.data(), path.size());
+        dirhist::write(ofs, uint32_t(0));
+        dirhist::write(ofs, uint8_t(1));
+        dirhist::write(ofs, uint8_t(0));
+        dirhist::write(ofs, uint64_t(0));
+        dirhist::write(ofs, int64_t(0));
+        ofs.write(reinterpret_cast<const char*>(hdr.root_hash.data()), hdr.root_hash.size());
+        dirhist::write(ofs, uint32_t(0));
+        hdr.data_size = static_cast<uint64_t>(ofs.tellp()) - hdr.root_offset;
+        ofs.seekp(0);
+        dirhist::write(ofs, hdr);
+    }
+    dirhist::catalog_add(old_file, hdr);
+
+    auto root = dirhist::build_tree(test_dir);
+    const dirhist::Node* readme = dirhist::find_path(*root, "readme.md");
+    ASSERT_NE(readme, nullptr);
+    dirhist::ContainsQuery query;
+    std::vector<dirhist::ContainsHit> hits;
+    query.content = readme->content_hash;
+    dirhist::ContainsStats stats = dirhist::snapshots_containing(output_dir, query, hits);
+    EXPECT_EQ(stats.trees, 2);
+    EXPECT_EQ(stats.skipped, 1);
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(hits[0].timestamp, 200);
+
+    dirhist::ContainsQuery by_path;
+    by_path.path = ".";
+    hits.clear();
+    stats = dirhist::snapshots_containing(output_dir, by_path, hits);
+    EXPECT_EQ(stats.skipped, 0);
+    EXPECT_EQ(hits.size(), 2);
+}
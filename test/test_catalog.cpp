@@ -0,0 +1,197 @@
+/*
+ * @file    test/test_catalog.cpp
+ * @brief   This source file implemented to test the functions in src/catalog.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_catalog test/test_catalog.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/catalog.h"
+#include "dirhist/diff.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+class CatalogTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_catalog_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_catalog_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+        std::filesystem::create_directories(test_dir / "sub");
+        create_file(test_dir / "a.txt", "aaaa");
+        create_file(test_dir / "sub" / "b.txt", "bb");
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+
+    // 写入时间戳为 100, 200, ..., cnt*100 的快照
+    void write_snapshots(int cnt) {
+        auto root = dirhist::build_tree(test_dir);
+        for (int i = 1; i <= cnt; ++i) {
+            dirhist::write_snapshot(*root, i * 100, output_dir);
+        }
+    }
+};
+
+// 写入快照时登记统计信息
+TEST_F(CatalogTest, WriteSnapshotAppendsEntry) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root, 100, output_dir);
+
+    auto entries = dirhist::query_catalog(output_dir);
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].timestamp, 100);
+    EXPECT_EQ(entries[0].root_hash, root->hash);
+    EXPECT_EQ(entries[0].file_size, std::filesystem::file_size(output_dir / "snap-100.bin"));
+    EXPECT_EQ(entries[0].stats.file_cnt, 2);
+    EXPECT_EQ(entries[0].stats.dir_cnt, 2);
+    EXPECT_EQ(entries[0].stats.total_bytes, 6);
+}
+
+// 查询最近 n 条及时间范围
+TEST_F(CatalogTest, QueryByNumAndRange) {
+    write_snapshots(5);
+
+    auto latest = dirhist::query_catalog(output_dir, 2);
+    ASSERT_EQ(latest.size(), 2);
+    EXPECT_EQ(latest[0].timestamp, 500);
+    EXPECT_EQ(latest[1].timestamp, 400);
+
+    auto range = dirhist::query_catalog(output_dir, -1, 200, 400);
+    ASSERT_EQ(range.size(), 3);
+    EXPECT_EQ(range[0].timestamp, 400);
+    EXPECT_EQ(range[2].timestamp, 200);
+
+    auto limited = dirhist::query_catalog(output_dir, 1, 150, 350);
+    ASSERT_EQ(limited.size(), 1);
+    EXPECT_EQ(limited[0].timestamp, 300);
+
+    EXPECT_TRUE(dirhist::query_catalog(output_dir, -1, 600).empty());
+}
+
+// 乱序写入后仍保持按时间戳有序
+TEST_F(CatalogTest, OutOfOrderInsertKeepsOrder) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root, 300, output_dir);
+    dirhist::write_snapshot(*root, 100, output_dir);
+    dirhist::write_snapshot(*root, 200, output_dir);
+    dirhist::write_snapshot(*root, 200, output_dir);
+
+    auto entries = dirhist::query_catalog(output_dir);
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[0].timestamp, 300);
+    EXPECT_EQ(entries[1].timestamp, 200);
+    EXPECT_EQ(entries[2].timestamp, 100);
+}
+
+// 多个线程同时登记快照时条目完整且有序
+TEST_F(CatalogTest, ConcurrentAddKeepsAllEntries) {
+    write_snapshots(1);
+    const dirhist::Header base = dirhist::read_snapshot_header(output_dir / "snap-100.bin");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            dirhist::Header hdr = base;
+            // 各线程时间戳交错，触发追加与乱序替换两条路径
+            for (int i = 0; i < 25; ++i) {
+                int64_t ts = 1000 + (i * 4 + t) * 10 + (i % 2 ? 0 : 5 - t);
+                auto path = output_dir / ("snap-" + std::to_string(ts) + ".bin");
+                std::filesystem::copy_file(output_dir / "snap-100.bin", path
+                            , std::filesystem::copy_options::overwrite_existing);
+                hdr.timestamp = ts;
+                dirhist::catalog_add(path, hdr);
+            }
+        });
+    }
+    for (auto& th: threads) th.join();
+
+    auto entries = dirhist::query_catalog(output_dir);
+    ASSERT_EQ(entries.size(), 101);
+    for (size_t i = 1; i < entries.size(); ++i) {
+        EXPECT_GT(entries[i - 1].timestamp, entries[i].timestamp);
+    }
+    EXPECT_EQ(entries.size(), dirhist::catalog_rebuild(output_dir).size());
+}
+
+// 目录文件缺失或过期时自动重建
+TEST_F(CatalogTest, RebuildWhenMissingOrStale) {
+    write_snapshots(3);
+
+    std::filesystem::remove(dirhist::catalog_path(output_dir));
+    auto entry = dirhist::latest_entry(output_dir);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->timestamp, 300);
+    EXPECT_EQ(entry->stats.file_cnt, 2);
+    EXPECT_TRUE(std::filesystem::exists(dirhist::catalog_path(output_dir)));
+
+    std::filesystem::remove(output_dir / "snap-300.bin");
+    EXPECT_EQ(dirhist::latest_snap(output_dir), output_dir / "snap-200.bin");
+}
+
+// 未登记的快照文件移回快照目录后，查询时重建目录文件
+TEST_F(CatalogTest, RebuildWhenSnapshotMovedBack) {
+    write_snapshots(3);
+    auto moved = test_dir / "snap-200.bin";
+    std::filesystem::rename(output_dir / "snap-200.bin", moved);
+    ASSERT_EQ(dirhist::query_catalog(output_dir).size(), 2);
+
+    std::filesystem::rename(moved, output_dir / "snap-200.bin");
+    auto entries = dirhist::query_catalog(output_dir);
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[1].timestamp, 200);
+    EXPECT_EQ(entries[1].stats.file_cnt, 2);
+}
+
+// 目录文件无法写入时在内存中重建，查询不受影响
+TEST_F(CatalogTest, RebuildInMemoryWhenNotWritable) {
+    write_snapshots(3);
+    std::filesystem::remove(dirhist::catalog_path(output_dir));
+    // 以同名目录占据锁文件路径，使目录文件无法加锁写入
+    std::filesystem::remove(output_dir / "catalog.lock");
+    std::filesystem::create_directories(output_dir / "catalog.lock");
+
+    std::vector<dirhist::CatalogEntry> entries;
+    EXPECT_NO_THROW(entries = dirhist::query_catalog(output_dir, 2));
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].timestamp, 300);
+    EXPECT_EQ(entries[1].timestamp, 200);
+    EXPECT_FALSE(std::filesystem::exists(dirhist::catalog_path(output_dir)));
+
+    std::filesystem::remove(output_dir / "snap-300.bin");
+    entries = dirhist::query_catalog(output_dir);
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].timestamp, 200);
+}
+
+// 清空快照时一并删除目录文件
+TEST_F(CatalogTest, CleanSnapshotsRemovesCatalog) {
+    write_snapshots(2);
+    dirhist::clean_snapshots(output_dir);
+
+    EXPECT_FALSE(std::filesystem::exists(dirhist::catalog_path(output_dir)));
+    EXPECT_TRUE(dirhist::latest_snap(output_dir).empty());
+}
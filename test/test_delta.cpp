@@ -0,0 +1,225 @@
+/*
+ * @file    test/test_delta.cpp
+ * @brief   This source file implemented to test the functions in src/delta.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_delta test/test_delta.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/delta.h"
+#include "dirhist/reader.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+// 辅助函数：查找Node树中的某个节点
+const dirhist::Node* find_node(const dirhist::Node* root, const std::string& rel_path) {
+    if (!root) return nullptr;
+    if (root->path == rel_path) return root;
+    for (const auto& child : root->children) {
+        if (const dirhist::Node* found = find_node(child.get(), rel_path)) return found;
+    }
+    return nullptr;
+}
+
+// 辅助函数：读取快照文件头
+dirhist::Header header_of(const std::filesystem::path& snapshot) {
+    std::ifstream ifs(snapshot, std::ios::binary);
+    dirhist::Header hdr;
+    dirhist::read_header(ifs, hdr);
+    return hdr;
+}
+
+class DeltaTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_delta_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_delta_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+        std::filesystem::create_directories(test_dir / "keep" / "deep");
+        std::filesystem::create_directories(test_dir / "edit");
+        create_file(test_dir / "keep" / "deep" / "k.txt", "keep me");
+        create_file(test_dir / "edit" / "e.txt", "before");
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+};
+
+// 没有父快照时写入完整快照
+TEST_F(DeltaTest, FirstSnapshotIsFull) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_delta_snapshot(*root, 100, output_dir);
+
+    auto hdr = header_of(output_dir / "snap-100.bin");
+    EXPECT_EQ(hdr.kind, static_cast<uint8_t>(dirhist::SnapKind::Full));
+    EXPECT_EQ(hdr.chain_len, 0);
+}
+
+// 增量快照读取后与完整目录树一致
+TEST_F(DeltaTest, DeltaOverlaysParent) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root1, 100, output_dir);
+
+    create_file(test_dir / "edit" / "e.txt", "after!");
+    create_file(test_dir / "new.txt", "n");
+    auto root2 = dirhist::build_tree(test_dir);
+    dirhist::write_delta_snapshot(*root2, 200, output_dir);
+
+    auto hdr = header_of(output_dir / "snap-200.bin");
+    EXPECT_EQ(hdr.kind, static_cast<uint8_t>(dirhist::SnapKind::Delta));
+    EXPECT_EQ(hdr.parent_ts, 100);
+    EXPECT_EQ(hdr.chain_len, 1);
+    // 未变化的 keep 子树只保存继承标记，增量快照应小于完整快照
+    EXPECT_LT(std::filesystem::file_size(output_dir / "snap-200.bin"),
+              std::filesystem::file_size(output_dir / "snap-100.bin"));
+
+    auto loaded = dirhist::read_snapshot(200, output_dir);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->hash, root2->hash);
+    const dirhist::Node* k = find_node(loaded.get(), "keep/deep/k.txt");
+    ASSERT_NE(k, nullptr);
+    EXPECT_EQ(k->size, 7);
+    const dirhist::Node* e = find_node(loaded.get(), "edit/e.txt");
+    ASSERT_NE(e, nullptr);
+    EXPECT_EQ(e->size, 6);
+    EXPECT_NE(find_node(loaded.get(), "new.txt"), nullptr);
+}
+
+// 仅修改 mtime 的子树不应继承父快照中过期的 mtime 与聚合信息
+TEST_F(DeltaTest, TouchedSubtreeIsNotInherited) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root1, 100, output_dir);
+
+    auto k_path = test_dir / "keep" / "deep" / "k.txt";
+    std::filesystem::last_write_time(k_path
+                , std::filesystem::last_write_time(k_path) + std::chrono::hours(1));
+    auto root2 = dirhist::build_tree(test_dir);
+    ASSERT_EQ(root2->hash, root1->hash);
+    dirhist::write_delta_snapshot(*root2, 200, output_dir);
+
+    const dirhist::Node* expected = find_node(root2.get(), "keep/deep/k.txt");
+    ASSERT_NE(expected, nullptr);
+    auto loaded = dirhist::read_snapshot(200, output_dir);
+    const dirhist::Node* k = find_node(loaded.get(), "keep/deep/k.txt");
+    ASSERT_NE(k, nullptr);
+    EXPECT_EQ(k->mtime, expected->mtime);
+    EXPECT_EQ(find_node(loaded.get(), "keep")->max_mtime
+                        , find_node(root2.get(), "keep")->max_mtime);
+
+    dirhist::SnapReader reader(output_dir / "snap-200.bin");
+    auto ref = reader.lookup("keep/deep/k.txt");
+    ASSERT_TRUE(ref.has_value());
+    EXPECT_EQ(ref->info.mtime, expected->mtime);
+}
+
+// 增量链达到上限后写入新的完整快照
+TEST_F(DeltaTest, MaxChainForcesFullSnapshot) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_delta_snapshot(*root, 100, output_dir, 2);
+    for (int64_t ts = 200; ts <= 400; ts += 100) {
+        create_file(test_dir / "edit" / "e.txt", std::to_string(ts));
+        root = dirhist::build_tree(test_dir);
+        dirhist::write_delta_snapshot(*root, ts, output_dir, 2);
+    }
+
+    EXPECT_EQ(header_of(output_dir / "snap-200.bin").chain_len, 1);
+    EXPECT_EQ(header_of(output_dir / "snap-300.bin").chain_len, 2);
+    auto hdr = header_of(output_dir / "snap-400.bin");
+    EXPECT_EQ(hdr.kind, static_cast<uint8_t>(dirhist::SnapKind::Full));
+    EXPECT_EQ(hdr.chain_len, 0);
+
+    // 沿增量链读取
+    auto loaded = dirhist::read_snapshot(300, output_dir);
+    const dirhist::Node* e = find_node(loaded.get(), "edit/e.txt");
+    ASSERT_NE(e, nullptr);
+    EXPECT_EQ(e->size, 3);
+    EXPECT_NE(find_node(loaded.get(), "keep/deep/k.txt"), nullptr);
+}
+
+// 父快照缺失时读取抛出异常
+TEST_F(DeltaTest, MissingParentThrows) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root1, 100, output_dir);
+    create_file(test_dir / "edit" / "e.txt", "after");
+    auto root2 = dirhist::build_tree(test_dir);
+    dirhist::write_delta_snapshot(*root2, 200, output_dir);
+
+    std::filesystem::remove(output_dir / "snap-100.bin");
+    EXPECT_THROW({
+        dirhist::read_snapshot(200, output_dir);
+    }, std::runtime_error);
+}
+
+// 辅助函数：比较两棵目录树的节点信息与结构
+void expect_same_tree(const dirhist::Node& a, const dirhist::Node& b) {
+    EXPECT_TRUE(dirhist::same_node_info(a, b)) << a.path << " vs " << b.path;
+    ASSERT_EQ(a.children.size(), b.children.size()) << a.path;
+    for (size_t i = 0; i < a.children.size(); ++i) {
+        expect_same_tree(*a.children[i], *b.children[i]);
+    }
+}
+
+// 大目录中只变化少数文件时，其余文件记录按区间继承，沿增量链读取结果一致
+TEST_F(DeltaTest, UnchangedFilesInChangedDirAreInherited) {
+    auto big = test_dir / "big";
+    std::filesystem::create_directories(big / "sub");
+    create_file(big / "sub" / "s.txt", "sub");
+    for (int i = 0; i < 1000; ++i) {
+        create_file(big / ("f" + std::to_string(1000 + i)), std::to_string(i));
+    }
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root1, 100, output_dir);
+
+    // 修改、删除、新增各一个文件
+    create_file(big / "f1500", "changed");
+    std::filesystem::remove(big / "f1700");
+    create_file(big / "f1700x", "added");
+    auto root2 = dirhist::build_tree(test_dir);
+    dirhist::write_delta_snapshot(*root2, 200, output_dir);
+    auto full_size = std::filesystem::file_size(output_dir / "snap-100.bin");
+    EXPECT_LT(std::filesystem::file_size(output_dir / "snap-200.bin") * 20, full_size);
+
+    // 以增量快照为父快照，继承区间指向父快照中同样含继承区间的目录
+    create_file(big / "f1001", "changed again");
+    auto root3 = dirhist::build_tree(test_dir);
+    dirhist::write_delta_snapshot(*root3, 300, output_dir);
+    EXPECT_EQ(header_of(output_dir / "snap-300.bin").chain_len, 2);
+    EXPECT_LT(std::filesystem::file_size(output_dir / "snap-300.bin") * 20, full_size);
+
+    expect_same_tree(*dirhist::read_snapshot(200, output_dir), *root2);
+    expect_same_tree(*dirhist::read_snapshot(300, output_dir), *root3);
+
+    dirhist::SnapReader reader(output_dir / "snap-300.bin");
+    expect_same_tree(*reader.load(reader.root()), *root3);
+    for (const char* path: {"big/f1000", "big/f1001", "big/f1500", "big/f1700x", "big/sub/s.txt"}) {
+        auto ref = reader.lookup(path);
+        ASSERT_TRUE(ref.has_value()) << path;
+        EXPECT_TRUE(dirhist::same_node_info(ref->info, *find_node(root3.get(), path))) << path;
+    }
+    EXPECT_FALSE(reader.lookup("big/f1700").has_value());
+    auto dir = reader.lookup("big");
+    ASSERT_TRUE(dir.has_value());
+    EXPECT_EQ(reader.children(*dir).size(), 1001);
+}
@@ -4,15 +4,19 @@
  * @author  yannn
  * @date    2025-07-28
  */
-// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_diff test/test_diff.cpp src/serialize.cpp  src/snapshot.cpp src/diff.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -I./src -o test/test_diff test/test_diff.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
 
 #include <gtest/gtest.h>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <memory>
 #include <sstream>
 #include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
 #include "dirhist/diff.h"
+#include "internal/thread_pool.h"
 
 namespace fs = std::filesystem;
 
@@ -152,4 +156,338 @@ TEST_F(DiffFuncRealTreeTest, DiffFunction_Output) {
     EXPECT_NE(output.find("Changes between snapshots"), std::string::npos);
     EXPECT_NE(output.find("M "), std::string::npos);
     EXPECT_NE(output.find("f.txt"), std::string::npos);
-}
\ No newline at end of file
+}
+
+// same_snapshot 测试：仅比较文件头中的根哈希
+TEST_F(DiffFuncRealTreeTest, SameSnapshot_ComparesHeaders) {
+    fs::path store = fs::temp_directory_path() / "dirhist_diff_func_store";
+    aux_remove_all(store);
+    create_file(test_dir / "a.txt", "hello");
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root, 100, store);
+    dirhist::write_snapshot(*root, 200, store);
+    create_file(test_dir / "a.txt", "changed");
+    dirhist::write_snapshot(*dirhist::build_tree(test_dir), 300, store);
+
+    EXPECT_TRUE(dirhist::same_snapshot(store / "snap-100.bin", store / "snap-200.bin"));
+    EXPECT_FALSE(dirhist::same_snapshot(store / "snap-200.bin", store / "snap-300.bin"));
+    EXPECT_THROW(dirhist::same_snapshot(store / "snap-100.bin", store / "snap-999.bin")
+                                                            , std::runtime_error);
+    aux_remove_all(store);
+}
+
+// diff_nodes 测试：多个较大的变化子目录并行比较，输出顺序与串行一致
+TEST_F(DiffFuncRealTreeTest, DiffNodes_ParallelKeepsOrder) {
+    for (int d = 0; d < 4; ++d) {
+        fs::path sub = test_dir / ("dir" + std::to_string(d));
+        fs::create_directory(sub);
+        for (int i = 0; i < 50; ++i) {
+            create_file(sub / ("f" + std::to_string(100 + i)), "old");
+        }
+    }
+    create_file(test_dir / "z.txt", "old");
+    auto old_root = dirhist::build_tree(test_dir);
+
+    for (int d = 0; d < 4; ++d) {
+        fs::path sub = test_dir / ("dir" + std::to_string(d));
+        for (int i = 0; i < 50; i += 2) {
+            create_file(sub / ("f" + std::to_string(100 + i)), "new");
+        }
+    }
+    create_file(test_dir / "a.txt", "new");
+    fs::remove(test_dir / "z.txt");
+    auto new_root = dirhist::build_tree(test_dir);
+
+    std::vector<dirhist::DiffEntry> out;
+    dirhist::diff_nodes(*old_root, *new_root, out);
+
+    ASSERT_EQ(out.size(), 4 * 25 + 2);
+    EXPECT_EQ(out.front().type, dirhist::ChangeType::Added);
+    EXPECT_EQ(out.front().path, "a.txt");
+    EXPECT_EQ(out[1].path, "dir0/f100");
+    EXPECT_EQ(out.back().type, dirhist::ChangeType::Deleted);
+    EXPECT_EQ(out.back().path, "z.txt");
+    for (size_t i = 1; i < out.size(); ++i) {
+        EXPECT_LT(out[i-1].path, out[i].path);
+    }
+}
+
+// diff_nodes 测试：并行子树的差异较多时输出完整有序
+TEST_F(DiffFuncRealTreeTest, DiffNodes_ParallelLargeSubtrees) {
+    for (int d = 0; d < 3; ++d) {
+        fs::create_directory(test_dir / ("dir" + std::to_string(d)));
+        create_file(test_dir / ("dir" + std::to_string(d)) / "keep", "old");
+    }
+    auto old_root = dirhist::build_tree(test_dir);
+
+    // 每个子目录新增较多文件
+    for (int d = 0; d < 3; ++d) {
+        for (int i = 0; i < 1500; ++i) {
+            create_file(test_dir / ("dir" + std::to_string(d))
+                                 / ("f" + std::to_string(10000 + i)), "new");
+        }
+    }
+    auto new_root = dirhist::build_tree(test_dir);
+
+    std::vector<dirhist::DiffEntry> out;
+    dirhist::diff_nodes(*old_root, *new_root, out);
+
+    ASSERT_EQ(out.size(), 3 * 1500);
+    EXPECT_EQ(out.front().path, "dir0/f10000");
+    EXPECT_EQ(out.back().path, "dir2/f11499");
+    for (size_t i = 1; i < out.size(); ++i) {
+        ASSERT_LT(out[i-1].path, out[i].path);
+    }
+}
+
+// 辅助类：收到第一条差异时向线程池提交探测任务并等待，随后收集全部差异
+// 线程池先进先出，探测任务执行时工作线程已取走此前派发的全部比较任务
+struct StallSink: dirhist::DiffSink {
+    util::ThreadPool& pool;
+    bool probed = false;
+    bool probe_ran = false;
+    std::vector<dirhist::DiffEntry> out;
+
+    explicit StallSink(util::ThreadPool& p): pool(p) {}
+
+    void on_entry(const dirhist::DiffEntry& entry) override {
+        if (out.empty() && pool.workers() > 0) {
+            auto done = std::make_shared<std::promise<void>>();
+            auto fut = done->get_future();
+            pool.submit([done]{ done->set_value(); });
+            probed = true;
+            probe_ran = fut.wait_for(std::chrono::seconds(30)) == std::future_status::ready;
+        }
+        out.push_back(entry);
+    }
+};
+
+// diff_nodes 测试：等待线程阻塞在 sink 中时，各并行任务仍能同时运行至结束
+TEST_F(DiffFuncRealTreeTest, DiffNodes_ProducersDoNotWaitForConsumer) {
+    auto& pool = util::ThreadPool::instance();
+    if (pool.workers() == 0 || pool.workers() > 16) GTEST_SKIP();
+    // 子目录对数多于工作线程数，所有工作线程都在执行比较任务
+    const size_t dirs = pool.workers() + 1;
+    for (size_t d = 0; d < dirs; ++d) {
+        fs::create_directory(test_dir / ("dir" + std::to_string(d)));
+        create_file(test_dir / ("dir" + std::to_string(d)) / "keep", "old");
+    }
+    auto old_root = dirhist::build_tree(test_dir);
+    create_file(test_dir / "a.txt", "new");
+    for (size_t d = 0; d < dirs; ++d) {
+        for (int i = 0; i < 1500; ++i) {
+            create_file(test_dir / ("dir" + std::to_string(d))
+                                 / ("f" + std::to_string(10000 + i)), "new");
+        }
+    }
+    auto new_root = dirhist::build_tree(test_dir);
+
+    // 收到第一条差异（a.txt）时等待探测任务，所有比较任务结束后它才会被执行
+    StallSink sink(pool);
+    dirhist::diff_nodes(*old_root, *new_root, sink);
+
+    ASSERT_TRUE(sink.probed);
+    EXPECT_TRUE(sink.probe_ran);
+    EXPECT_EQ(sink.out.size(), dirs * 1500 + 1);
+}
+
+// diff_nodes 测试：并行任务缓冲的差异超出上限时改为串行比较，输出完整有序
+TEST(DiffFuncTest, DiffNodes_ParallelBufferOverflow) {
+    auto make_dir = [](const std::string& path, uint8_t tag) {
+        auto node = std::make_unique<dirhist::Node>();
+        node->path = path;
+        node->is_dir = true;
+        node->hash[0] = tag;
+        return node;
+    };
+    auto old_root = make_dir("", 1);
+    auto new_root = make_dir("", 2);
+    // 等待线程阻塞在第一条差异 a 上，三个子目录全部由工作线程比较，
+    // 共新增 300000 个文件，超过缓冲条目总数上限
+    new_root->children.push_back(std::make_unique<dirhist::Node>());
+    new_root->children.back()->path = "a";
+    for (int d = 0; d < 3; ++d) {
+        std::string dir = "dir" + std::to_string(d);
+        old_root->children.push_back(make_dir(dir, 1));
+        auto sub = make_dir(dir, 2);
+        for (int i = 0; i < 100000; ++i) {
+            auto file = std::make_unique<dirhist::Node>();
+            file->path = dir + "/f" + std::to_string(100000 + i);
+            file->hash[0] = 3;
+            sub->children.push_back(std::move(file));
+        }
+        new_root->children.push_back(std::move(sub));
+    }
+
+    StallSink sink(util::ThreadPool::instance());
+    dirhist::diff_nodes(*old_root, *new_root, sink);
+    EXPECT_EQ(sink.probed, sink.probe_ran);
+
+    const auto& out = sink.out;
+    ASSERT_EQ(out.size(), 300001);
+    EXPECT_EQ(out.front().path, "a");
+    EXPECT_EQ(out[1].path, "dir0/f100000");
+    EXPECT_EQ(out.back().path, "dir2/f199999");
+    for (size_t i = 1; i < out.size(); ++i) {
+        ASSERT_LT(out[i-1].path, out[i].path);
+    }
+}
+
+// DiffPrinter 测试：按块缓冲输出，内容与逐条打印一致
+TEST_F(DiffFuncRealTreeTest, DiffPrinter_BufferedOutput) {
+    auto old_root = dirhist::build_tree(test_dir);
+    for (int i = 0; i < 2000; ++i) {
+        create_file(test_dir / ("file" + std::to_string(i)), "x");
+    }
+    auto new_root = dirhist::build_tree(test_dir);
+
+    std::vector<dirhist::DiffEntry> out;
+    dirhist::diff_nodes(*old_root, *new_root, out);
+    std::string expected;
+    for (const auto& entry : out) {
+        dirhist::format_colored_DiffEntry(expected, entry);
+    }
+
+    std::ostringstream oss;
+    dirhist::DiffPrinter printer(oss);
+    dirhist::diff_nodes(*old_root, *new_root, printer);
+    printer.finish();
+
+    EXPECT_EQ(printer.count(), 2000);
+    std::string output = oss.str();
+    EXPECT_EQ(output.find("Changes between snapshots"), 0);
+    EXPECT_EQ(output.substr(output.size() - expected.size()), expected);
+
+    std::ostringstream empty;
+    dirhist::DiffPrinter none(empty);
+    dirhist::diff_nodes(*new_root, *new_root, none);
+    none.finish();
+    EXPECT_EQ(empty.str(), "No changes.\n");
+}
+
+// RenameDetector 测试：同目录改名与跨目录移动
+TEST_F(DiffFuncRealTreeTest, RenameDetector_FilesRenamedAndMoved) {
+    fs::create_directory(test_dir / "sub");
+    create_file(test_dir / "a.txt", "content a");
+    create_file(test_dir / "b.txt", "content b");
+    create_file(test_dir / "empty1", "");
+    auto old_root = dirhist::build_tree(test_dir);
+
+    fs::rename(test_dir / "a.txt", test_dir / "c.txt");
+    fs::rename(test_dir / "b.txt", test_dir / "sub" / "b.txt");
+    fs::rename(test_dir / "empty1", test_dir / "empty2");
+    auto new_root = dirhist::build_tree(test_dir);
+
+    std::vector<dirhist::DiffEntry> out;
+    dirhist::DiffCollector collector(out);
+    dirhist::RenameDetector detector(collector);
+    dirhist::diff_nodes(*old_root, *new_root, detector);
+    detector.finish();
+
+    // 空文件不参与配对，仍为一删一增
+    ASSERT_EQ(out.size(), 4);
+    EXPECT_EQ(out[0].type, dirhist::ChangeType::Renamed);
+    EXPECT_EQ(out[0].old_path, "a.txt");
+    EXPECT_EQ(out[0].path, "c.txt");
+    EXPECT_EQ(out[1].type, dirhist::ChangeType::Deleted);
+    EXPECT_EQ(out[1].path, "empty1");
+    EXPECT_EQ(out[2].type, dirhist::ChangeType::Added);
+    EXPECT_EQ(out[2].path, "empty2");
+    EXPECT_EQ(out[3].type, dirhist::ChangeType::Moved);
+    EXPECT_EQ(out[3].old_path, "b.txt");
+    EXPECT_EQ(out[3].path, "sub/b.txt");
+}
+
+// RenameDetector 测试：整个目录移动只输出一条
+TEST_F(DiffFuncRealTreeTest, RenameDetector_WholeDirectoryMoved) {
+    fs::create_directories(test_dir / "src" / "lib" / "deep");
+    fs::create_directory(test_dir / "dst");
+    create_file(test_dir / "src" / "lib" / "x.txt", "x");
+    create_file(test_dir / "src" / "lib" / "deep" / "y.txt", "y");
+    auto old_root = dirhist::build_tree(test_dir);
+
+    fs::rename(test_dir / "src" / "lib", test_dir / "dst" / "lib");
+    auto new_root = dirhist::build_tree(test_dir);
+
+    std::vector<dirhist::DiffEntry> out;
+    dirhist::DiffCollector collector(out);
+    dirhist::RenameDetector detector(collector);
+    dirhist::diff_nodes(*old_root, *new_root, detector);
+    detector.finish();
+
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0].type, dirhist::ChangeType::Moved);
+    EXPECT_TRUE(out[0].is_dir);
+    EXPECT_EQ(out[0].old_path, "src/lib");
+    EXPECT_EQ(out[0].path, "dst/lib");
+}
+
+// RenameDetector 测试：大量内容相同的文件移动时，同名条目优先且每个删除条目只配对一次
+TEST_F(DiffFuncRealTreeTest, RenameDetector_ManyIdenticalFiles) {
+    fs::create_directory(test_dir / "old");
+    fs::create_directory(test_dir / "new");
+    for (int i = 0; i < 2000; ++i) {
+        create_file(test_dir / "old" / ("f" + std::to_string(1000 + i)), "same");
+    }
+    auto old_root = dirhist::build_tree(test_dir);
+
+    for (int i = 0; i < 2000; ++i) {
+        std::string name = "f" + std::to_string(1000 + i);
+        fs::rename(test_dir / "old" / name, test_dir / "new" / name);
+    }
+    create_file(test_dir / "new" / "zz_extra", "same");
+    auto new_root = dirhist::build_tree(test_dir);
+
+    std::vector<dirhist::DiffEntry> out;
+    dirhist::DiffCollector collector(out);
+    dirhist::RenameDetector detector(collector);
+    dirhist::diff_nodes(*old_root, *new_root, detector);
+    detector.finish();
+
+    // 删除条目用尽后多出的文件仍为新增
+    ASSERT_EQ(out.size(), 2001);
+    EXPECT_EQ(out.back().type, dirhist::ChangeType::Added);
+    EXPECT_EQ(out.back().path, "new/zz_extra");
+    for (size_t i = 0; i + 1 < out.size(); ++i) {
+        ASSERT_EQ(out[i].type, dirhist::ChangeType::Moved);
+        ASSERT_EQ(out[i].old_path, "old/" + out[i].path.substr(4));
+    }
+}
+
+// 测试范围路径的规范化与去重
+TEST(DiffScopeTest, NormalizeScopes) {
+    auto scopes = dirhist::normalize_scopes({"a/b/", "./a-b", "a", "a/b/c", "c", "a-b"});
+    ASSERT_EQ(scopes.size(), 3);
+    EXPECT_EQ(scopes[0], "a");
+    EXPECT_EQ(scopes[1], "a-b");
+    EXPECT_EQ(scopes[2], "c");
+
+    auto root = dirhist::normalize_scopes({"a", "./"});
+    ASSERT_EQ(root.size(), 1);
+    EXPECT_EQ(root[0], ".");
+}
+
+// 测试只比较指定范围内的子树
+TEST_F(DiffFuncRealTreeTest, DiffPaths_OnlyScopedSubtrees) {
+    fs::create_directories(test_dir / "etc");
+    fs::create_directories(test_dir / "var" / "log");
+    create_file(test_dir / "etc" / "hosts", "h");
+    create_file(test_dir / "var" / "log" / "syslog", "s");
+    auto old_root = dirhist::build_tree(test_dir);
+
+    create_file(test_dir / "etc" / "hosts", "hh");
+    create_file(test_dir / "var" / "log" / "syslog", "ss");
+    fs::create_directories(test_dir / "opt" / "app");
+    create_file(test_dir / "opt" / "app" / "bin", "b");
+    auto new_root = dirhist::build_tree(test_dir);
+
+    std::vector<dirhist::DiffEntry> out;
+    dirhist::DiffCollector sink(out);
+    dirhist::diff_paths(*old_root, *new_root, {"etc", "opt", "missing"}, sink);
+    ASSERT_EQ(out.size(), 4);
+    EXPECT_EQ(out[0].type, dirhist::ChangeType::Modified);
+    EXPECT_EQ(out[0].path, "etc/hosts");
+    EXPECT_EQ(out[1].type, dirhist::ChangeType::Added);
+    EXPECT_EQ(out[1].path, "opt");
+    EXPECT_EQ(out[3].path, "opt/app/bin");
+}
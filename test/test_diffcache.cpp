@@ -0,0 +1,211 @@
+/*
+ * @file    test/test_diffcache.cpp
+ * @brief   This source file implemented to test the functions in src/diffcache.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_diffcache test/test_diffcache.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include "dirhist/snapshot.h"
+#include "dirhist/diffcache.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+// 辅助函数：构造根哈希全部字节为 b、时间戳为 b 的缓存键
+dirhist::DiffCacheKey make_key(uint8_t b) {
+    dirhist::DiffCacheKey key;
+    key.old_hash.fill(b);
+    key.new_hash.fill(b);
+    key.old_ts = key.new_ts = b;
+    return key;
+}
+
+class DiffCacheTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path store_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_diffcache_test_dir";
+        store_dir = std::filesystem::temp_directory_path() / "dirhist_diffcache_store";
+        aux_remove_all(test_dir);
+        aux_remove_all(store_dir);
+        std::filesystem::create_directories(test_dir / "sub");
+        std::filesystem::create_directories(store_dir);
+        create_file(test_dir / "a.txt", "a");
+        create_file(test_dir / "sub" / "b.txt", "b");
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(store_dir);
+    }
+
+    // 以根哈希及时间戳 100、200 构造缓存键
+    static dirhist::DiffCacheKey key_of(const dirhist::Node& old_root
+                                                , const dirhist::Node& new_root) {
+        return dirhist::DiffCacheKey{old_root.hash, 100, new_root.hash, 200};
+    }
+
+    // 比较并写入缓存，返回比较得到的差异
+    std::vector<dirhist::DiffEntry> diff_and_cache(const dirhist::Node& old_root
+                    , const dirhist::Node& new_root, uint64_t max_bytes) {
+        std::vector<dirhist::DiffEntry> out;
+        dirhist::DiffCollector collector(out);
+        dirhist::DiffCacheWriter writer(collector, store_dir, key_of(old_root, new_root)
+                                                                    , max_bytes);
+        dirhist::diff_nodes(old_root, new_root, writer);
+        writer.commit();
+        return out;
+    }
+};
+
+// 测试写入后按根哈希及时间戳命中，结果与比较结果一致
+TEST_F(DiffCacheTest, HitReturnsSameEntries) {
+    auto old_root = dirhist::build_tree(test_dir);
+    create_file(test_dir / "a.txt", "aa");
+    create_file(test_dir / "sub" / "c.txt", "c");
+    auto new_root = dirhist::build_tree(test_dir);
+
+    std::vector<dirhist::DiffEntry> cached;
+    dirhist::DiffCollector miss(cached);
+    EXPECT_FALSE(dirhist::load_cached_diff(store_dir, key_of(*old_root, *new_root), miss));
+    EXPECT_TRUE(cached.empty());
+
+    auto direct = diff_and_cache(*old_root, *new_root, dirhist::DEFAULT_DIFF_CACHE_BYTES);
+    ASSERT_EQ(direct.size(), 2);
+    EXPECT_TRUE(std::filesystem::exists(
+            dirhist::diff_cache_path(store_dir, key_of(*old_root, *new_root))));
+
+    dirhist::DiffCollector hit(cached);
+    EXPECT_TRUE(dirhist::load_cached_diff(store_dir, key_of(*old_root, *new_root), hit));
+    ASSERT_EQ(cached.size(), direct.size());
+    for (size_t i = 0; i < cached.size(); ++i) {
+        EXPECT_EQ(cached[i].type, direct[i].type);
+        EXPECT_EQ(cached[i].path, direct[i].path);
+        EXPECT_EQ(cached[i].new_hash, direct[i].new_hash);
+    }
+
+    // 键有方向，反向比较不命中
+    std::vector<dirhist::DiffEntry> reversed;
+    dirhist::DiffCollector rev(reversed);
+    EXPECT_FALSE(dirhist::load_cached_diff(store_dir, key_of(*new_root, *old_root), rev));
+}
+
+// 测试超出上限时淘汰最近最少使用的缓存
+TEST_F(DiffCacheTest, EvictsLeastRecentlyUsed) {
+    auto old_root = dirhist::build_tree(test_dir);
+    create_file(test_dir / "a.txt", "changed");
+    auto new_root = dirhist::build_tree(test_dir);
+    diff_and_cache(*old_root, *new_root, dirhist::DEFAULT_DIFF_CACHE_BYTES);
+    uint64_t one = std::filesystem::file_size(
+            dirhist::diff_cache_path(store_dir, key_of(*old_root, *new_root)));
+
+    // 复制出三个不同键的缓存，修改时间依次递增
+    auto base = std::filesystem::file_time_type::clock::now();
+    for (uint8_t k = 1; k <= 3; ++k) {
+        auto path = dirhist::diff_cache_path(store_dir, make_key(k));
+        std::filesystem::copy_file(
+            dirhist::diff_cache_path(store_dir, key_of(*old_root, *new_root)), path);
+        std::filesystem::last_write_time(path, base + std::chrono::seconds(k));
+    }
+    std::filesystem::remove(dirhist::diff_cache_path(store_dir, key_of(*old_root, *new_root)));
+
+    // 访问最旧的缓存后，它变为最近使用
+    std::vector<dirhist::DiffEntry> out;
+    dirhist::DiffCollector sink(out);
+    EXPECT_TRUE(dirhist::load_cached_diff(store_dir, make_key(1), sink));
+    std::filesystem::last_write_time(dirhist::diff_cache_path(store_dir, make_key(1))
+                                    , base + std::chrono::seconds(10));
+
+    EXPECT_EQ(dirhist::evict_diff_cache(store_dir, one * 2), 1);
+    EXPECT_TRUE(std::filesystem::exists(
+            dirhist::diff_cache_path(store_dir, make_key(1))));
+    EXPECT_FALSE(std::filesystem::exists(
+            dirhist::diff_cache_path(store_dir, make_key(2))));
+    EXPECT_TRUE(std::filesystem::exists(
+            dirhist::diff_cache_path(store_dir, make_key(3))));
+}
+
+// 测试超出上限的结果不缓存，损坏的缓存被丢弃
+TEST_F(DiffCacheTest, OversizedAndCorrupted) {
+    auto old_root = dirhist::build_tree(test_dir);
+    create_file(test_dir / "a.txt", "changed");
+    auto new_root = dirhist::build_tree(test_dir);
+
+    auto out = diff_and_cache(*old_root, *new_root, 16);
+    EXPECT_EQ(out.size(), 1);
+    auto path = dirhist::diff_cache_path(store_dir, key_of(*old_root, *new_root));
+    EXPECT_FALSE(std::filesystem::exists(path));
+
+    std::filesystem::create_directories(path.parent_path());
+    create_file(path, "garbage");
+    std::vector<dirhist::DiffEntry> cached;
+    dirhist::DiffCollector sink(cached);
+    EXPECT_FALSE(dirhist::load_cached_diff(store_dir, key_of(*old_root, *new_root), sink));
+    EXPECT_TRUE(cached.empty());
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+// 测试根哈希相同但时间戳不同（如仅 touch 过）的快照对不命中
+TEST_F(DiffCacheTest, TimestampsArePartOfKey) {
+    auto old_root = dirhist::build_tree(test_dir);
+    create_file(test_dir / "a.txt", "changed");
+    auto new_root = dirhist::build_tree(test_dir);
+    diff_and_cache(*old_root, *new_root, dirhist::DEFAULT_DIFF_CACHE_BYTES);
+
+    std::vector<dirhist::DiffEntry> cached;
+    dirhist::DiffCollector sink(cached);
+    EXPECT_FALSE(dirhist::load_cached_diff(store_dir
+            , dirhist::DiffCacheKey{old_root->hash, 100, new_root->hash, 300}, sink));
+
+    dirhist::Header old_hdr, new_hdr;
+    old_hdr.root_hash = old_root->hash;
+    old_hdr.timestamp = 100;
+    new_hdr.root_hash = new_root->hash;
+    new_hdr.timestamp = 200;
+    EXPECT_TRUE(dirhist::load_cached_diff(store_dir
+            , dirhist::diff_cache_key(old_hdr, new_hdr), sink));
+    EXPECT_EQ(cached.size(), 1);
+}
+
+// 测试淘汰时清理写入中断残留的临时文件，且不留下新的临时文件
+TEST_F(DiffCacheTest, EvictsOrphanTempFiles) {
+    auto old_root = dirhist::build_tree(test_dir);
+    create_file(test_dir / "a.txt", "changed");
+    auto new_root = dirhist::build_tree(test_dir);
+
+    auto path = dirhist::diff_cache_path(store_dir, key_of(*old_root, *new_root));
+    std::filesystem::create_directories(path.parent_path());
+    auto orphan = path.parent_path() / "dead.tmp-1-0.bin";
+    auto fresh = path.parent_path() / "live.tmp-2-0.bin";
+    create_file(orphan, "partial");
+    create_file(fresh, "partial");
+    std::filesystem::last_write_time(orphan
+            , std::filesystem::file_time_type::clock::now() - std::chrono::hours(2));
+
+    diff_and_cache(*old_root, *new_root, dirhist::DEFAULT_DIFF_CACHE_BYTES);
+    dirhist::evict_diff_cache(store_dir);
+    EXPECT_FALSE(std::filesystem::exists(orphan));
+    EXPECT_TRUE(std::filesystem::exists(fresh));
+    EXPECT_TRUE(std::filesystem::exists(path));
+
+    // 只剩缓存文件与未过期的临时文件，本次写入的临时文件已改名
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(path.parent_path())
+                            , std::filesystem::directory_iterator{}), 2);
+}
@@ -0,0 +1,106 @@
+/*
+ * @file    test/test_du.cpp
+ * @brief   This source file implemented to test the functions in src/du.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_du test/test_du.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/du.cpp src/filter.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/du.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+class DuTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_du_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_du_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+        std::filesystem::create_directories(test_dir / "big" / "deep");
+        std::filesystem::create_directories(test_dir / "small");
+        create_file(test_dir / "big" / "deep" / "huge.bin", std::string(1000, 'h'));
+        create_file(test_dir / "big" / "mid.bin", std::string(300, 'm'));
+        create_file(test_dir / "small" / "a.txt", std::string(20, 'a'));
+        create_file(test_dir / "top.txt", std::string(50, 't'));
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+
+    // 构建目录树并写入快照，返回快照路径
+    std::filesystem::path snap(int64_t ts) {
+        auto root = dirhist::build_tree(test_dir);
+        dirhist::write_snapshot(*root, ts, output_dir);
+        return output_dir / ("snap-" + std::to_string(ts) + ".bin");
+    }
+};
+
+// 测试最大的目录与文件排名及深度限制
+TEST_F(DuTest, LargestEntries) {
+    dirhist::SnapReader reader(snap(100));
+    dirhist::DuReport report = dirhist::largest_entries(reader, 2);
+    EXPECT_EQ(report.total, 1370);
+    ASSERT_EQ(report.dirs.size(), 2);
+    EXPECT_EQ(report.dirs[0].path, "big");
+    EXPECT_EQ(report.dirs[0].size, 1300);
+    EXPECT_EQ(report.dirs[1].path, "big/deep");
+    ASSERT_EQ(report.files.size(), 2);
+    EXPECT_EQ(report.files[0].path, "big/deep/huge.bin");
+    EXPECT_EQ(report.files[1].path, "big/mid.bin");
+
+    // 只统计第 1 层
+    report = dirhist::largest_entries(reader, 5, 1);
+    ASSERT_EQ(report.dirs.size(), 2);
+    EXPECT_EQ(report.dirs[1].path, "small");
+    ASSERT_EQ(report.files.size(), 1);
+    EXPECT_EQ(report.files[0].path, "top.txt");
+}
+
+// 测试两个快照之间的增长排名
+TEST_F(DuTest, LargestGrowth) {
+    auto old_snap = snap(100);
+    create_file(test_dir / "small" / "a.txt", std::string(500, 'a'));
+    std::filesystem::create_directory(test_dir / "new");
+    create_file(test_dir / "new" / "n.txt", std::string(100, 'n'));
+    std::filesystem::remove(test_dir / "top.txt");
+    auto new_snap = snap(200);
+
+    dirhist::SnapReader old_reader(old_snap), new_reader(new_snap);
+    dirhist::DuReport report = dirhist::largest_growth(old_reader, new_reader, 10);
+    EXPECT_EQ(report.total, 1900);
+    EXPECT_EQ(report.growth, 530);
+    ASSERT_EQ(report.dirs.size(), 2);
+    EXPECT_EQ(report.dirs[0].path, "small");
+    EXPECT_EQ(report.dirs[0].growth, 480);
+    EXPECT_EQ(report.dirs[1].path, "new");
+    ASSERT_EQ(report.files.size(), 2);
+    EXPECT_EQ(report.files[0].path, "small/a.txt");
+    EXPECT_EQ(report.files[1].path, "new/n.txt");
+
+    std::ostringstream oss;
+    dirhist::print_du(report, true, oss);
+    EXPECT_NE(oss.str().find("Total: 1900 (+530)"), std::string::npos);
+    EXPECT_NE(oss.str().find("+480"), std::string::npos);
+}
@@ -0,0 +1,98 @@
+/*
+ * @file    test/test_dupes.cpp
+ * @brief   This source file implemented to test the functions in src/dupes.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_dupes test/test_dupes.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/dupes.cpp src/filter.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/dupes.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+class DupesTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+    std::filesystem::path snapshot;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_dupes_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_dupes_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+        std::filesystem::create_directories(test_dir / "a" / "deep");
+        std::filesystem::create_directories(test_dir / "b");
+        std::filesystem::create_directories(test_dir / "empty");
+        // 三份相同的大文件，两份相同的小文件，另有大小相同但内容不同的文件
+        create_file(test_dir / "a" / "deep" / "big.bin", std::string(400, 'x'));
+        create_file(test_dir / "b" / "big.copy", std::string(400, 'x'));
+        create_file(test_dir / "big.bak", std::string(400, 'x'));
+        create_file(test_dir / "a" / "note.txt", "note");
+        create_file(test_dir / "b" / "note.txt", "note");
+        create_file(test_dir / "b" / "other.bin", std::string(400, 'y'));
+        create_file(test_dir / "empty" / "e1", "");
+        create_file(test_dir / "empty" / "e2", "");
+
+        auto root = dirhist::build_tree(test_dir);
+        dirhist::write_snapshot(*root, 100, output_dir);
+        snapshot = output_dir / "snap-100.bin";
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+};
+
+// 测试按大小与内容哈希分组，空文件不参与比较
+TEST_F(DupesTest, GroupsBySizeAndContent) {
+    dirhist::SnapReader reader(snapshot);
+    dirhist::DupeReport report = dirhist::find_dupes(reader);
+    EXPECT_EQ(report.files, 6);
+    EXPECT_EQ(report.bytes, 4 * 400 + 2 * 4);
+    EXPECT_EQ(report.duplicates, 3);
+    EXPECT_EQ(report.reclaimable, 2 * 400 + 4);
+
+    ASSERT_EQ(report.groups.size(), 2);
+    EXPECT_EQ(report.groups[0].size, 400);
+    EXPECT_EQ(report.groups[0].paths, (std::vector<std::string>{
+                        "a/deep/big.bin", "b/big.copy", "big.bak"}));
+    EXPECT_EQ(report.groups[0].reclaimable(), 800);
+    EXPECT_EQ(report.groups[1].paths, (std::vector<std::string>{"a/note.txt", "b/note.txt"}));
+
+    std::ostringstream oss;
+    dirhist::print_dupes(report, 1, oss);
+    EXPECT_NE(oss.str().find("reclaimable: 804 bytes"), std::string::npos);
+    EXPECT_NE(oss.str().find("  b/big.copy"), std::string::npos);
+    EXPECT_EQ(oss.str().find("note.txt"), std::string::npos);
+    EXPECT_NE(oss.str().find("1 more groups"), std::string::npos);
+}
+
+// 测试最小大小过滤
+TEST_F(DupesTest, MinSize) {
+    dirhist::SnapReader reader(snapshot);
+    dirhist::DupeReport report = dirhist::find_dupes(reader, 100);
+    EXPECT_EQ(report.files, 4);
+    ASSERT_EQ(report.groups.size(), 1);
+    EXPECT_EQ(report.groups[0].paths.size(), 3);
+
+    report = dirhist::find_dupes(reader, 400);
+    EXPECT_EQ(report.files, 0);
+    EXPECT_TRUE(report.groups.empty());
+}
@@ -0,0 +1,60 @@
+/*
+ * @file    test/test_filter.cpp
+ * @brief   This source file implemented to test the functions in src/filter.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_filter test/test_filter.cpp src/filter.cpp src/snapshot.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include "dirhist/filter.h"
+
+// 测试隐藏文件（夹）在任意层级均被过滤
+TEST(FilterTest, HiddenAtAnyDepth) {
+    dirhist::PathFilter filter;
+    EXPECT_TRUE(filter.visible("."));
+    EXPECT_TRUE(filter.visible("src"));
+    EXPECT_FALSE(filter.visible(".git"));
+    EXPECT_FALSE(filter.visible("src/.cache"));
+    EXPECT_TRUE(filter.visible("src/a.txt"));
+
+    dirhist::PathFilter all(true);
+    EXPECT_TRUE(all.visible(".git"));
+    EXPECT_TRUE(all.visible("src/.cache"));
+}
+
+// 测试精确路径规则的规范化，且不要求路径存在
+TEST(FilterTest, ExactPaths) {
+    dirhist::PathFilter filter(false, {"./build/", "docs//api", "/data/proj/tmp", "/elsewhere/x"}
+                                , "/data/proj");
+    EXPECT_FALSE(filter.visible("build"));
+    EXPECT_FALSE(filter.visible("docs/api"));
+    EXPECT_FALSE(filter.visible("tmp"));
+    EXPECT_TRUE(filter.visible("docs"));
+    EXPECT_TRUE(filter.visible("src/build"));
+    EXPECT_TRUE(filter.visible("x"));
+
+    dirhist::PathFilter root(false, {"."});
+    EXPECT_FALSE(root.visible("."));
+}
+
+// 测试通配符规则：名称匹配与完整路径匹配
+TEST(FilterTest, GlobPatterns) {
+    dirhist::PathFilter filter(false, {"*.o", "test_?", "[Tt]mp*", "src/*/gen", "logs/**.log"});
+    EXPECT_FALSE(filter.visible("main.o"));
+    EXPECT_FALSE(filter.visible("a/b/util.o"));
+    EXPECT_TRUE(filter.visible("main.cpp"));
+    EXPECT_FALSE(filter.visible("test_1"));
+    EXPECT_TRUE(filter.visible("test_12"));
+    EXPECT_FALSE(filter.visible("Tmp"));
+    EXPECT_FALSE(filter.visible("x/tmpdir"));
+    EXPECT_TRUE(filter.visible("xtmp"));
+    EXPECT_FALSE(filter.visible("src/lib/gen"));
+    EXPECT_TRUE(filter.visible("src/a/b/gen"));
+    EXPECT_TRUE(filter.visible("gen"));
+    EXPECT_FALSE(filter.visible("logs/2025/07/run.log"));
+    EXPECT_TRUE(filter.visible("logs/run.txt"));
+
+    dirhist::PathFilter negate(true, {"[!a-c]*"});
+    EXPECT_TRUE(negate.visible("apple"));
+    EXPECT_FALSE(negate.visible("zebra"));
+}
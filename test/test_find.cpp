@@ -0,0 +1,126 @@
+/*
+ * @file    test/test_find.cpp
+ * @brief   This source file implemented to test the functions in src/find.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_find test/test_find.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/filter.cpp src/find.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/find.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+class FindTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+    std::filesystem::path snapshot;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_find_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_find_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+
+        // old/ 下的文件与目录均设置为一天前修改，new/ 下的文件为当前时间
+        std::filesystem::create_directories(test_dir / "old" / "deep");
+        std::filesystem::create_directories(test_dir / "new");
+        for (int i = 0; i < 10; ++i) {
+            create_file(test_dir / "old" / "deep" / ("f" + std::to_string(i) + ".log"), "x");
+        }
+        create_file(test_dir / "old" / "big.bin", std::string(500, 'b'));
+        create_file(test_dir / "new" / "fresh.txt", "fresh");
+        create_file(test_dir / "new" / "fresh.log", std::string(100, 'l'));
+        auto day_ago = std::filesystem::file_time_type::clock::now() - std::chrono::hours(24);
+        for (const auto& entry: std::filesystem::recursive_directory_iterator(test_dir / "old")) {
+            std::filesystem::last_write_time(entry.path(), day_ago);
+        }
+        std::filesystem::last_write_time(test_dir / "old", day_ago);
+
+        auto root = dirhist::build_tree(test_dir);
+        dirhist::write_snapshot(*root, 100, output_dir);
+        snapshot = output_dir / "snap-100.bin";
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+
+    // 执行查询并返回匹配的路径
+    std::vector<std::string> run(const dirhist::FindQuery& query, dirhist::FindStats* stats = nullptr) {
+        dirhist::SnapReader reader(snapshot);
+        std::vector<std::string> paths;
+        auto res = dirhist::find_nodes(reader, query, [&](const dirhist::Node& node){
+            paths.push_back(node.path);
+        });
+        if (stats) *stats = res;
+        return paths;
+    }
+};
+
+// 测试按修改时间查询时跳过整棵未变化的子树
+TEST_F(FindTest, NewerPrunesOldSubtrees) {
+    int64_t hour_ago = std::chrono::duration_cast<std::chrono::milliseconds>(
+        (std::chrono::system_clock::now() - std::chrono::hours(1)).time_since_epoch()).count();
+    dirhist::FindQuery query;
+    query.newer = hour_ago;
+    dirhist::FindStats stats;
+    auto paths = run(query, &stats);
+    EXPECT_EQ(paths, (std::vector<std::string>{"new", "new/fresh.log", "new/fresh.txt"}));
+    // 只读取了根目录的两个子节点与 new/ 的两个子节点，old/ 整体被跳过
+    EXPECT_EQ(stats.visited, 4);
+    EXPECT_EQ(stats.pruned, 1);
+}
+
+// 测试按大小与名称查询
+TEST_F(FindTest, LargerAndName) {
+    dirhist::FindQuery query;
+    query.larger = 50;
+    dirhist::FindStats stats;
+    EXPECT_EQ(run(query, &stats), (std::vector<std::string>{"new/fresh.log", "old/big.bin"}));
+    // old/deep 中的文件均不超过 50 字节，整体被跳过
+    EXPECT_EQ(stats.pruned, 2);
+
+    dirhist::FindQuery by_name;
+    by_name.name = "*.log";
+    EXPECT_EQ(run(by_name).size(), 11);
+
+    by_name.larger = 10;
+    EXPECT_EQ(run(by_name), (std::vector<std::string>{"new/fresh.log"}));
+
+    dirhist::FindQuery by_path;
+    by_path.name = "*/f[0-2].log";
+    EXPECT_EQ(run(by_path).size(), 0);
+    by_path.name = "**/f[0-2].log";
+    EXPECT_EQ(run(by_path).size(), 3);
+    by_path.name = "old/*/f[!0-2].log";
+    EXPECT_EQ(run(by_path).size(), 7);
+}
+
+// 测试打印输出
+TEST_F(FindTest, PrintFind) {
+    dirhist::FindQuery query;
+    query.name = "big.bin";
+    std::ostringstream oss;
+    auto stats = dirhist::print_find(snapshot, query, oss);
+    EXPECT_EQ(stats.matched, 1);
+    EXPECT_NE(oss.str().find("file     500"), std::string::npos);
+    EXPECT_NE(oss.str().find("old/big.bin\n"), std::string::npos);
+}
@@ -0,0 +1,210 @@
+/*
+ * @file    test/test_flat.cpp
+ * @brief   This source file implemented to test the functions in src/flat.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_flat test/test_flat.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/filter.cpp src/find.cpp src/flat.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <sstream>
+#include "dirhist/snapshot.h"
+#include "dirhist/flat.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+// 辅助函数：比较两棵目录树的节点信息与结构
+void expect_same_tree(const dirhist::Node& a, const dirhist::Node& b) {
+    EXPECT_EQ(a.path, b.path);
+    EXPECT_EQ(a.is_dir, b.is_dir);
+    EXPECT_EQ(a.is_symlink, b.is_symlink);
+    EXPECT_EQ(a.size, b.size);
+    EXPECT_EQ(a.mtime, b.mtime);
+    EXPECT_EQ(a.hash, b.hash);
+    EXPECT_EQ(a.content_hash, b.content_hash);
+    ASSERT_EQ(a.children.size(), b.children.size());
+    for (size_t i = 0; i < a.children.size(); ++i) {
+        expect_same_tree(*a.children[i], *b.children[i]);
+    }
+}
+
+class FlatTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_flat_test_dir";
+        aux_remove_all(test_dir);
+        std::filesystem::create_directories(test_dir / "a" / "b");
+        std::filesystem::create_directories(test_dir / "c");
+        create_file(test_dir / "a" / "b" / "deep.txt", "deep");
+        create_file(test_dir / "a" / "x.txt", "x");
+        create_file(test_dir / "c" / "big.bin", std::string(300, 'b'));
+        create_file(test_dir / "z.log", "z");
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+    }
+};
+
+// 测试先序布局、子树区间与还原
+TEST_F(FlatTest, FlattenLayoutAndRoundTrip) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::FlatTree tree = dirhist::flatten(*root);
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < tree.size(); ++i) paths.emplace_back(tree.path(i));
+    std::vector<std::string> expected = {".", "a", "a/b", "a/b/deep.txt", "a/x.txt"
+                                        , "c", "c/big.bin", "z.log"};
+    EXPECT_EQ(paths, expected);
+    EXPECT_EQ(tree.ends[0], tree.size());
+    EXPECT_EQ(tree.ends[1], 5);     // a 的子树为 [1, 5)
+    EXPECT_EQ(tree.ends[2], 4);
+    EXPECT_EQ(tree.ends[7], 8);
+    EXPECT_TRUE(tree.is_real_dir(5));
+    EXPECT_FALSE(tree.is_real_dir(6));
+    EXPECT_EQ(tree.sizes[6], 300);
+
+    expect_same_tree(*dirhist::unflatten(tree), *root);
+    expect_same_tree(*dirhist::unflatten(tree, 5), *root->children[1]);
+}
+
+// 测试扁平目录树的比较结果与 diff_nodes 一致
+TEST_F(FlatTest, DiffMatchesNodeDiff) {
+    auto old_root = dirhist::build_tree(test_dir);
+    std::filesystem::remove_all(test_dir / "a" / "b");
+    create_file(test_dir / "a" / "b", "now a file");
+    create_file(test_dir / "a" / "x.txt", "changed");
+    std::filesystem::remove_all(test_dir / "c");
+    std::filesystem::create_directories(test_dir / "d" / "e");
+    create_file(test_dir / "d" / "e" / "new.txt", "new");
+    auto new_root = dirhist::build_tree(test_dir);
+
+    std::vector<dirhist::DiffEntry> expected, actual;
+    dirhist::DiffCollector expected_sink(expected), actual_sink(actual);
+    dirhist::diff_nodes(*old_root, *new_root, expected_sink);
+    dirhist::diff_nodes(dirhist::flatten(*old_root), dirhist::flatten(*new_root), actual_sink);
+
+    ASSERT_EQ(actual.size(), expected.size());
+    EXPECT_FALSE(actual.empty());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_EQ(actual[i].type, expected[i].type);
+        EXPECT_EQ(actual[i].path, expected[i].path);
+        EXPECT_EQ(actual[i].is_dir, expected[i].is_dir);
+        EXPECT_EQ(actual[i].old_size, expected[i].old_size);
+        EXPECT_EQ(actual[i].new_size, expected[i].new_size);
+        EXPECT_EQ(actual[i].old_mtime, expected[i].old_mtime);
+        EXPECT_EQ(actual[i].new_mtime, expected[i].new_mtime);
+        EXPECT_EQ(actual[i].old_hash, expected[i].old_hash);
+        EXPECT_EQ(actual[i].new_hash, expected[i].new_hash);
+        EXPECT_EQ(actual[i].content_hash, expected[i].content_hash);
+    }
+
+    // 相同的树没有差异
+    std::vector<dirhist::DiffEntry> none;
+    dirhist::DiffCollector none_sink(none);
+    dirhist::FlatTree tree = dirhist::flatten(*new_root);
+    dirhist::diff_nodes(tree, tree, none_sink);
+    EXPECT_TRUE(none.empty());
+}
+
+// 测试扁平目录树的打印结果与 display_tree 一致
+TEST_F(FlatTest, DisplayMatchesNodeDisplay) {
+    create_file(test_dir / ".hidden", "h");
+    auto capture = [](const std::function<void()>& fn) {
+        std::ostringstream oss;
+        std::streambuf* old = std::cout.rdbuf(oss.rdbuf());
+        fn();
+        std::cout.rdbuf(old);
+        return oss.str();
+    };
+
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::FlatTree tree = dirhist::flatten(*root);
+    EXPECT_EQ(capture([&]{ dirhist::display_tree(tree); })
+            , capture([&]{ dirhist::display_tree(root); }));
+    EXPECT_EQ(capture([&]{ dirhist::display_tree(tree, 1, true, {"*.log"}); })
+            , capture([&]{ dirhist::display_tree(root, 1, true, {"*.log"}); }));
+}
+
+// 测试按列筛选节点
+TEST_F(FlatTest, SelectNodes) {
+    auto day_ago = std::filesystem::file_time_type::clock::now() - std::chrono::hours(24);
+    std::filesystem::last_write_time(test_dir / "c" / "big.bin", day_ago);
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::FlatTree tree = dirhist::flatten(*root);
+
+    auto select = [&](const dirhist::FindQuery& query) {
+        std::vector<std::string> res;
+        for (uint32_t i: dirhist::select_nodes(tree, query)) res.emplace_back(tree.path(i));
+        return res;
+    };
+
+    dirhist::FindQuery larger;
+    larger.larger = 100;
+    EXPECT_EQ(select(larger), std::vector<std::string>{"c/big.bin"});
+
+    dirhist::FindQuery newer;
+    newer.newer = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() - 3600 * 1000;
+    auto fresh = select(newer);
+    EXPECT_EQ(std::find(fresh.begin(), fresh.end(), "c/big.bin"), fresh.end());
+    EXPECT_NE(std::find(fresh.begin(), fresh.end(), "a/x.txt"), fresh.end());
+    EXPECT_EQ(std::find(fresh.begin(), fresh.end(), "."), fresh.end());
+
+    dirhist::FindQuery name;
+    name.name = "*.txt";
+    EXPECT_EQ(select(name), (std::vector<std::string>{"a/b/deep.txt", "a/x.txt"}));
+    name.name = "a/**";
+    EXPECT_EQ(select(name).size(), 3);
+}
+
+// 测试按列筛选时向量部分与剩余部分的边界值：负的修改时间、超过 INT64_MAX 的大小、
+// 指向目录的符号链接
+TEST_F(FlatTest, SelectNodesEdgeValues) {
+    dirhist::FlatTree tree;
+    tree.path_offsets.push_back(0);
+    const int64_t mtimes[] = {0, -5, -1, 0, 7, INT64_MIN, INT64_MAX, 3, -2, 8, 9};
+    const uint64_t sizes[] = {0, 10, UINT64_MAX, 1ULL << 63, 5, 0, 11, 12, UINT64_MAX, 4, 100};
+    const uint8_t flags[] = {dirhist::FLAT_DIR, 0, 0, dirhist::FLAT_DIR, 0, 0
+                    , dirhist::FLAT_DIR | dirhist::FLAT_SYMLINK, 0, dirhist::FLAT_DIR, 0, 0};
+    for (size_t i = 0; i < 11; ++i) {
+        tree.mtimes.push_back(mtimes[i]);
+        tree.sizes.push_back(sizes[i]);
+        tree.flags.push_back(flags[i]);
+        tree.ends.push_back(i == 0? 11: i + 1);
+        tree.hashes.emplace_back();
+        tree.content_hashes.emplace_back();
+        tree.path_data += "n" + std::to_string(i);
+        tree.path_offsets.push_back(tree.path_data.size());
+    }
+
+    auto select = [&](std::optional<int64_t> newer, std::optional<uint64_t> larger) {
+        dirhist::FindQuery query;
+        query.newer = newer;
+        query.larger = larger;
+        return dirhist::select_nodes(tree, query);
+    };
+
+    EXPECT_EQ(select(-2, std::nullopt), (std::vector<uint32_t>{2, 3, 4, 6, 7, 9, 10}));
+    // 大小按无符号比较，目录（符号链接除外）不参与大小条件
+    EXPECT_EQ(select(std::nullopt, 10), (std::vector<uint32_t>{2, 6, 7, 10}));
+    EXPECT_EQ(select(0, 10), (std::vector<uint32_t>{6, 7, 10}));
+    EXPECT_EQ(select(std::nullopt, std::nullopt).size(), 10);
+}
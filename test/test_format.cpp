@@ -0,0 +1,148 @@
+/*
+ * @file    test/test_format.cpp
+ * @brief   This source file implemented to test the functions in src/format.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_format test/test_format.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <cstring>
+#include <sstream>
+#include "dirhist/format.h"
+
+// 辅助函数：构造一条修改条目
+dirhist::DiffEntry make_entry(const std::string& path) {
+    dirhist::DiffEntry de;
+    de.type = dirhist::ChangeType::Modified;
+    de.path = path;
+    de.old_size = 3;
+    de.new_size = 10;
+    de.old_mtime = -5;
+    de.new_mtime = 42;
+    de.old_hash.fill(0xab);
+    de.new_hash.fill(0x01);
+    return de;
+}
+
+// 测试 NDJSON 输出及转义
+TEST(FormatTest, NdjsonEscapesAndHex) {
+    std::ostringstream oss;
+    dirhist::NdjsonSink sink(oss);
+    sink.on_entry(make_entry("dir/a\"b\\c\n.txt"));
+    sink.finish();
+
+    std::string line = oss.str();
+    EXPECT_EQ(line.back(), '\n');
+    EXPECT_EQ(line.find('\n'), line.size() - 1);
+    EXPECT_NE(line.find("\"type\":\"modified\""), std::string::npos);
+    EXPECT_NE(line.find("\"path\":\"dir/a\\\"b\\\\c\\n.txt\""), std::string::npos);
+    EXPECT_NE(line.find("\"old_mtime\":-5"), std::string::npos);
+    std::string old_hex;
+    for (int i = 0; i < 32; ++i) old_hex += "ab";
+    EXPECT_NE(line.find("\"old_hash\":\"" + old_hex + "\""), std::string::npos);
+    EXPECT_NE(line.find("\"content_hash\":null"), std::string::npos);
+    EXPECT_EQ(line.find("old_path"), std::string::npos);
+}
+
+// 测试 TSV 输出：列名、转义与空哈希
+TEST(FormatTest, TsvColumns) {
+    std::ostringstream oss;
+    dirhist::TsvSink sink(oss);
+    dirhist::DiffEntry de = make_entry("a\tb");
+    de.type = dirhist::ChangeType::Moved;
+    de.old_path = "old/a";
+    sink.on_entry(de);
+    sink.finish();
+
+    std::istringstream iss(oss.str());
+    std::string header, row;
+    std::getline(iss, header);
+    std::getline(iss, row);
+    EXPECT_EQ(header.rfind("type\tpath\told_path", 0), 0);
+    EXPECT_EQ(row.rfind("moved\ta\\tb\told/a\t0\t3\t10\t-5\t42\t", 0), 0);
+    EXPECT_EQ(row.back(), '\t');   // content_hash 为空
+
+    std::ostringstream empty;
+    dirhist::TsvSink none(empty);
+    none.finish();
+    EXPECT_EQ(empty.str(), header + "\n");
+}
+
+// 测试二进制输出的长度前缀记录
+TEST(FormatTest, BinaryLengthPrefixed) {
+    std::ostringstream oss;
+    dirhist::BinarySink sink(oss);
+    sink.on_entry(make_entry("a.txt"));
+    sink.on_entry(make_entry("bb.txt"));
+    sink.finish();
+    EXPECT_EQ(sink.count(), 2);
+
+    std::string data = oss.str();
+    uint64_t magic = 0;
+    std::memcpy(&magic, data.data(), sizeof(magic));
+    EXPECT_EQ(magic, dirhist::DIFF_MAGIC);
+
+    // 依次按长度跳过每条记录
+    size_t pos = sizeof(magic);
+    std::vector<std::string> paths;
+    while (pos < data.size()) {
+        uint32_t len = 0;
+        std::memcpy(&len, data.data() + pos, sizeof(len));
+        const char* rec = data.data() + pos + sizeof(len);
+        EXPECT_EQ(static_cast<uint8_t>(rec[0])
+                , static_cast<uint8_t>(dirhist::ChangeType::Modified));
+        size_t path_off = 2 + 4 * 8 + 3 * 32;
+        uint32_t path_len = 0;
+        std::memcpy(&path_len, rec + path_off, sizeof(path_len));
+        paths.emplace_back(rec + path_off + sizeof(path_len), path_len);
+        pos += sizeof(len) + len;
+    }
+    EXPECT_EQ(pos, data.size());
+    ASSERT_EQ(paths.size(), 2);
+    EXPECT_EQ(paths[0], "a.txt");
+    EXPECT_EQ(paths[1], "bb.txt");
+}
+
+// 测试按名称创建接收者
+TEST(FormatTest, MakeDiffSink) {
+    std::ostringstream oss;
+    EXPECT_NE(dirhist::make_diff_sink("text", oss), nullptr);
+    EXPECT_NE(dirhist::make_diff_sink("ndjson", oss), nullptr);
+    EXPECT_NE(dirhist::make_diff_sink("tsv", oss), nullptr);
+    EXPECT_NE(dirhist::make_diff_sink("binary", oss), nullptr);
+    EXPECT_EQ(dirhist::make_diff_sink("xml", oss), nullptr);
+}
+
+// 测试二进制格式读回后与原差异一致
+TEST(FormatTest, BinaryRoundTrip) {
+    std::ostringstream oss;
+    dirhist::BinarySink sink(oss);
+    dirhist::DiffEntry moved = make_entry("new/a.txt");
+    moved.type = dirhist::ChangeType::Moved;
+    moved.old_path = "old/a.txt";
+    moved.is_dir = true;
+    moved.content_hash.fill(0x5c);
+    sink.on_entry(make_entry("x"));
+    sink.on_entry(moved);
+    sink.finish();
+
+    std::istringstream iss(oss.str());
+    std::vector<dirhist::DiffEntry> out;
+    dirhist::DiffCollector collector(out);
+    EXPECT_EQ(dirhist::read_binary_diff(iss, collector), 2);
+    ASSERT_EQ(out.size(), 2);
+    EXPECT_EQ(out[0].path, "x");
+    EXPECT_EQ(out[0].old_mtime, -5);
+    EXPECT_EQ(out[0].old_hash, make_entry("x").old_hash);
+    EXPECT_EQ(out[1].type, dirhist::ChangeType::Moved);
+    EXPECT_EQ(out[1].old_path, "old/a.txt");
+    EXPECT_TRUE(out[1].is_dir);
+    EXPECT_EQ(out[1].content_hash, moved.content_hash);
+
+    // 截断的数据抛出异常
+    std::string data = oss.str();
+    std::istringstream truncated(data.substr(0, data.size() - 3));
+    EXPECT_THROW(dirhist::read_binary_diff(truncated, collector), std::runtime_error);
+    std::istringstream bad("not a diff");
+    EXPECT_THROW(dirhist::read_binary_diff(bad, collector), std::runtime_error);
+}
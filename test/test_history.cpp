@@ -0,0 +1,115 @@
+/*
+ * @file    test/test_history.cpp
+ * @brief   This source file implemented to test the functions in src/history.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_history test/test_history.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/delta.h"
+#include "dirhist/history.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+class HistoryTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_history_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_history_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+        std::filesystem::create_directories(test_dir / "a" / "b");
+        create_file(test_dir / "a" / "b" / "c.txt", "c");
+        create_file(test_dir / "z.txt", "z");
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+
+    // 以时间戳 ts 写入当前目录的快照
+    void snap(int64_t ts, bool delta = false) {
+        auto root = dirhist::build_tree(test_dir);
+        if (delta) dirhist::write_delta_snapshot(*root, ts, output_dir);
+        else dirhist::write_snapshot(*root, ts, output_dir);
+    }
+};
+
+// 测试只报告路径发生变化的快照
+TEST_F(HistoryTest, ReportsOnlyChanges) {
+    snap(100);
+    create_file(test_dir / "z.txt", "zz");          // 其他路径变化
+    snap(200);
+    create_file(test_dir / "a" / "b" / "c.txt", "cc");
+    snap(300);
+    snap(400);                                      // 完全未变化
+    std::filesystem::remove(test_dir / "a" / "b" / "c.txt");
+    snap(500);
+    create_file(test_dir / "a" / "b" / "c.txt", "ccc");
+    snap(600);
+
+    auto entries = dirhist::path_history(output_dir, "a/b/c.txt");
+    ASSERT_EQ(entries.size(), 4);
+    EXPECT_EQ(entries[0].timestamp, 100);
+    EXPECT_EQ(entries[0].type, dirhist::ChangeType::Added);
+    EXPECT_EQ(entries[1].timestamp, 300);
+    EXPECT_EQ(entries[1].type, dirhist::ChangeType::Modified);
+    EXPECT_EQ(entries[1].size, 2);
+    EXPECT_EQ(entries[2].timestamp, 500);
+    EXPECT_EQ(entries[2].type, dirhist::ChangeType::Deleted);
+    EXPECT_EQ(entries[2].size, 2);
+    EXPECT_EQ(entries[3].timestamp, 600);
+    EXPECT_EQ(entries[3].type, dirhist::ChangeType::Added);
+    EXPECT_EQ(entries[3].size, 3);
+
+    // 目录路径同样适用，时间范围只取其中一段
+    auto dir = dirhist::path_history(output_dir, "a/b", 250, 450);
+    ASSERT_EQ(dir.size(), 1);
+    EXPECT_EQ(dir[0].timestamp, 300);
+    EXPECT_TRUE(dir[0].is_dir);
+}
+
+// 测试增量快照链上的路径历史
+TEST_F(HistoryTest, AcrossDeltaChain) {
+    snap(100);
+    create_file(test_dir / "z.txt", "zz");
+    snap(200, true);
+    create_file(test_dir / "a" / "b" / "c.txt", "cc");
+    snap(300, true);
+
+    auto entries = dirhist::path_history(output_dir, "a/b/c.txt");
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[1].timestamp, 300);
+    EXPECT_EQ(entries[1].type, dirhist::ChangeType::Modified);
+
+    auto z = dirhist::path_history(output_dir, "z.txt");
+    ASSERT_EQ(z.size(), 2);
+    EXPECT_EQ(z[1].timestamp, 200);
+}
+
+// 测试不存在的路径没有历史
+TEST_F(HistoryTest, MissingPath) {
+    snap(100);
+    snap(200);
+    EXPECT_TRUE(dirhist::path_history(output_dir, "no/such").empty());
+    EXPECT_TRUE(dirhist::path_history(output_dir / "none", "a").empty());
+}
@@ -0,0 +1,222 @@
+/*
+ * @file    test/test_index.cpp
+ * @brief   This source file implemented to test the functions in src/index.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_index test/test_index.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/filter.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/objstore.h"
+#include "dirhist/catalog.h"
+#include "dirhist/index.h"
+#include "internal/util.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+class IndexTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_index_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_index_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+        std::filesystem::create_directories(test_dir / "bin");
+        create_file(test_dir / "bin" / "tool", "leaked binary");
+        create_file(test_dir / "readme.md", "readme");
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+};
+
+// 测试快照写入时生成索引段，按内容查询各快照中的路径
+TEST_F(IndexTest, WhereAcrossSnapshots) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root, 100, output_dir);
+    create_file(test_dir / "copy.bin", "leaked binary");
+    root = dirhist::build_tree(test_dir);
+    dirhist::write_object_snapshot(*root, 200, output_dir);
+    std::filesystem::remove_all(test_dir / "bin");
+    root = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root, 300, output_dir);
+    EXPECT_TRUE(std::filesystem::exists(dirhist::index_path(output_dir, root->hash)));
+
+    auto content = util::sha256_file(test_dir / "copy.bin");
+    ASSERT_TRUE(content.has_value());
+    std::vector<dirhist::ContainsHit> hits;
+    dirhist::ContainsStats stats = dirhist::where_content(output_dir, *content, hits);
+    ASSERT_EQ(hits.size(), 4);
+    EXPECT_EQ(hits[0].timestamp, 100);
+    EXPECT_EQ(hits[0].path, "bin/tool");
+    EXPECT_EQ(hits[0].size, 13);
+    EXPECT_EQ(hits[1].timestamp, 200);
+    EXPECT_EQ(hits[1].path, "bin/tool");
+    EXPECT_EQ(hits[2].timestamp, 200);
+    EXPECT_EQ(hits[2].path, "copy.bin");
+    EXPECT_EQ(hits[3].timestamp, 300);
+    EXPECT_EQ(hits[3].path, "copy.bin");
+    EXPECT_EQ(stats.trees, 3);
+    EXPECT_EQ(stats.built, 0);
+
+    // 时间范围与未出现过的内容
+    hits.clear();
+    dirhist::where_content(output_dir, *content, hits, 150, 250);
+    EXPECT_EQ(hits.size(), 2);
+    hits.clear();
+    dirhist::where_content(output_dir, util::sha256("nothing"), hits);
+    EXPECT_TRUE(hits.empty());
+}
+
+// 测试缺失或损坏的索引段在查询时重新生成
+TEST_F(IndexTest, RebuildMissingSegment) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root, 100, output_dir);
+    {
+        std::ofstream ofs(dirhist::index_path(output_dir, root->hash), std::ios::binary);
+        ofs << "broken";
+    }
+    auto content = util::sha256("readme");
+    EXPECT_FALSE(dirhist::lookup_index(output_dir, root->hash, content).has_value());
+
+    std::vector<dirhist::ContainsHit> hits;
+    dirhist::ContainsStats stats = dirhist::where_content(output_dir, content, hits);
+    EXPECT_EQ(stats.built, 1);
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(hits[0].path, "readme.md");
+
+    auto res = dirhist::lookup_index(output_dir, root->hash, content);
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res->size(), 1);
+}
+
+// 辅助函数：读取索引段文件头
+dirhist::IndexHeader read_index_header(const std::filesystem::path& path) {
+    dirhist::IndexHeader hdr;
+    std::ifstream ifs(path, std::ios::binary);
+    ifs.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+    return hdr;
+}
+
+// 测试新段只记录相对父段的变化，查询结果与完整段一致，链长达到上限时写入完整段
+TEST_F(IndexTest, IncrementalSegments) {
+    for (int i = 0; i < 8; ++i) {
+        create_file(test_dir / ("f" + std::to_string(i)), "same " + std::to_string(i));
+    }
+    auto first = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*first, 100, output_dir);
+
+    // 修改、删除、新增各一个文件
+    create_file(test_dir / "readme.md", "readme v2");
+    std::filesystem::remove(test_dir / "bin" / "tool");
+    create_file(test_dir / "new.txt", "leaked binary");
+    auto second = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*second, 200, output_dir);
+
+    dirhist::IndexHeader hdr = read_index_header(dirhist::index_path(output_dir, second->hash));
+    EXPECT_EQ(hdr.magic, dirhist::INDEX_MAGIC);
+    EXPECT_EQ(hdr.base_hash, first->hash);
+    EXPECT_EQ(hdr.chain_len, 1);
+    EXPECT_EQ(hdr.count, 2);
+    EXPECT_EQ(hdr.mask_count, 2);
+
+    std::vector<dirhist::ContainsHit> hits;
+    dirhist::where_content(output_dir, util::sha256("readme"), hits);
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(hits[0].timestamp, 100);
+
+    hits.clear();
+    dirhist::where_content(output_dir, util::sha256("leaked binary"), hits);
+    ASSERT_EQ(hits.size(), 2);
+    EXPECT_EQ(hits[0].timestamp, 100);
+    EXPECT_EQ(hits[0].path, "bin/tool");
+    EXPECT_EQ(hits[1].timestamp, 200);
+    EXPECT_EQ(hits[1].path, "new.txt");
+
+    hits.clear();
+    dirhist::where_content(output_dir, util::sha256("same 3"), hits);
+    ASSERT_EQ(hits.size(), 2);
+    EXPECT_EQ(hits[1].path, "f3");
+
+    // 改回原内容后，上一段的遮蔽不影响新段中的记录
+    create_file(test_dir / "readme.md", "readme");
+    auto third = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*third, 300, output_dir);
+    hits.clear();
+    dirhist::where_content(output_dir, util::sha256("readme"), hits);
+    ASSERT_EQ(hits.size(), 2);
+    EXPECT_EQ(hits[1].timestamp, 300);
+
+    // 每次只修改一个文件，链长不超过上限
+    uint32_t max_chain = 0;
+    bool full = false;
+    for (int i = 0; i < 20; ++i) {
+        create_file(test_dir / "f0", "round " + std::to_string(i));
+        auto root = dirhist::build_tree(test_dir);
+        dirhist::write_snapshot(*root, 400 + i, output_dir);
+        hdr = read_index_header(dirhist::index_path(output_dir, root->hash));
+        max_chain = std::max(max_chain, hdr.chain_len);
+        if (hdr.chain_len == 0) full = true;
+        EXPECT_TRUE(dirhist::lookup_index(output_dir, root->hash, util::sha256("same 7")).value().size() == 1);
+    }
+    EXPECT_EQ(max_chain, dirhist::INDEX_MAX_CHAIN);
+    EXPECT_TRUE(full);
+}
+
+// 测试没有内容哈希的旧版本快照被跳过，且不生成索引段
+TEST_F(IndexTest, SkipsSnapshotsWithoutContentHash) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root, 200, output_dir);
+
+    // 手工写入只有根节点的 version 4 快照（节点记录不含内容哈希与聚合信息）
+    std::filesystem::path old_file = output_dir / "snap-100.bin";
+    dirhist::Header hdr;
+    hdr.version = 4;
+    hdr.timestamp = 100;
+    hdr.root_offset = sizeof(dirhist::Header);
+    hdr.root_hash = util::sha256("v4 tree");
+    {
+        std::ofstream ofs(old_file, std::ios::binary);
+        dirhist::write(ofs, hdr);
+        std::string path = ".";
+        dirhist::write(ofs, static_cast<uint32_t>(path.size()));
+        ofs.write(path.data(), path.size());
+        dirhist::write(ofs, uint32_t(0));
+        dirhist::write(ofs, uint8_t(1));
+        dirhist::write(ofs, uint8_t(0));
+        dirhist::write(ofs, uint64_t(0));
+        dirhist::write(ofs, int64_t(0));
+        ofs.write(reinterpret_cast<const char*>(hdr.root_hash.data()), hdr.root_hash.size());
+        dirhist::write(ofs, uint32_t(0));
+        hdr.data_size = static_cast<uint64_t>(ofs.tellp()) - hdr.root_offset;
+        ofs.seekp(0);
+        dirhist::write(ofs, hdr);
+    }
+    dirhist::catalog_add(old_file, hdr);
+
+    std::vector<dirhist::ContainsHit> hits;
+    dirhist::ContainsStats stats = dirhist::where_content(output_dir, util::sha256("readme"), hits);
+    EXPECT_EQ(stats.skipped, 1);
+    EXPECT_EQ(stats.built, 0);
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(hits[0].timestamp, 200);
+    EXPECT_FALSE(std::filesystem::exists(dirhist::index_path(output_dir, hdr.root_hash)));
+}
@@ -0,0 +1,187 @@
+/*
+ * @file    test/test_objstore.cpp
+ * @brief   This source file implemented to test the functions in src/objstore.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_objstore test/test_objstore.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/objstore.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+// 辅助函数：统计对象库中的对象数量
+size_t count_objects(const std::filesystem::path& store_dir) {
+    size_t cnt = 0;
+    std::error_code ec;
+    for (const auto& e: std::filesystem::recursive_directory_iterator(store_dir / "objects", ec)) {
+        if (e.is_regular_file()) ++cnt;
+    }
+    return cnt;
+}
+
+// 辅助函数：查找Node树中的某个节点
+const dirhist::Node* find_node(const dirhist::Node* root, const std::string& rel_path) {
+    if (!root) return nullptr;
+    if (root->path == rel_path) return root;
+    for (const auto& child : root->children) {
+        if (const dirhist::Node* found = find_node(child.get(), rel_path)) return found;
+    }
+    return nullptr;
+}
+
+class ObjStoreTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_objstore_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_objstore_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+        std::filesystem::create_directories(test_dir / "a");
+        std::filesystem::create_directories(test_dir / "b" / "c");
+        create_file(test_dir / "a" / "x.txt", "xxx");
+        create_file(test_dir / "b" / "c" / "y.txt", "yy");
+        create_file(test_dir / "z.txt", "z");
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+};
+
+// 测试对象库快照的写入与读取
+TEST_F(ObjStoreTest, WriteAndReadObjectSnapshot) {
+    auto root = dirhist::build_tree(test_dir);
+    ASSERT_NE(root, nullptr);
+
+    dirhist::write_object_snapshot(*root, 100, output_dir);
+    // 根目录、a、b、b/c 共四个目录对象
+    EXPECT_EQ(count_objects(output_dir), 4);
+
+    auto loaded = dirhist::read_snapshot(100, output_dir);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->hash, root->hash);
+    EXPECT_EQ(loaded->abs_root, root->abs_root);
+
+    const dirhist::Node* y = find_node(loaded.get(), "b/c/y.txt");
+    ASSERT_NE(y, nullptr);
+    EXPECT_EQ(y->size, 2);
+    EXPECT_EQ(y->abs_root, root->abs_root);
+}
+
+// 测试未变化的子树在快照间共享
+TEST_F(ObjStoreTest, UnchangedSubtreesAreShared) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_object_snapshot(*root1, 100, output_dir);
+
+    create_file(test_dir / "a" / "x.txt", "changed");
+    auto root2 = dirhist::build_tree(test_dir);
+    // 仅根目录与 a 发生变化
+    EXPECT_EQ(dirhist::write_objects(*root2, output_dir), 2);
+    dirhist::write_object_snapshot(*root2, 200, output_dir);
+    EXPECT_EQ(count_objects(output_dir), 6);
+
+    auto loaded = dirhist::read_snapshot(200, output_dir);
+    const dirhist::Node* x = find_node(loaded.get(), "a/x.txt");
+    ASSERT_NE(x, nullptr);
+    EXPECT_EQ(x->size, 7);
+}
+
+// 测试仅修改 mtime 时写入新对象，读回的是新的 mtime 与子树聚合信息
+TEST_F(ObjStoreTest, TouchedFileWritesNewObjects) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_object_snapshot(*root1, 100, output_dir);
+
+    auto later = std::filesystem::last_write_time(test_dir / "b" / "c" / "y.txt")
+                                                        + std::chrono::hours(1);
+    std::filesystem::last_write_time(test_dir / "b" / "c" / "y.txt", later);
+    auto root2 = dirhist::build_tree(test_dir);
+    // Merkle 哈希不覆盖 mtime，但对象键覆盖
+    EXPECT_EQ(root2->hash, root1->hash);
+    EXPECT_NE(dirhist::object_key(*root2), dirhist::object_key(*root1));
+    // 根目录、b、b/c 写入新对象，a 仍共享
+    EXPECT_EQ(dirhist::write_objects(*root2, output_dir), 3);
+    dirhist::write_object_snapshot(*root2, 200, output_dir);
+
+    const dirhist::Node* expected = find_node(root2.get(), "b/c/y.txt");
+    ASSERT_NE(expected, nullptr);
+    auto loaded = dirhist::read_snapshot(200, output_dir);
+    const dirhist::Node* y = find_node(loaded.get(), "b/c/y.txt");
+    ASSERT_NE(y, nullptr);
+    EXPECT_EQ(y->mtime, expected->mtime);
+    EXPECT_NE(y->mtime, find_node(root1.get(), "b/c/y.txt")->mtime);
+    EXPECT_EQ(loaded->max_mtime, root2->max_mtime);
+
+    // 旧快照仍读回旧的 mtime
+    auto old = dirhist::read_snapshot(100, output_dir);
+    EXPECT_EQ(find_node(old.get(), "b/c/y.txt")->mtime
+                        , find_node(root1.get(), "b/c/y.txt")->mtime);
+}
+
+// 测试 gc 删除不再被引用的对象
+TEST_F(ObjStoreTest, GcRemovesUnreferencedObjects) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_object_snapshot(*root1, 100, output_dir);
+    create_file(test_dir / "a" / "x.txt", "changed");
+    auto root2 = dirhist::build_tree(test_dir);
+    dirhist::write_object_snapshot(*root2, 200, output_dir);
+
+    // 两个快照均存在时不删除任何对象
+    EXPECT_EQ(dirhist::gc_objects(output_dir), 0);
+
+    std::filesystem::remove(output_dir / "snap-100.bin");
+    EXPECT_EQ(dirhist::gc_objects(output_dir), 2);
+    EXPECT_EQ(count_objects(output_dir), 4);
+
+    auto loaded = dirhist::read_snapshot(200, output_dir);
+    EXPECT_EQ(loaded->hash, root2->hash);
+}
+
+// 测试对象缺失时 gc 报告并放弃清理，而不是抛出异常
+TEST_F(ObjStoreTest, GcAbortsOnMissingObject) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_object_snapshot(*root1, 100, output_dir);
+    create_file(test_dir / "a" / "x.txt", "changed");
+    auto root2 = dirhist::build_tree(test_dir);
+    dirhist::write_object_snapshot(*root2, 200, output_dir);
+    // 完整快照不引用对象，不影响 gc
+    dirhist::write_snapshot(*root2, 300, output_dir);
+
+    std::filesystem::remove(output_dir / "snap-100.bin");
+    std::filesystem::remove(dirhist::object_path(output_dir, dirhist::object_key(*root2)));
+    uint64_t removed = 1;
+    EXPECT_NO_THROW(removed = dirhist::gc_objects(output_dir));
+    EXPECT_EQ(removed, 0);
+    EXPECT_EQ(count_objects(output_dir), 5);
+}
+
+// 测试对象缺失时读取抛出异常
+TEST_F(ObjStoreTest, MissingObjectThrows) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_object_snapshot(*root, 100, output_dir);
+    std::filesystem::remove(dirhist::object_path(output_dir, dirhist::object_key(*root)));
+
+    EXPECT_THROW({
+        dirhist::read_snapshot(100, output_dir);
+    }, std::runtime_error);
+}
@@ -0,0 +1,213 @@
+/*
+ * @file    test/test_reader.cpp
+ * @brief   This source file implemented to test the functions in src/reader.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_reader test/test_reader.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "dirhist/snapshot.h"
+#include "dirhist/serialize.h"
+#include "dirhist/objstore.h"
+#include "dirhist/delta.h"
+#include "dirhist/reader.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+// 辅助函数：查找Node树中的某个节点
+const dirhist::Node* find_node(const dirhist::Node* root, const std::string& rel_path) {
+    if (!root) return nullptr;
+    if (root->path == rel_path) return root;
+    for (const auto& child : root->children) {
+        if (const dirhist::Node* found = find_node(child.get(), rel_path)) return found;
+    }
+    return nullptr;
+}
+
+class ReaderTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path output_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "dirhist_reader_test_dir";
+        output_dir = std::filesystem::temp_directory_path() / "dirhist_reader_output";
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+        std::filesystem::create_directories(test_dir / "a" / "b");
+        for (int i = 0; i < 20; ++i) {
+            create_file(test_dir / "a" / ("f" + std::to_string(i) + ".txt")
+                                                    , std::string(i + 1, 'x'));
+        }
+        create_file(test_dir / "a" / "b" / "c.txt", "ccc");
+        create_file(test_dir / "z.txt", "z");
+    }
+
+    void TearDown() override {
+        aux_remove_all(test_dir);
+        aux_remove_all(output_dir);
+    }
+
+    // 校验快照中各路径的查找结果与目录树一致
+    void expect_lookups(const std::filesystem::path& snapshot, const dirhist::Node& root) {
+        dirhist::SnapReader reader(snapshot);
+        EXPECT_EQ(reader.root().info.hash, root.hash);
+        for (const char* p: {"a", "a/b/c.txt", "a/f0.txt", "a/f19.txt", "z.txt"}) {
+            auto ref = reader.lookup(p);
+            ASSERT_TRUE(ref.has_value()) << p;
+            const dirhist::Node* expected = find_node(&root, p);
+            EXPECT_EQ(ref->info.hash, expected->hash) << p;
+            EXPECT_EQ(ref->info.size, expected->size) << p;
+        }
+        EXPECT_FALSE(reader.lookup("a/missing.txt").has_value());
+        EXPECT_FALSE(reader.lookup("z.txt/x").has_value());
+        EXPECT_EQ(reader.lookup("./a/b/")->info.path, "a/b");
+        EXPECT_EQ(reader.lookup("")->info.hash, root.hash);
+    }
+};
+
+// 测试完整快照与对象库快照的按路径查找
+TEST_F(ReaderTest, LookupFullAndObject) {
+    auto root = dirhist::build_tree(test_dir);
+    ASSERT_NE(root, nullptr);
+    dirhist::write_snapshot(*root, 100, output_dir);
+    dirhist::write_object_snapshot(*root, 200, output_dir);
+
+    expect_lookups(output_dir / "snap-100.bin", *root);
+    expect_lookups(output_dir / "snap-200.bin", *root);
+}
+
+// 测试增量快照中被继承的目录从父快照读取
+TEST_F(ReaderTest, LookupDeltaInherited) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root1, 100, output_dir);
+    create_file(test_dir / "z.txt", "changed");
+    auto root2 = dirhist::build_tree(test_dir);
+    dirhist::write_delta_snapshot(*root2, 200, output_dir);
+
+    expect_lookups(output_dir / "snap-200.bin", *root2);
+    dirhist::SnapReader reader(output_dir / "snap-200.bin");
+    EXPECT_EQ(reader.lookup("z.txt")->info.size, 7);
+}
+
+// 测试按需读取整棵子树与直接子节点
+TEST_F(ReaderTest, ChildrenAndLoad) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root, 100, output_dir);
+
+    dirhist::SnapReader reader(output_dir / "snap-100.bin");
+    auto children = reader.children(reader.root());
+    ASSERT_EQ(children.size(), 2);
+    EXPECT_EQ(children[0].info.path, "a");
+    EXPECT_EQ(children[1].info.path, "z.txt");
+    EXPECT_TRUE(reader.children(children[1]).empty());
+
+    auto a = reader.load(children[0]);
+    EXPECT_EQ(a->children.size(), 21);
+    const dirhist::Node* c = find_node(a.get(), "a/b/c.txt");
+    ASSERT_NE(c, nullptr);
+    EXPECT_EQ(c->hash, find_node(root.get(), "a/b/c.txt")->hash);
+}
+
+// 测试按需读取的范围差异与读入整棵目录树后的结果一致
+TEST_F(ReaderTest, DiffPathsMatchesInMemory) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root1, 100, output_dir);
+    create_file(test_dir / "a" / "f3.txt", "changed");
+    create_file(test_dir / "a" / "b" / "new.txt", "new");
+    std::filesystem::remove(test_dir / "a" / "f7.txt");
+    std::filesystem::remove_all(test_dir / "z.txt");
+    std::filesystem::create_directories(test_dir / "z.txt" / "d");
+    create_file(test_dir / "z.txt" / "d" / "w.txt", "w");
+    auto root2 = dirhist::build_tree(test_dir);
+    dirhist::write_delta_snapshot(*root2, 200, output_dir);
+    dirhist::write_object_snapshot(*root2, 300, output_dir);
+
+    dirhist::SnapReader old_reader(output_dir / "snap-100.bin");
+    for (const char* snap: {"snap-200.bin", "snap-300.bin"}) {
+        dirhist::SnapReader new_reader(output_dir / snap);
+        for (const std::vector<std::string>& paths: std::vector<std::vector<std::string>>{
+                    {"a/b"}, {"a/f3.txt", "z.txt"}, {"."}, {"missing", "a/f7.txt"}}) {
+            std::vector<dirhist::DiffEntry> lazy, full;
+            dirhist::DiffCollector lazy_sink(lazy), full_sink(full);
+            dirhist::diff_paths(old_reader, new_reader, paths, lazy_sink);
+            dirhist::diff_paths(*root1, *root2, paths, full_sink);
+            ASSERT_EQ(lazy.size(), full.size()) << snap << " " << paths[0];
+            for (size_t i = 0; i < lazy.size(); ++i) {
+                EXPECT_EQ(lazy[i].type, full[i].type);
+                EXPECT_EQ(lazy[i].path, full[i].path);
+                EXPECT_EQ(lazy[i].new_hash, full[i].new_hash);
+            }
+        }
+    }
+}
+
+// 测试批量查找与逐个查找结果一致，且保持输入顺序
+TEST_F(ReaderTest, BatchLookup) {
+    auto root1 = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root1, 100, output_dir);
+    create_file(test_dir / "a" / "b" / "c.txt", "changed");
+    auto root2 = dirhist::build_tree(test_dir);
+    dirhist::write_delta_snapshot(*root2, 200, output_dir);
+
+    std::vector<std::string> paths = {"z.txt", "a/f1.txt", "a/b/c.txt", "a/missing"
+                                    , "a/f10.txt", ".", "a/b/c.txt", "a/b/c.txt/x", "a"};
+    for (const char* snap: {"snap-100.bin", "snap-200.bin"}) {
+        dirhist::SnapReader reader(output_dir / snap);
+        auto refs = reader.lookup(paths);
+        ASSERT_EQ(refs.size(), paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            auto single = reader.lookup(paths[i]);
+            ASSERT_EQ(refs[i].has_value(), single.has_value()) << paths[i];
+            if (single) {
+                EXPECT_EQ(refs[i]->info.hash, single->info.hash) << paths[i];
+            }
+        }
+        EXPECT_FALSE(refs[3].has_value());
+        EXPECT_EQ(refs[6]->info.path, "a/b/c.txt");
+    }
+}
+
+// 测试按深度与过滤条件部分读取
+TEST_F(ReaderTest, LoadWithDepthAndFilter) {
+    auto root = dirhist::build_tree(test_dir);
+    dirhist::write_snapshot(*root, 100, output_dir);
+    dirhist::write_object_snapshot(*root, 200, output_dir);
+
+    for (const char* snap: {"snap-100.bin", "snap-200.bin"}) {
+        dirhist::SnapReader reader(output_dir / snap);
+        auto top = reader.load(reader.root(), 0);
+        EXPECT_TRUE(top->children.empty());
+        EXPECT_EQ(top->hash, root->hash);
+
+        auto one = reader.load(reader.root(), 1);
+        ASSERT_EQ(one->children.size(), 2);
+        EXPECT_TRUE(one->children[0]->children.empty());    // a 的子节点未读取
+
+        auto two = reader.load(reader.root(), 2);
+        const dirhist::Node* b = find_node(two.get(), "a/b");
+        ASSERT_NE(b, nullptr);
+        EXPECT_TRUE(b->children.empty());
+
+        // 被过滤的目录整棵子树都不读取
+        auto filtered = reader.load(reader.root(), -1, [](const dirhist::Node& n){
+            return n.path != "a/b";
+        });
+        EXPECT_EQ(find_node(filtered.get(), "a/b"), nullptr);
+        EXPECT_EQ(find_node(filtered.get(), "a/b/c.txt"), nullptr);
+        EXPECT_NE(find_node(filtered.get(), "a/f5.txt"), nullptr);
+    }
+}
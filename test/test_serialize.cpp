@@ -4,12 +4,14 @@
  * @author  yannn
  * @date    2025-07-28
  */
-// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_serialize test/test_serialize.cpp src/serialize.cpp  src/snapshot.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_serialize test/test_serialize.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
 #include <gtest/gtest.h>
 #include <filesystem>
 #include <fstream>
 #include <memory>
 #include <cstdio>
+#include <chrono>
+#include <cstdlib>
 #include "dirhist/snapshot.h"
 #include "dirhist/serialize.h"
 
@@ -210,4 +212,133 @@ TEST_F(SerializeTest, DeserializeNonExistentSnapshot) {
     EXPECT_THROW({
         dirhist::read_snapshot(ts, output_dir);
     }, std::runtime_error);
-}
\ No newline at end of file
+}
+
+// 测试文件头记录快照类型与根哈希
+TEST_F(SerializeTest, HeaderRecordsKindAndRootHash) {
+    create_file(test_dir / "a.txt", "aaa");
+    auto root = dirhist::build_tree(test_dir);
+    ASSERT_NE(root, nullptr);
+
+    int64_t ts = 20250802;
+    dirhist::write_snapshot(*root, ts, output_dir);
+
+    std::ifstream ifs(output_dir / "snap-20250802.bin", std::ios::binary);
+    dirhist::Header hdr;
+    ASSERT_TRUE(dirhist::read_header(ifs, hdr));
+    EXPECT_EQ(hdr.version, dirhist::VERSION);
+    EXPECT_EQ(hdr.timestamp, ts);
+    EXPECT_EQ(hdr.kind, static_cast<uint8_t>(dirhist::SnapKind::Full));
+    EXPECT_EQ(hdr.root_hash, root->hash);
+}
+// 测试子树较大时走并行读取路径，结果与原树一致
+TEST_F(SerializeTest, DeserializeLargeTreeInParallel) {
+    // 每个子目录的记录量超过并行读取阈值
+    for (int d = 0; d < 3; ++d) {
+        auto sub = test_dir / ("dir" + std::to_string(d));
+        std::filesystem::create_directories(sub);
+        for (int i = 0; i < 2500; ++i) {
+            create_file(sub / ("file" + std::to_string(i) + ".txt"), std::to_string(i));
+        }
+    }
+    auto root = dirhist::build_tree(test_dir);
+    ASSERT_NE(root, nullptr);
+
+    int64_t ts = 20250803;
+    dirhist::write_snapshot(*root, ts, output_dir);
+    auto loaded = dirhist::read_snapshot(ts, output_dir);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->hash, root->hash);
+    ASSERT_EQ(loaded->children.size(), 3);
+
+    const dirhist::Node* f = find_node(loaded.get(), "dir2/file1234.txt");
+    ASSERT_NE(f, nullptr);
+    EXPECT_EQ(f->size, 4);
+    EXPECT_EQ(f->abs_root, root->abs_root);
+}
+
+// 测试文件头记录目录树统计信息，且数据大小覆盖全部节点
+TEST_F(SerializeTest, HeaderRecordsTreeStats) {
+    std::filesystem::create_directories(test_dir / "sub");
+    create_file(test_dir / "a.txt", "aaa");
+    create_file(test_dir / "sub" / "b.txt", "bbbbb");
+    auto root = dirhist::build_tree(test_dir);
+    ASSERT_NE(root, nullptr);
+
+    int64_t ts = 20250804;
+    dirhist::write_snapshot(*root, ts, output_dir);
+
+    auto snapshot = output_dir / "snap-20250804.bin";
+    dirhist::Header hdr = dirhist::read_snapshot_header(snapshot);
+    EXPECT_TRUE(dirhist::has_stats(hdr));
+    EXPECT_EQ(hdr.stats.file_cnt, 2);
+    EXPECT_EQ(hdr.stats.dir_cnt, 2);
+    EXPECT_EQ(hdr.stats.total_bytes, 8);
+    EXPECT_EQ(hdr.root_offset + hdr.data_size, std::filesystem::file_size(snapshot));
+}
+
+// 测试内容哈希随快照写入与读取
+TEST_F(SerializeTest, ContentHashRoundTrip) {
+    std::filesystem::create_directories(test_dir / "sub");
+    create_file(test_dir / "sub" / "a.txt", "aaa");
+    auto root = dirhist::build_tree(test_dir);
+    ASSERT_NE(root, nullptr);
+
+    dirhist::write_snapshot(*root, 20250805, output_dir);
+    auto loaded = dirhist::read_snapshot(20250805, output_dir);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->content_hash, root->content_hash);
+    const dirhist::Node* a = find_node(loaded.get(), "sub/a.txt");
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(a->content_hash, find_node(root.get(), "sub/a.txt")->content_hash);
+}
+
+// 测试子树聚合信息随快照写入与读取，修改时间为毫秒级 Unix 时间戳
+TEST_F(SerializeTest, AggregatesRoundTrip) {
+    std::filesystem::create_directories(test_dir / "sub");
+    create_file(test_dir / "sub" / "a.txt", "aaa");
+    create_file(test_dir / "sub" / "b.txt", std::string(40, 'b'));
+    create_file(test_dir / "c.txt", "c");
+    auto root = dirhist::build_tree(test_dir);
+    ASSERT_NE(root, nullptr);
+    EXPECT_EQ(root->file_cnt, 3);
+    EXPECT_EQ(root->max_file_size, 40);
+
+    // 修改时间与当前时间相差不超过一天
+    const dirhist::Node* a = find_node(root.get(), "sub/a.txt");
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+    EXPECT_LT(std::llabs(a->mtime - now), 86400000LL);
+    EXPECT_GE(root->max_mtime, a->mtime);
+
+    dirhist::write_snapshot(*root, 20250806, output_dir);
+    auto loaded = dirhist::read_snapshot(20250806, output_dir);
+    const dirhist::Node* sub = find_node(loaded.get(), "sub");
+    ASSERT_NE(sub, nullptr);
+    EXPECT_EQ(sub->file_cnt, 2);
+    EXPECT_EQ(sub->max_file_size, 40);
+    EXPECT_EQ(sub->max_mtime, find_node(root.get(), "sub")->max_mtime);
+    EXPECT_EQ(find_node(loaded.get(), "sub/a.txt")->mtime, a->mtime);
+}
+
+// 测试旧版本节点记录的修改时间转换与保守的聚合信息
+TEST_F(SerializeTest, UpgradeLegacyNodeInfo) {
+    auto ft = std::filesystem::file_time_type::clock::now();
+    dirhist::Node file;
+    file.size = 7;
+    file.mtime = ft.time_since_epoch().count();
+    dirhist::upgrade_node_info(file, 5);
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+    EXPECT_LT(std::llabs(file.mtime - now), 5000LL);
+    EXPECT_EQ(file.max_mtime, file.mtime);
+    EXPECT_EQ(file.max_file_size, 7);
+    EXPECT_EQ(file.file_cnt, 1);
+
+    dirhist::Node dir;
+    dir.is_dir = true;
+    dirhist::upgrade_node_info(dir, 5);
+    EXPECT_EQ(dir.max_mtime, dirhist::UNKNOWN_MTIME);
+    EXPECT_EQ(dir.max_file_size, dirhist::UNKNOWN_SIZE);
+    EXPECT_EQ(dir.file_cnt, dirhist::UNKNOWN_COUNT);
+}
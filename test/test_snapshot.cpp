@@ -4,12 +4,15 @@
  * @author  yannn
  * @date    2025-07-28
  */
-// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_snapshot test/test_snapshot.cpp src/snapshot.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_snapshot test/test_snapshot.cpp src/filter.cpp src/snapshot.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
 
 #include <gtest/gtest.h>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <memory>
+#include <sstream>
+#include <unistd.h>
 #include "dirhist/snapshot.h"
 
 // 辅助函数：递归删除目录
@@ -179,4 +182,130 @@ TEST_F(SnapshotTest, SymlinkLoop) {
     EXPECT_TRUE(link->is_symlink);
     EXPECT_TRUE(link->is_dir);
     EXPECT_EQ(link->size, std::string("../loopdir").size());
-}
\ No newline at end of file
+}
+// 内容哈希与路径无关的测试
+TEST_F(SnapshotTest, ContentHashIgnoresPath) {
+    std::filesystem::create_directories(test_dir / "a" / "sub");
+    std::filesystem::create_directories(test_dir / "b" / "sub");
+    create_file(test_dir / "a" / "sub" / "x.txt", "same content");
+    create_file(test_dir / "b" / "sub" / "x.txt", "same content");
+    create_file(test_dir / "b" / "y.txt", "same content");
+    auto root = dirhist::build_tree(test_dir);
+    ASSERT_NE(root, nullptr);
+
+    const dirhist::Node* ax = find_node(root.get(), "a/sub/x.txt");
+    const dirhist::Node* by = find_node(root.get(), "b/y.txt");
+    ASSERT_NE(ax, nullptr);
+    ASSERT_NE(by, nullptr);
+    EXPECT_NE(ax->hash, by->hash);
+    EXPECT_EQ(ax->content_hash, by->content_hash);
+    EXPECT_TRUE(dirhist::has_content_hash(*ax));
+
+    // 子树相同的目录内容哈希相同，子节点名称不同时则不同
+    const dirhist::Node* asub = find_node(root.get(), "a/sub");
+    const dirhist::Node* bsub = find_node(root.get(), "b/sub");
+    EXPECT_NE(asub->hash, bsub->hash);
+    EXPECT_EQ(asub->content_hash, bsub->content_hash);
+    EXPECT_NE(find_node(root.get(), "a")->content_hash
+            , find_node(root.get(), "b")->content_hash);
+}
+
+// 基于先前目录树构建时，大小与修改时间未变的文件沿用先前哈希值
+TEST_F(SnapshotTest, BuildTreeWithPrevTrustsUnchangedFiles) {
+    std::filesystem::create_directory(test_dir / "sub");
+    create_file(test_dir / "sub" / "same.txt", "aaaa");
+    create_file(test_dir / "grow.txt", "bb");
+    auto prev = dirhist::build_tree(test_dir);
+    ASSERT_NE(prev, nullptr);
+
+    // 内容改变但大小与修改时间保持不变：应沿用旧哈希值，说明未读取文件内容
+    auto same = test_dir / "sub" / "same.txt";
+    auto mtime = std::filesystem::last_write_time(same);
+    create_file(same, "cccc");
+    std::filesystem::last_write_time(same, mtime);
+    create_file(test_dir / "grow.txt", "bbbb");
+
+    auto cur = dirhist::build_tree(test_dir, prev.get());
+    ASSERT_NE(cur, nullptr);
+    EXPECT_EQ(find_node(cur.get(), "sub/same.txt")->hash
+            , find_node(prev.get(), "sub/same.txt")->hash);
+    EXPECT_NE(find_node(cur.get(), "grow.txt")->hash
+            , find_node(prev.get(), "grow.txt")->hash);
+
+    // 不提供先前目录树时重新计算
+    auto fresh = dirhist::build_tree(test_dir);
+    EXPECT_NE(find_node(fresh.get(), "sub/same.txt")->hash
+            , find_node(prev.get(), "sub/same.txt")->hash);
+    EXPECT_EQ(fresh->hash, dirhist::build_tree(test_dir)->hash);
+}
+
+// 测试路径前缀拆分与按路径查找
+TEST_F(SnapshotTest, PathPrefixesAndFindPath) {
+    EXPECT_TRUE(dirhist::path_prefixes("").empty());
+    EXPECT_TRUE(dirhist::path_prefixes(".").empty());
+    auto res = dirhist::path_prefixes("./a//b/c/");
+    ASSERT_EQ(res.size(), 3);
+    EXPECT_EQ(res[0], "a");
+    EXPECT_EQ(res[1], "a/b");
+    EXPECT_EQ(res[2], "a/b/c");
+
+    auto root = dirhist::build_tree(test_dir);
+    ASSERT_NE(root, nullptr);
+    EXPECT_EQ(dirhist::find_path(*root, "."), root.get());
+    for (const auto& child: root->children) {
+        EXPECT_EQ(dirhist::find_path(*root, "./" + child->path + "/"), child.get());
+    }
+    EXPECT_EQ(dirhist::find_path(*root, "no/such/path"), nullptr);
+}
+
+// 测试边遍历边打印的目录树与构建目录树后打印的结果一致，且遵循深度限制
+TEST_F(SnapshotTest, StreamTreeMatchesDisplayTree) {
+    std::filesystem::create_directories(test_dir / "a" / "b");
+    std::filesystem::create_directory(test_dir / "c");
+    create_file(test_dir / "a" / "b" / "deep.txt", "deep");
+    create_file(test_dir / "a" / "x.txt", "x");
+    create_file(test_dir / "z.txt", "z");
+
+    auto capture = [](const std::function<void()>& fn) {
+        std::ostringstream oss;
+        std::streambuf* old = std::cout.rdbuf(oss.rdbuf());
+        fn();
+        std::cout.rdbuf(old);
+        return oss.str();
+    };
+
+    auto root = dirhist::build_tree(test_dir);
+    std::string expected = capture([&]{ dirhist::display_tree(root); });
+    std::string streamed = capture([&]{ EXPECT_TRUE(dirhist::stream_tree(test_dir)); });
+    EXPECT_EQ(streamed, expected);
+
+    std::string shallow = capture([&]{ dirhist::stream_tree(test_dir, 1); });
+    EXPECT_NE(shallow.find("z.txt"), std::string::npos);
+    EXPECT_EQ(shallow.find("a/x.txt"), std::string::npos);
+    EXPECT_EQ(shallow.find("a/b"), std::string::npos);
+
+    EXPECT_FALSE(dirhist::stream_tree(test_dir / "missing"));
+}
+
+// 测试目录树输出：非终端时不含颜色，被过滤的末尾子节点不影响连接符
+TEST_F(SnapshotTest, DisplayTreePlainOutput) {
+    std::filesystem::create_directory(test_dir / "a");
+    create_file(test_dir / "a" / "x.txt", "x");
+    create_file(test_dir / "a" / "y.o", "y");
+
+    auto root = dirhist::build_tree(test_dir);
+    std::ostringstream oss;
+    std::streambuf* old = std::cout.rdbuf(oss.rdbuf());
+    dirhist::display_tree(root, -1, false, {"*.o"});
+    std::cout.rdbuf(old);
+
+    std::string out = oss.str();
+    if (!isatty(STDOUT_FILENO)) {
+        EXPECT_EQ(out, "[" + abs_test_dir + "]\n"
+                       "├── .[DIR]\n"
+                       "│   └── a[DIR]\n"
+                       "│       └── a/x.txt\n"
+                       "done.\n");
+    }
+    EXPECT_EQ(out.find("y.o"), std::string::npos);
+}
@@ -0,0 +1,104 @@
+/*
+ * @file    test/test_summary.cpp
+ * @brief   This source file implemented to test the functions in src/summary.cpp
+ * @author  yannn
+ * @date    2025-07-28
+ */
+// g++ -std=c++17 -I/usr/local/googletest/include -I./include -o test/test_summary test/test_summary.cpp src/bloom.cpp src/catalog.cpp src/delta.cpp src/diff.cpp src/diffcache.cpp src/filter.cpp src/format.cpp src/history.cpp src/index.cpp src/objstore.cpp src/reader.cpp src/serialize.cpp src/snapshot.cpp src/summary.cpp src/thread_pool.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "dirhist/snapshot.h"
+#include "dirhist/summary.h"
+
+// 辅助函数：递归删除目录
+void aux_remove_all(const std::filesystem::path& p) {
+    std::error_code ec;
+    std::filesystem::remove_all(p, ec);
+}
+
+// 辅助函数：创建测试文件并写入内容
+void create_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+// 辅助函数：构造一条文件差异
+dirhist::DiffEntry make_entry(dirhist::ChangeType type, const std::string& path
+                                    , uint64_t old_size, uint64_t new_size) {
+    dirhist::DiffEntry de;
+    de.type = type;
+    de.path = path;
+    de.old_size = old_size;
+    de.new_size = new_size;
+    return de;
+}
+
+// 测试按层级累加计数与字节数
+TEST(SummaryTest, RollupByDepth) {
+    std::ostringstream oss;
+    dirhist::SummarySink sink(1, oss);
+    sink.on_entry(make_entry(dirhist::ChangeType::Added, "a/b/x.txt", 0, 10));
+    sink.on_entry(make_entry(dirhist::ChangeType::Deleted, "a/y.txt", 4, 0));
+    sink.on_entry(make_entry(dirhist::ChangeType::Modified, "c/z.txt", 8, 5));
+    sink.on_entry(make_entry(dirhist::ChangeType::Modified, "top.txt", 1, 3));
+    dirhist::DiffEntry dir = make_entry(dirhist::ChangeType::Added, "a/b", 0, 10);
+    dir.is_dir = true;
+    sink.on_entry(dir);     // 目录条目不计数
+
+    const auto& root = sink.root();
+    EXPECT_EQ(root.stats.added, 1);
+    EXPECT_EQ(root.stats.deleted, 1);
+    EXPECT_EQ(root.stats.modified, 2);
+    EXPECT_EQ(root.stats.bytes_added, 12);
+    EXPECT_EQ(root.stats.bytes_removed, 7);
+
+    // depth 1 只建立顶层目录
+    ASSERT_EQ(root.children.size(), 2);
+    const auto& a = *root.children.at("a");
+    EXPECT_EQ(a.stats.added, 1);
+    EXPECT_EQ(a.stats.deleted, 1);
+    EXPECT_TRUE(a.children.empty());
+    EXPECT_EQ(root.children.at("c")->stats.bytes_removed, 3);
+
+    sink.finish();
+    std::string out = oss.str();
+    EXPECT_EQ(out.rfind("Path", 0), 0);
+    EXPECT_NE(out.find("├── a/"), std::string::npos);
+    EXPECT_NE(out.find("└── c/"), std::string::npos);
+}
+
+// 测试在 diff_nodes 遍历中直接汇总
+TEST(SummaryTest, SummarizeDiffNodes) {
+    auto dir = std::filesystem::temp_directory_path() / "dirhist_summary_test_dir";
+    aux_remove_all(dir);
+    std::filesystem::create_directories(dir / "src" / "core");
+    create_file(dir / "src" / "core" / "a.cpp", "aaaa");
+    create_file(dir / "src" / "b.cpp", "bb");
+    create_file(dir / "README", "r");
+    auto old_root = dirhist::build_tree(dir);
+
+    create_file(dir / "src" / "core" / "a.cpp", "aaaaaa");
+    std::filesystem::create_directories(dir / "src" / "core" / "new");
+    create_file(dir / "src" / "core" / "new" / "n.cpp", "nnn");
+    std::filesystem::remove(dir / "src" / "b.cpp");
+    auto new_root = dirhist::build_tree(dir);
+
+    std::ostringstream oss;
+    dirhist::SummarySink sink(-1, oss);
+    dirhist::diff_nodes(*old_root, *new_root, sink);
+    sink.finish();
+
+    const auto& src = *sink.root().children.at("src");
+    EXPECT_EQ(src.stats.added, 1);
+    EXPECT_EQ(src.stats.deleted, 1);
+    EXPECT_EQ(src.stats.modified, 1);
+    EXPECT_EQ(src.stats.bytes_added, 5);
+    EXPECT_EQ(src.stats.bytes_removed, 2);
+    const auto& core = *src.children.at("core");
+    EXPECT_EQ(core.stats.added, 1);
+    EXPECT_EQ(core.children.at("new")->stats.bytes_added, 3);
+    EXPECT_EQ(sink.root().children.count("README"), 0);
+    aux_remove_all(dir);
+}
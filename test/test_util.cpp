@@ -6,7 +6,9 @@
  */
 // g++ -std=c++17 -I/usr/local/googletest/include -I./src -o test/test_util test/test_util.cpp src/util.cpp -lgtest -lgtest_main -lpthread -lssl -lcrypto
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <string>
 #include <fstream>
 #include <filesystem>
@@ -67,12 +69,38 @@ TEST(UtilTest, HashToStrCorrectness) {
     }
 }
 
+TEST(UtilTest, HexToHashRoundTrip) {
+    std::array<uint8_t, 32> hash;
+    for (size_t i = 0; i < hash.size(); ++i) hash[i] = static_cast<uint8_t>(i * 37);
+    std::string hex = util::hash_to_hex(hash);
+    EXPECT_EQ(util::hex_to_hash(hex), hash);
+    // 大写同样可以解析
+    std::transform(hex.begin(), hex.end(), hex.begin(), ::toupper);
+    EXPECT_EQ(util::hex_to_hash(hex), hash);
+    // 长度或字符不合法
+    EXPECT_FALSE(util::hex_to_hash(hex.substr(1)).has_value());
+    hex[10] = 'g';
+    EXPECT_FALSE(util::hex_to_hash(hex).has_value());
+}
+
 TEST(UtilTest, NowMsMonotonicity) {
     int64_t t1 = util::now_ms();
     int64_t t2 = util::now_ms();
     EXPECT_LE(t1, t2); // t2 应该大于等于 t1
 }
 
+TEST(UtilTest, FileTimeMsFloorsBeforeEpoch) {
+    using namespace std::chrono;
+    // epoch 为文件时钟中 Unix 纪元之后不足 1ms 的时刻
+    auto now = fs::file_time_type::clock::now();
+    auto epoch = now - milliseconds(util::file_time_ms(now));
+    EXPECT_EQ(util::file_time_ms(epoch), 0);
+    // 纪元之前的时间向下取整，而不是向零截断
+    EXPECT_EQ(util::file_time_ms(epoch - milliseconds(1)), -1);
+    EXPECT_EQ(util::file_time_ms(epoch - milliseconds(1000)), -1000);
+    EXPECT_EQ(util::file_time_ms(epoch - hours(24)), -86400000);
+}
+
 TEST(UtilTest, IsSnapBinFile) {
     // 创建临时文件名
     fs::path valid = "snap-123456.bin";
@@ -105,4 +133,11 @@ TEST(UtilTest, TsStrFormat) {
     EXPECT_EQ(s[10], ' ');
     EXPECT_EQ(s[13], ':');
     EXPECT_EQ(s[16], ':');
-}
\ No newline at end of file
+}
+TEST(UtilTest, ParseTsRejectsNonAscii) {
+    EXPECT_EQ(util::parse_ts("1753686896000"), 1753686896000);
+    EXPECT_FALSE(util::parse_ts("").has_value());
+    // UTF-8 多字节字符（字节值不小于 0x80）不是数字
+    EXPECT_FALSE(util::parse_ts("\xe2\x91\xa0\xe2\x91\xa1").has_value());
+    EXPECT_FALSE(util::parse_ts("12\xc3\xa9").has_value());
+}